@@ -37,6 +37,7 @@ typedef struct {
     uint16_t position[MAX_MOTORS]; // 每个电机的位置原始值
     
     uint8_t error_code;   // 0:正常, 1:过压, 2:欠压, 3:过流, 4:过温
+    uint64_t error_time_us; // 最近一次故障发生时刻 (BSP_Time_GetUs)
 } AppAdcData_t;
 
 extern AppAdcData_t g_adc_data;
@@ -49,8 +50,23 @@ void App_Adc_ConfigProtect_Global(float v_min, float v_max, float t_max);
 
 // 新配置接口：电机独立参数
 void App_Adc_ConfigProtect_Motor(uint8_t id, float i_max);
+void App_Adc_SetProtectEnable(uint8_t enable);
+// 读取当前保护配置 (LIN 诊断 / 参数读取)
+void App_Adc_GetProtectConfig(AdcProtectionConfig_t *conf);
 
 void App_Adc_Process(void); // 在DMA中断中调用
+// 低功耗: 停止 / 恢复 DMA 采样 (ADC 下电)
+void App_Adc_Suspend(void);
+void App_Adc_Resume(void);
 uint16_t App_Adc_GetPos(uint8_t id); // 获取指定电机位置
+// 母线电压低于 VMIN (尚未测得电压时也视为欠压), 掉电快照布防判断用
+uint8_t App_Adc_Undervoltage(void);
+// 位置监视 (联动等待 ADC 条件): 位置 >= level (above = 1) 或 < level (above = 0) 时
+// 在 DMA 中断中发布 EVT_ADC 并解除, 单次有效; 设置时条件已满足则下一次采样即发布
+#define ADC_WATCH_MAX 2
+void App_Adc_Watch(uint8_t w, uint8_t id, uint16_t level, uint8_t above);
+void App_Adc_Unwatch(uint8_t w);
+// Flash 擦除守护: 电机 id 的电流原始值地址与过流阈值 (原始值), 过流保护未启用返回 0
+uint8_t App_Adc_GetCurrentTrip(uint8_t id, volatile const uint16_t **raw, uint16_t *limit);
 
 #endif
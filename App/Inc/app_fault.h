@@ -0,0 +1,78 @@
+#ifndef APP_FAULT_H
+#define APP_FAULT_H
+
+#include "main.h"
+
+// 故障历史
+// 故障发生时 (可在中断中) 记下时刻、运行模式与测量值, 由主循环经 Flash 作业队列追加写入
+// 两页交替的环形区 (FLASH_FAULT_PAGE0/1_ADDR): 当前页写满时擦除另一页继续写, 至少保留最近一页的记录.
+// 同一故障码 FAULT_HOLDOFF_MS 内只写一条, 期间被抑制的次数计入下一条记录的 repeat.
+
+#define FAULT_HOLDOFF_MS    60000
+#define FAULT_PENDING_MAX   8     // 等待写入的记录数
+#define FAULT_LIN_POLL_MS   1000  // LIN 总线错误检查周期
+
+// 故障码 (1~4 与 g_adc_data.error_code 一致)
+typedef enum {
+    FAULT_NONE = 0,
+    FAULT_OV,       // 过压
+    FAULT_UV,       // 欠压
+    FAULT_OC,       // 过流
+    FAULT_OT,       // 过温
+    FAULT_STALL,    // 堵转 (参数 STALLm)
+    FAULT_LIMIT,    // 限位开关停机, detail = 方向
+    FAULT_LIN,      // LIN 总线错误, detail = 最近错误类型 (LinErrType_t)
+    FAULT_CRC,      // 完整性校验失败, detail = IntegSource_t (app_integrity.h)
+    FAULT_CODE_COUNT
+} FaultCode_t;
+
+// Flash 中的记录 (小端, 36 字节)
+typedef struct {
+    uint32_t seq;        // 全局序号
+    uint32_t time_ms;    // 本次上电后的时刻
+    uint16_t boot;       // 上电序号 (有故障写入的上电才递增)
+    uint8_t  code;       // FaultCode_t
+    uint8_t  motor;      // 电机号 (0 起)
+    uint8_t  motor_mode; // CtrlMode_t
+    uint8_t  link_mode;
+    uint8_t  link_step;
+    uint8_t  detail;
+    uint16_t repeat;     // 上一条同码记录之后被抑制的次数
+    uint16_t vbus_dv;    // 母线电压 0.1V
+    int16_t  temp_dc;    // 温度 0.1℃
+    uint16_t cur_ma;     // 电流 mA
+    uint16_t adc_pos;    // ADC 位置原始值
+    uint16_t duty;       // PWM 占空比 0~1000
+    int32_t  position;   // 绝对位置
+    uint32_t crc;        // CRC (bsp_crc.h), 以上字段
+} FaultRecord_t;
+
+// 二进制导出块: [0xA5 0x5A 0xF1 Count LenL LenH Record... Sum], Sum = 前面所有字节之和 (低 8 位)
+#define FAULT_BIN_SYNC0     0xA5
+#define FAULT_BIN_SYNC1     0x5A
+#define FAULT_BIN_TYPE      0xF1
+
+typedef struct {
+    uint8_t  count;      // Flash 中的有效记录数
+    uint8_t  capacity;
+    uint16_t boot;       // 本次上电序号
+    uint32_t next_seq;
+    uint32_t reported;   // 本次上电上报次数 (含被抑制的)
+    uint32_t written;    // 本次上电写入的记录数
+    uint32_t suppressed; // 同码抑制次数
+    uint32_t dropped;    // 待写队列满 / 写入失败丢弃的记录数
+} FaultStat_t;
+
+void App_Fault_Init(void);
+// 上报故障 (可在中断中调用), motor 无关时填 0
+void App_Fault_Report(FaultCode_t code, uint8_t motor, uint8_t detail);
+// 主循环: 写入待写记录, 检查 LIN 总线错误
+void App_Fault_Process(void);
+// 读取第 idx 条记录 (0 = 最新), 不存在返回 0; 记录直接指向 Flash
+const FaultRecord_t *App_Fault_Get(uint8_t idx);
+// 清空故障历史 (后台擦除)
+void App_Fault_Clear(void);
+void App_Fault_GetStat(FaultStat_t *stat);
+const char *App_Fault_Name(uint8_t code);
+
+#endif
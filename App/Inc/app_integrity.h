@@ -0,0 +1,64 @@
+#ifndef APP_INTEGRITY_H
+#define APP_INTEGRITY_H
+
+#include "main.h"
+
+// 完整性校验 (CRC 服务见 bsp_crc.h)
+// 上电时与 AT+CRC 请求时校验: 运行中的固件镜像、配置存储记录、联动程序槽; 失败写入故障历史 (FAULT_CRC).
+//
+// 固件镜像: 向量表之后的 .fw_info 段保存镜像信息, 构建后由 Tools/fw_crc.py 填入镜像长度,
+// 并把 [Flash 起始, 起始 + length) 的 CRC 追加在镜像末尾 (.bin / .hex).
+// 调试器直接下载 ELF 时 length 仍为擦除值, 视为未签名, 不报故障.
+#define FW_INFO_MAGIC       0x31495746u // "FWI1"
+#define FW_INFO_UNSIGNED    0xFFFFFFFFu
+
+typedef struct {
+    uint32_t magic;
+    uint32_t length;        // 镜像长度 (字节, 4 的倍数), CRC 紧随其后
+} FwInfo_t;
+
+// 校验对象, 同时作为 FAULT_CRC 的 detail
+typedef enum {
+    INTEG_SRC_IMAGE = 1,    // 固件镜像
+    INTEG_SRC_CONFIG,       // 配置存储 (含旧版整页配置)
+    INTEG_SRC_PROGRAM,      // 联动程序槽 (app_linkprog.h)
+} IntegSource_t;
+
+typedef enum {
+    INTEG_IMAGE_OK = 0,
+    INTEG_IMAGE_UNSIGNED,   // 未经 fw_crc.py 处理
+    INTEG_IMAGE_BAD,        // 长度越界或 CRC 不符
+} IntegImage_t;
+
+typedef struct {
+    uint8_t  image;         // IntegImage_t
+    uint32_t image_len;
+    uint32_t image_crc;     // 计算值
+    uint32_t image_expect;  // 镜像末尾保存的值
+    uint32_t image_us;      // 镜像校验耗时
+    uint16_t cfg_records;   // 配置存储活动页有效记录数
+    uint16_t cfg_legacy;    // 其中旧版 CRC 记录数
+    uint16_t cfg_bad;       // 损坏记录数
+    uint8_t  cfg_busy;      // 存储写入未完成, 本次未重新校验配置 (cfg_* 为上次结果)
+    uint8_t  prog_slots;    // 已写入的联动程序槽数
+    uint8_t  prog_bad;      // 其中 CRC 不符的槽数
+    uint32_t failures;      // 本次上电校验失败次数 (镜像 + 配置 + 程序槽)
+} IntegReport_t;
+
+// 各计算途径对同一数据 (固件镜像, 未签名时取 Flash 前 16KB) 的耗时
+typedef struct {
+    uint32_t bytes;
+    uint32_t us_dma;
+    uint32_t us_cpu;
+    uint32_t us_sw;
+    uint8_t  match;         // 三种途径结果一致
+} IntegBench_t;
+
+// 上电校验 (App_Storage_Init / App_Fault_Init 之后调用)
+void App_Integrity_Init(void);
+// 立即重新校验, 结果同时保存为最近一次报告
+void App_Integrity_Check(IntegReport_t *report);
+void App_Integrity_GetReport(IntegReport_t *report);
+void App_Integrity_Bench(IntegBench_t *bench);
+
+#endif
@@ -2,7 +2,9 @@
 #ifndef APP_LINKAGE_H
 #define APP_LINKAGE_H
 
-// 联动模式定义
+#include "app_linkvm.h"
+
+// 联动模式定义 (模式 1~6 为内置字节码程序, 见 app_linkage.c)
 typedef enum {
     LINK_MODE_IDLE = 0, // 停止/手动
     LINK_MODE_1    = 1, // 逻辑1: 往复运动 (时间控制)
@@ -14,13 +16,87 @@ typedef enum {
     // 在此处添加更多...
 } LinkageMode_t;
 
+// 上传到 Flash 程序槽 n 的程序 (app_linkprog.h) 作为模式 0x10 + n 运行
+#define LINK_MODE_SLOT(n)   (0x10 + (n))
+
+// 联动实例: 每个实例是一个独立的程序上下文 (解释器状态 + 轮数 + 占用的电机), 可同时运行不同程序,
+// 例如两个轴组各跑各的往复. 启动时按程序中 MOVE_* / STOP 指令涉及的电机登记占用,
+// 与其它运行中实例的占用冲突时拒绝启动. 手动运动指令只打断占用该电机的实例.
+//
+// 调度由事件驱动 (event_bus.h): 实例停在等待类指令上时休眠, 按阻塞原因登记唤醒条件
+// (电机停止 / 事件定时器 / ADC 位置监视), 相应事件到来后才再次执行, 不再每轮轮询.
+// App_Linkage_Process 让每个被唤醒的实例连续执行, 直到再次阻塞或满 LINK_STEP_BURST 条指令
+// (未阻塞的实例下一轮继续), 起点轮转, 各实例机会均等.
+#define LINK_INSTANCES      2
+#define LINK_STEP_BURST     8
+
+typedef enum {
+    LINK_OK = 0,
+    LINK_ERR_INST,          // 实例号越界
+    LINK_ERR_MODE,          // 未知模式 / 空槽 / 程序校验失败
+    LINK_ERR_BUSY,          // 电机已被其它实例占用
+} LinkResult_t;
+
+// 实例状态 (AT+LINK 查询)
+typedef struct {
+    uint8_t  mode;          // 当前模式, 结束后为 0
+    uint8_t  last_mode;     // 最近一次启动的模式
+    uint8_t  state;         // LinkVmState_t
+    uint8_t  err;           // LinkVmErr_t
+    uint16_t pc;
+    uint32_t motors;        // 占用的电机 (bit n = 电机 n), 结束后清零
+    uint32_t loops_done;
+    uint32_t loops_target;
+    uint32_t steps;
+    uint8_t  blocked;       // 等待中 (LinkVmBlock_t)
+    uint32_t wakeups;       // 被事件唤醒次数
+} LinkInstStat_t;
+
+// 掉电快照: 联动进度 (每实例一份)
+typedef struct {
+    uint8_t  mode;
+    uint8_t  reserved;
+    uint16_t pc;           // 程序计数器 (指令字节偏移)
+    uint32_t loops_done;   // 已完成轮数
+    uint32_t loops_target; // 目标轮数 (0 = 无限)
+    uint16_t reg[LINKVM_REGS]; // 计数寄存器
+} LinkageResume_t;
+
 void App_Linkage_Init(void);
 /**
- * @brief 设置联动模式
- * @param mode_id 模式ID (1, 2, 3...)，0表示停止
+ * @brief 在实例 inst 上启动联动
+ * @param mode_id 模式ID (1, 2, 3...; LINK_MODE_SLOT(n) 为程序槽 n)，0表示停止该实例
+ * @param loop_count 循环次数 (0:无限循环, 1:跑一次, N:跑N次)
+ * @return LinkResult_t, 失败时实例保持停止
+ */
+LinkResult_t App_Linkage_Run(uint8_t inst, uint8_t mode_id, uint32_t loop_count);
+// 停止实例并刹停它占用的电机
+void App_Linkage_Stop(uint8_t inst);
+/**
+ * @brief 设置联动模式 (实例 0)
+ * @param mode_id 模式ID, 0表示停止所有实例
  * @param loop_count 循环次数 (0:无限循环, 1:跑一次, N:跑N次)
  */
 void App_Linkage_SetMode(uint8_t mode_id, uint32_t loop_count);
+// 手动指令接管电机 id 前调用: 停止占用它的实例 (同 App_Linkage_Stop)
+void App_Linkage_ReleaseMotor(uint8_t id);
+// 停止所有运行 mode_id 的实例 (程序槽被改写前)
+void App_Linkage_StopMode(uint8_t mode_id);
 void App_Linkage_Process(void);
+// 按参数 BOOTMODE / BOOTLOOP 在实例 0 启动上电默认联动 (BOOTMODE = 0 不启动)
+void App_Linkage_StartDefault(void);
+
+// 状态查询 (遥测/故障记录使用, 实例 0)
+uint8_t App_Linkage_GetMode(void);
+uint8_t App_Linkage_GetStep(void); // 程序计数器 (超过 255 时为 255)
+// 所有实例均已停止
+uint8_t App_Linkage_Idle(void);
+// 有已唤醒待执行的实例 (主循环不能 WFI)
+uint8_t App_Linkage_Ready(void);
+void App_Linkage_GetStat(uint8_t inst, LinkInstStat_t *st);
+
+// 读取联动进度 (可在中断中调用) / 从快照的步骤继续 (电机的中断运动由 App_Motor_Resume 续跑)
+void App_Linkage_GetResume(uint8_t inst, LinkageResume_t *r);
+void App_Linkage_Resume(uint8_t inst, const LinkageResume_t *r);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef APP_LINKPROG_H
+#define APP_LINKPROG_H
+
+#include "main.h"
+#include "bsp_conf.h"
+
+// 联动程序存储: 上传的字节码程序 (格式见 app_linkvm.h) 保存在 Flash 程序槽中, 每槽一页.
+// 上传流程 (AT+PROG / LIN DID 0x0300~, 主机工具 Tools/link_asm.py):
+//   BEGIN(槽号, 长度, 名称) -> 按偏移顺序写入若干数据块 -> END(CRC)
+// 数据先收进 RAM 暂存区, END 时校验 CRC (bsp_crc.h, 与 fw_crc.py 相同算法) 并整体校验字节码,
+// 全部通过才擦除并写入槽 (后台 Flash 作业), 上传失败或中途放弃不影响槽中原有程序.
+// 槽 n 作为联动模式 LINK_MODE_SLOT(n) 运行 (AT+LINK / LIN 指令 6 / BOOTMODE), 启动前再次校验 CRC.
+#define LINKPROG_SLOTS          2
+#define LINKPROG_MAGIC          0x3147504Cu // "LPG1"
+#define LINKPROG_NAME_LEN       8
+#define LINKPROG_ERASED_CRC     0xFFFFFFFFu
+
+// 槽内布局: 头部 + 字节码; 先写字节码, 最后写头部
+typedef struct {
+    uint32_t magic;
+    uint16_t len;                   // 字节码长度
+    uint16_t reserved;
+    char     name[LINKPROG_NAME_LEN]; // 不足补 0
+    uint32_t crc;                   // 字节码 CRC
+} LinkProgHeader_t;
+
+#define LINKPROG_MAX_LEN        (FLASH_PAGE_SIZE - sizeof(LinkProgHeader_t))
+
+typedef enum {
+    LINKPROG_OK = 0,
+    LINKPROG_ERR_ARG,       // 槽号 / 长度 / 名称越界
+    LINKPROG_ERR_STATE,     // 未 BEGIN, 或上一个程序仍在写入
+    LINKPROG_ERR_OFFSET,    // 数据块偏移与已收长度不连续
+    LINKPROG_ERR_LENGTH,    // END 时数据未收齐
+    LINKPROG_ERR_CRC,
+    LINKPROG_ERR_VERIFY,    // 字节码校验失败 (App_LinkVm_Verify)
+    LINKPROG_ERR_FLASH,     // 作业队列满 / 写入失败
+} LinkProgResult_t;
+
+typedef enum {
+    LINKPROG_UP_IDLE = 0,
+    LINKPROG_UP_RECEIVING,  // 已 BEGIN, 接收数据块
+    LINKPROG_UP_WRITING,    // 校验通过, 正在写入 Flash
+} LinkProgUpState_t;
+
+typedef struct {
+    uint8_t  valid;         // 头部与 CRC 均正确
+    uint16_t len;
+    uint32_t crc;
+    char     name[LINKPROG_NAME_LEN + 1];
+} LinkProgInfo_t;
+
+typedef struct {
+    uint8_t  state;         // LinkProgUpState_t
+    uint8_t  slot;
+    uint16_t len;           // BEGIN 声明的长度
+    uint16_t received;
+    uint8_t  last_result;   // 最近一次上传结果 (LinkProgResult_t)
+    uint8_t  vm_err;        // LINKPROG_ERR_VERIFY 时的 LinkVmErr_t
+    uint16_t vm_err_pc;
+    uint32_t uploads;       // 本次上电成功写入的程序数
+} LinkProgUpload_t;
+
+void App_LinkProg_Init(void);
+
+LinkProgResult_t App_LinkProg_Begin(uint8_t slot, uint16_t len, const char *name);
+// 写入数据块, off 须等于已收字节数
+LinkProgResult_t App_LinkProg_Write(uint16_t off, const uint8_t *data, uint16_t n);
+// 校验并写入槽 (后台完成, 期间 App_LinkProg_GetUpload 的 state = WRITING)
+LinkProgResult_t App_LinkProg_End(uint32_t crc);
+void App_LinkProg_Abort(void);
+LinkProgResult_t App_LinkProg_Delete(uint8_t slot);
+
+// 取槽中程序 (校验 CRC), 无效返回 0
+uint8_t App_LinkProg_Get(uint8_t slot, const uint8_t **code, uint16_t *len);
+void App_LinkProg_GetInfo(uint8_t slot, LinkProgInfo_t *info);
+void App_LinkProg_GetUpload(LinkProgUpload_t *up);
+// 完整性校验: 返回已写入但 CRC 不符的槽数
+uint8_t App_LinkProg_CheckSlots(uint8_t *used);
+
+#endif
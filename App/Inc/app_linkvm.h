@@ -0,0 +1,152 @@
+#ifndef APP_LINKVM_H
+#define APP_LINKVM_H
+
+#include "main.h"
+
+// 联动程序字节码解释器
+// 程序为字节序列, 指令 = 操作码 (1 字节) + 操作数 (小端), 长度由操作码决定 (见下表).
+// 跳转地址为程序内的字节偏移. 程序装入时整体校验一次 (操作码、长度、电机号、跳转目标落在指令边界),
+// 运行时不再检查, 每次 App_LinkVm_Step 最多执行一条指令: 等待类指令条件不满足时停在原地
+// 并报告阻塞原因 (App_LinkVm_GetBlock), 调度方在相应事件到来后再调用, 单次调用开销固定.
+//
+// 操作码                  操作数                                            说明
+// 0x00 END                -                                                 程序结束
+// 0x01 NOP                -
+// 0x10 MOVE_TIME          m, dir, speed u16, ms u32                         App_Motor_MoveTime
+// 0x11 MOVE_POS           m, dir, speed u16, pulses i32                     App_Motor_MovePos
+// 0x12 MOVE_POS_LIM       m, dir, speed u16, pulses i32                     App_Motor_MovePosWithLimit
+// 0x13 MOVE_ADC           m, speed u16, target u16, tol u16, range u16      App_Motor_MoveAdcPosWithLimit
+// 0x14 MOVE_MAN           m, dir, speed u16                                 App_Motor_MoveManual
+// 0x15 STOP               m (0xFF = 全部)                                   App_Motor_Stop
+// 0x20 WAIT_IDLE          m (0xFF = 全部)                                   等待电机停止
+// 0x21 DELAY              ms u32                                            停顿 (超过 ms 后继续)
+// 0x22 WAIT_ADC           m, cond, value u16                                等待 ADC 位置满足条件
+// 0x30 JMP                addr u16
+// 0x31 BR_ADC             m, cond, value u16, addr u16                      ADC 位置满足条件时跳转
+// 0x32 LOOP               addr u16                                          一轮结束: 轮数 +1, 未达目标轮数则跳转, 否则结束
+// 0x33 SET_REG            r, value u16                                      计数寄存器 (LINKVM_REGS 个)
+// 0x34 DJNZ               r, addr u16                                       寄存器减 1, 不为 0 则跳转
+// 0x40 SET_OUT            idx, level                                        输出脚 (bsp_conf.h LINK_OUT_TABLE)
+// cond: 0 = '<', 1 = '>=', 2 = '<=', 3 = '>'
+// 操作码与编码是上传程序的格式 (Tools/ 主机工具同步维护), 一经发布不得改变含义.
+
+#define LINKVM_REGS         2
+#define LINKVM_ALL_MOTORS   0xFF
+
+typedef enum {
+    LVM_END          = 0x00,
+    LVM_NOP          = 0x01,
+    LVM_MOVE_TIME    = 0x10,
+    LVM_MOVE_POS     = 0x11,
+    LVM_MOVE_POS_LIM = 0x12,
+    LVM_MOVE_ADC     = 0x13,
+    LVM_MOVE_MAN     = 0x14,
+    LVM_STOP         = 0x15,
+    LVM_WAIT_IDLE    = 0x20,
+    LVM_DELAY        = 0x21,
+    LVM_WAIT_ADC     = 0x22,
+    LVM_JMP          = 0x30,
+    LVM_BR_ADC       = 0x31,
+    LVM_LOOP         = 0x32,
+    LVM_SET_REG      = 0x33,
+    LVM_DJNZ         = 0x34,
+    LVM_SET_OUT      = 0x40,
+} LinkVmOp_t;
+
+typedef enum {
+    LVM_COND_LT = 0,
+    LVM_COND_GE,
+    LVM_COND_LE,
+    LVM_COND_GT,
+} LinkVmCond_t;
+
+typedef enum {
+    LVM_STATE_IDLE = 0,
+    LVM_STATE_RUN,
+    LVM_STATE_DONE,     // 执行到 END 或完成目标轮数
+    LVM_STATE_ERROR,    // 装入校验失败 / 运行中遇到未知操作码
+} LinkVmState_t;
+
+typedef enum {
+    LVM_ERR_NONE = 0,
+    LVM_ERR_OPCODE,     // 未知操作码
+    LVM_ERR_TRUNCATED,  // 指令超出程序末尾
+    LVM_ERR_ARG,        // 电机号 / 寄存器 / 输出号 / 条件越界
+    LVM_ERR_JUMP,       // 跳转目标不在指令边界
+    LVM_ERR_EMPTY,
+} LinkVmErr_t;
+
+// 内置程序的编码辅助
+#define LVM_U16(v)          (uint8_t)((uint32_t)(v) & 0xFFu), (uint8_t)(((uint32_t)(v) >> 8) & 0xFFu)
+#define LVM_U32(v)          LVM_U16((uint32_t)(v) & 0xFFFFu), LVM_U16((uint32_t)(v) >> 16)
+#define LVM_I_END()                          LVM_END
+#define LVM_I_MOVE_TIME(m, dir, spd, ms)     LVM_MOVE_TIME, (m), (dir), LVM_U16(spd), LVM_U32(ms)
+#define LVM_I_MOVE_POS(m, dir, spd, pulses)  LVM_MOVE_POS, (m), (dir), LVM_U16(spd), LVM_U32(pulses)
+#define LVM_I_MOVE_POS_LIM(m, dir, spd, p)   LVM_MOVE_POS_LIM, (m), (dir), LVM_U16(spd), LVM_U32(p)
+#define LVM_I_MOVE_ADC(m, spd, tgt, tol, rg) LVM_MOVE_ADC, (m), LVM_U16(spd), LVM_U16(tgt), LVM_U16(tol), LVM_U16(rg)
+#define LVM_I_MOVE_MAN(m, dir, spd)          LVM_MOVE_MAN, (m), (dir), LVM_U16(spd)
+#define LVM_I_STOP(m)                        LVM_STOP, (m)
+#define LVM_I_WAIT_IDLE(m)                   LVM_WAIT_IDLE, (m)
+#define LVM_I_DELAY(ms)                      LVM_DELAY, LVM_U32(ms)
+#define LVM_I_WAIT_ADC(m, cond, v)           LVM_WAIT_ADC, (m), (cond), LVM_U16(v)
+#define LVM_I_JMP(addr)                      LVM_JMP, LVM_U16(addr)
+#define LVM_I_BR_ADC(m, cond, v, addr)       LVM_BR_ADC, (m), (cond), LVM_U16(v), LVM_U16(addr)
+#define LVM_I_LOOP(addr)                     LVM_LOOP, LVM_U16(addr)
+#define LVM_I_SET_REG(r, v)                  LVM_SET_REG, (r), LVM_U16(v)
+#define LVM_I_DJNZ(r, addr)                  LVM_DJNZ, (r), LVM_U16(addr)
+#define LVM_I_SET_OUT(idx, level)            LVM_SET_OUT, (idx), (level)
+
+// 等待类指令条件未满足时的阻塞原因 (事件驱动调度据此决定由哪类事件唤醒)
+typedef enum {
+    LVM_BLOCK_NONE = 0,
+    LVM_BLOCK_MOTOR,    // WAIT_IDLE: 电机仍在运动
+    LVM_BLOCK_TIME,     // DELAY: 停顿未到
+    LVM_BLOCK_ADC,      // WAIT_ADC: 位置条件未满足
+} LinkVmBlock_t;
+
+typedef struct {
+    uint8_t  kind;      // LinkVmBlock_t
+    uint8_t  motor;     // MOTOR / ADC: 电机号 (MOTOR 可为 LINKVM_ALL_MOTORS)
+    uint8_t  above;     // ADC: 1 = 等待位置 >= level, 0 = 等待位置 < level
+    uint8_t  never;     // ADC: 条件不可能满足 (如 > 65535)
+    uint16_t level;
+    uint32_t remain_ms; // TIME: 剩余时间 (至少 1)
+} LinkVmBlockInfo_t;
+
+typedef struct {
+    const uint8_t *code;
+    uint16_t len;
+    uint16_t pc;            // 当前指令的字节偏移
+    uint8_t  state;         // LinkVmState_t
+    uint8_t  err;           // LinkVmErr_t
+    uint8_t  waiting;       // DELAY 已开始计时
+    uint8_t  blocked;       // 上次 Step 停在等待类指令上 (LinkVmBlock_t)
+    uint32_t wait_start;
+    uint16_t reg[LINKVM_REGS];
+    uint32_t loops_done;    // 已完成轮数 (LOOP 指令计数)
+    uint32_t loops_target;  // 目标轮数 (0 = 无限)
+    uint32_t steps;         // 已执行指令数
+} LinkVm_t;
+
+/**
+ * @brief 校验程序
+ * @param err_pc 出错指令的偏移 (可为 NULL)
+ * @return LinkVmErr_t
+ */
+uint8_t App_LinkVm_Verify(const uint8_t *code, uint16_t len, uint16_t *err_pc);
+// 装入并从头运行 (校验失败时进入 LVM_STATE_ERROR), loops = 0 无限循环
+uint8_t App_LinkVm_Start(LinkVm_t *vm, const uint8_t *code, uint16_t len, uint32_t loops);
+void App_LinkVm_Stop(LinkVm_t *vm);
+// 从 pc 处继续运行 (掉电续跑), pc 须在指令边界上, 成功返回 1
+uint8_t App_LinkVm_Seek(LinkVm_t *vm, uint16_t pc);
+// 执行一条指令 (等待类指令条件不满足时不前进并置 blocked), 返回 LinkVmState_t
+uint8_t App_LinkVm_Step(LinkVm_t *vm);
+// 阻塞在等待类指令上时, 解读其等待条件
+void App_LinkVm_GetBlock(const LinkVm_t *vm, LinkVmBlockInfo_t *b);
+// 指令长度 (含操作码), 未知操作码返回 0
+uint8_t App_LinkVm_OpLen(uint8_t op);
+// 程序驱动的电机 (MOVE_* / STOP 的电机号, bit n = 电机 n), 程序须已通过校验.
+// WAIT_IDLE / WAIT_ADC / BR_ADC 只读取状态, 不计入
+uint32_t App_LinkVm_Motors(const uint8_t *code, uint16_t len);
+
+#endif
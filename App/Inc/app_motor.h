@@ -8,14 +8,30 @@ typedef enum {
     CTRL_RUN_MANUAL, // 手动一直跑
     CTRL_RUN_TIME,   // 跑时间
     CTRL_RUN_POS,    // 跑位置
-    CTRL_RUN_ADC_POS // 跑绝对ADC位置
+    CTRL_RUN_ADC_POS, // 跑绝对ADC位置
+    CTRL_WAIT_START   // 同步启动: 等待启动时刻
 } CtrlMode_t;
 
+// 掉电快照: 中断的运动 (上电后续跑剩余部分)
+typedef struct {
+    uint8_t  mode;       // CtrlMode_t, 同步启动等待中记为 CTRL_STOP
+    uint8_t  dir;
+    uint8_t  with_limit;
+    uint8_t  reserved;
+    uint16_t speed;
+    uint16_t tolerance;  // ADC 位置: 允许误差
+    int32_t  arg;        // 位置: 剩余脉冲; 定时: 剩余 ms; ADC 位置: 目标 ADC
+    uint16_t range;      // ADC 位置: 减速范围
+    uint16_t reserved2;
+} MotorResume_t;
+
 void App_Motor_Init(void);
 void App_Motor_Process(void); // 周期调用
 
 // 功能接口
 void App_Motor_MoveTime(uint8_t id, uint8_t dir, uint16_t speed, uint32_t ms);
+// 微秒精度定时运行 (TIM3 比较通道到期停机)
+void App_Motor_MoveTimeUs(uint8_t id, uint8_t dir, uint16_t speed, uint64_t us);
 void App_Motor_MovePos(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses);
 //void App_Motor_MovePosWithLimit(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses);
 
@@ -29,16 +45,28 @@ void App_Motor_MoveAdcPosWithLimit(uint8_t id, uint16_t speed, uint16_t target_a
 
 // 配置接口：设置预减速参数
 void App_Motor_ConfigDecel(uint8_t id, uint32_t decel_pulses, uint16_t min_speed);
+void App_Motor_GetDecel(uint8_t id, uint32_t *decel_pulses, uint16_t *min_speed);
 
-// 配置接口：设置限位开关 (cw_pin: 正转限位, ccw_pin: 反转限位, active_level: 触发电平 0或1)
+// 配置接口：设置限位开关 (cw_pin: 正转限位, ccw_pin: 反转限位, active_level: 触发电平 0或1, 端口均为 NULL 取消)
 void App_Motor_ConfigLimit(uint8_t id, GPIO_TypeDef* cw_port, uint16_t cw_pin, 
                            GPIO_TypeDef* ccw_port, uint16_t ccw_pin, GPIO_PinState active_level);
 
 // 新增功能：带限位检测的位置移动
 void App_Motor_MovePosWithLimit(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses);
 
-void App_Motor_Stop(uint8_t id);
+// 同步启动: 在本地时刻 at_us (BSP_Time_GetUs 时基) 由 TIM3 比较中断开始运动, 已过期则立即开始
+// 等待期间电机刹车, App_Motor_IsBusy 返回 1, App_Motor_Stop 取消
+void App_Motor_MoveTimeAt(uint8_t id, uint64_t at_us, uint8_t dir, uint16_t speed, uint32_t ms);
+void App_Motor_MovePosAt(uint8_t id, uint64_t at_us, uint8_t dir, uint16_t speed, int32_t pulses, uint8_t with_limit);
+void App_Motor_MoveAdcPosAt(uint8_t id, uint64_t at_us, uint16_t speed, uint16_t target_adc,
+                            uint16_t tolerance, uint16_t range_adc, uint8_t with_limit);
+
+void App_Motor_Stop(uint8_t id); // 可在中断中调用
 uint8_t App_Motor_IsBusy(uint8_t id); // 返回1表示正在运行
+uint8_t App_Motor_GetMode(uint8_t id); // CtrlMode_t
+// 读取当前运动以便掉电后续跑 (可在中断中调用) / 按快照重新下发
+void App_Motor_GetResume(uint8_t id, MotorResume_t *r);
+void App_Motor_Resume(uint8_t id, const MotorResume_t *r);
 
 // 新增：手动模式接口
 void App_Motor_MoveManual(uint8_t id, uint8_t dir, uint16_t speed);
@@ -0,0 +1,72 @@
+#ifndef APP_PARAM_H
+#define APP_PARAM_H
+
+#include "main.h"
+
+// 运行参数注册表
+// 各模块在 Init 中用 App_Param_Register() 登记自己的参数表 (编号/类型/范围/默认值/读写函数),
+// 登记时即应用 Flash 中保存的值 (没有或越界则用默认值). 参数值始终由所属模块保存,
+// 注册表只通过 get/set 访问, 因此 AT+CFGDECEL、LIN DID 等旧接口修改的值同样可被读出与保存.
+// 数值一律为定点整数 (单位见 unit), 不使用浮点格式化.
+//
+// 保存: App_Param_Save() 把与 Flash 不同的参数逐个写入配置存储 (键 PARAM_KV_KEY(num)),
+// 从未保存过且等于默认值的参数不占用存储空间. 存储忙时其余参数由 App_Param_Process() 在主循环中续写.
+
+#define PARAM_MAX_TABLES    8
+#define PARAM_KV_KEY(num)   (0x0100u + (num))
+
+typedef enum {
+    PARAM_U8 = 0,
+    PARAM_U16,
+    PARAM_U32,
+    PARAM_I32,
+} ParamType_t;
+
+typedef struct {
+    uint8_t     id;     // 参数号; 数组参数占用 id ~ id + count - 1
+    uint8_t     count;  // 元素数 (如按电机编号), 普通参数为 1
+    uint8_t     type;   // ParamType_t, 决定 LIN 传输宽度
+    const char *name;   // AT 名称, 数组参数后接元素序号 (如 DECEL0)
+    const char *unit;
+    int32_t     min;
+    int32_t     max;
+    int32_t     def;
+    int32_t   (*get)(uint8_t idx);
+    void      (*set)(uint8_t idx, int32_t value);
+} ParamDesc_t;
+
+// 参数引用: 描述 + 数组下标
+typedef struct {
+    const ParamDesc_t *desc;
+    uint8_t idx;
+} ParamRef_t;
+
+typedef enum {
+    PARAM_OK = 0,
+    PARAM_ERR_UNKNOWN,
+    PARAM_ERR_RANGE,
+    PARAM_ERR_FLASH,
+} ParamStatus_t;
+
+// 登记参数表 (表须为静态常量), 并应用已保存值或默认值
+void App_Param_Register(const ParamDesc_t *table, uint8_t count);
+
+// 查找: 按参数号 / 按名称 (不区分大小写, 如 "DECEL0")
+uint8_t App_Param_Find(uint8_t num, ParamRef_t *ref);
+uint8_t App_Param_FindByName(const char *name, ParamRef_t *ref);
+// 遍历: pos 从 0 开始, 越界返回 0
+uint8_t App_Param_At(uint16_t pos, ParamRef_t *ref);
+
+uint8_t App_Param_Num(const ParamRef_t *ref);          // 参数号
+uint8_t App_Param_Size(const ParamRef_t *ref);         // LIN 传输字节数 1/2/4
+int32_t App_Param_Get(const ParamRef_t *ref);
+ParamStatus_t App_Param_Set(const ParamRef_t *ref, int32_t value); // 仅 RAM, 立即生效
+
+// 写入 Flash (只写有变化的参数), 任一参数写入失败返回 PARAM_ERR_FLASH; 存储忙不算失败, 稍后续写
+ParamStatus_t App_Param_Save(void);
+// 主循环调用: 续写因存储忙未写入的参数
+void App_Param_Process(void);
+// 全部恢复默认值 (RAM, 需 App_Param_Save 才持久化)
+void App_Param_ResetDefaults(void);
+
+#endif
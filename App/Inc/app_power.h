@@ -0,0 +1,34 @@
+#ifndef APP_POWER_H
+#define APP_POWER_H
+
+#include "main.h"
+
+// 低功耗管理
+// 休眠条件: LIN 休眠指令 / LIN 总线空闲超时 (电机与联动均空闲时) / AT+SLEEP
+// 休眠过程: 停止联动并刹车所有电机 -> 停止 TIM3 与 ADC -> TJA1021 Sleep -> MCU Stop 模式
+// 唤醒源:   LIN 总线显性 (PB11) 或调试串口 RX (PA10) 下降沿
+
+typedef enum {
+    POWER_SLEEP_NONE = 0,
+    POWER_SLEEP_LIN_CMD,   // LIN 休眠指令 (0x3C, Data0 = 0x00)
+    POWER_SLEEP_LIN_IDLE,  // LIN 总线空闲超过 g_Config.lin_sleep_timeout_s
+    POWER_SLEEP_AT,        // AT+SLEEP
+} PowerSleepReason_t;
+
+typedef struct {
+    uint32_t sleeps;      // 休眠次数
+    uint8_t  last_reason; // 最近一次休眠原因 (PowerSleepReason_t)
+    uint8_t  last_wake;   // 最近一次唤醒源 (BSP_WAKE_xxx)
+    uint32_t idles;       // 主循环空闲 WFI 次数
+} PowerStat_t;
+
+// 请求休眠 (在主循环 App_Power_Process 中执行)
+void App_Power_RequestSleep(PowerSleepReason_t reason);
+// 主循环: 检查休眠条件, 满足时进入 Stop 模式并在唤醒后返回
+void App_Power_Process(void);
+void App_Power_GetStat(PowerStat_t *stat);
+// 主循环末尾: 没有待处理事件、已唤醒的联动与 Flash 作业时 WFI 等待中断 (Sleep 模式, 外设照常运行).
+// TIM3 10kHz 节拍与 ADC DMA 持续产生中断, 其余轮询任务的额外延迟不超过 100us
+void App_Power_Idle(void);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef APP_SNAPSHOT_H
+#define APP_SNAPSHOT_H
+
+#include "main.h"
+#include "bsp_bldc.h"
+#include "app_linkage.h"
+
+// 掉电快照
+// 掉电预警时 (PVD: VDD 跌破 POWER_PVD_LEVEL / 母线电压低于 VMIN) 在中断中刹车所有电机,
+// 并把绝对位置、中断的运动与联动进度写入一直保持擦除状态的快照页 (FLASH_SNAP_PAGE_ADDR).
+// 一条记录 34 个半字 (每个联动实例一份进度), 约 1.6ms, 需在稳压器维持时间内完成.
+// 上电时恢复最新的有效记录: 绝对位置总是恢复; 参数 RESUME = 1 时续跑中断的运动并从原步骤继续联动.
+// 恢复后记录作废 (状态字写 0); 电压回升未掉电时同样作废, 重新布防.
+//
+// 页内记录顺序追加, 空位不足时在后台擦除整页 (Flash 作业队列), 擦完之前不布防.
+
+#define SNAP_ARM_MS     1000 // 电压持续正常多久后布防
+
+typedef enum {
+    SNAP_SRC_NONE = 0,
+    SNAP_SRC_PVD,          // VDD 跌破 PVD 阈值
+    SNAP_SRC_VBUS,         // 母线电压低于 VMIN
+} SnapSource_t;
+
+typedef struct {
+    uint8_t  armed;        // 已布防: 掉电时会写快照
+    uint8_t  restored;     // 本次上电恢复了快照 (0 = 无有效快照)
+    uint8_t  resumed;      // 本次上电续跑了运动 / 联动
+    uint8_t  last_src;     // 最近一次快照来源 (SnapSource_t)
+    uint16_t last_vbus_dv; // 最近一次快照时母线电压 (0.1V)
+    uint8_t  slot_used;    // 快照页已用记录数
+    uint8_t  slot_total;
+    uint32_t saves;        // 本次上电写入的快照数 (电压跌落后回升)
+    uint32_t failures;     // 写入失败次数
+    // 最近一次写入 / 恢复的快照内容
+    int32_t  pos[MAX_MOTORS];        // 绝对位置
+    uint8_t  motor_mode[MAX_MOTORS]; // 中断的运动 (CtrlMode_t)
+    LinkageResume_t link[LINK_INSTANCES];
+} SnapStat_t;
+
+// 上电初始化: 恢复快照并启用 PVD; 续跑了联动返回 1 (此时不再启动 BOOTMODE 默认联动)
+uint8_t App_Snapshot_Init(void);
+// 掉电预警 (中断上下文), 已布防时写入快照
+void App_Snapshot_OnPowerFail(SnapSource_t src);
+// 主循环: 电压回升后作废快照并重新布防, 空位不足时擦除快照页
+void App_Snapshot_Process(void);
+// 已写快照、电压尚未回升: 主循环暂停联动, 回升后按快照续跑
+uint8_t App_Snapshot_Holding(void);
+void App_Snapshot_GetStat(SnapStat_t *stat);
+
+#endif
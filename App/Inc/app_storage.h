@@ -3,29 +3,52 @@
 
 #include "main.h"
 
-// STM32F103C8T6 Flash: 64KB
-// Page Size: 1KB (Medium Density)
-// Last Page Address: 0x0800FC00 (Starting address of the last 1KB page)
-#define STORAGE_FLASH_PAGE_ADDR  0x0800FC00 
+// 配置按字段保存在 Flash 键值存储中 (flash_kv.h, 两页交替追加, 掉电安全)
+// 旧版固件把整个 AppConfig_t 拷贝到最后一页 (现为存储页 1), 上电时作为尚未迁移字段的来源
+#define STORAGE_LEGACY_ADDR      0x0800FC00
 #define STORAGE_MAGIC            0xA5A55A5A 
+#define STORAGE_SLEEP_TIMEOUT_MAX 3600 // LIN 空闲休眠超时上限 (秒)
 
-// 数据结构定义 (必须4字节对齐)
+// LIN 主机调度表 (本板作为总线主机时按表轮流发送帧头)
+#define LIN_SCHED_MAX            8
+#define LIN_SCHED_EMPTY          0xFF // 空槽 (id)
+#define LIN_SCHED_RESP           0    // 从机应答帧: 主机只发帧头并收集应答
+#define LIN_SCHED_CMD            1    // 指令帧: 主机发送帧头 + 数据
+
+typedef struct {
+    uint8_t  id;        // 帧 ID 0~63, LIN_SCHED_EMPTY = 空槽
+    uint8_t  len;       // 数据长度 1~8
+    uint8_t  dir;       // LIN_SCHED_RESP / LIN_SCHED_CMD
+    uint8_t  reserved;
+    uint16_t delay_ms;  // 本时隙长度 (到下一时隙帧头的间隔)
+    uint16_t reserved2;
+    uint8_t  data[8];   // 指令数据 (LIN_SCHED_CMD)
+} LinSchedEntry_t;
+
+// 数据结构定义 (必须4字节对齐, 字段布局与旧版整页配置保持兼容)
 typedef struct {
-    uint32_t magic;         // 魔数，用于检测是否已初始化
+    uint32_t magic;         // 魔数 (仅旧版整页配置使用)
     uint32_t device_id;     // 设备ID
-    uint32_t baud_rate;     // 波特率 (预留)
+    uint32_t baud_rate;     // AT/日志串口波特率 (AT+BAUD 协商后保存)
     uint32_t motor_limit_triggered_val; // 上次限位触发值 (示例扩展)
-    // 在此处添加更多字段...
-    
-    // 自动填充至 1KB 边界 (可选)
+    uint32_t lin_group_mask;  // LIN 组播成员掩码 (bit0~3 对应组 0~3)
+    uint32_t lin_sleep_timeout_s; // LIN 总线空闲休眠超时 (秒, 0 = 禁用)
+    uint32_t lin_master_en;   // 上电后运行 LIN 主机调度表
+    LinSchedEntry_t lin_sched[LIN_SCHED_MAX];
+    // 在此处添加更多字段, 并在 app_storage.c 的 storage_fields[] 中分配新的存储键
 } AppConfig_t;
 
 extern AppConfig_t g_Config;
 
 // API
 void App_Storage_Init(void);
+// 只把与 Flash 中不同的字段追加写入, 未修改时不访问 Flash; 存储忙时剩余字段由 App_Storage_Process 续写
 void App_Storage_Save(void);
+// 主循环调用: 续写因存储忙未写入的字段
+void App_Storage_Process(void);
 void App_Storage_SetDeviceID(uint8_t id);
+void App_Storage_SetLinGroups(uint8_t mask);
+void App_Storage_SetLinSleepTimeout(uint32_t sec);
 void App_Storage_ResetFactory(void);
 
 #endif
@@ -2,18 +2,19 @@
 #include "app_adc.h"
 #include "bsp_conf.h" // 引用配置宏
 #include "app_motor.h"
+#include "bsp_time.h"
+#include "app_param.h"
+#include "app_snapshot.h"
+#include "app_fault.h"
+#include "event_bus.h"
+#define LOG_MODULE LOG_MOD_ADC
 #include "log.h"
 #include <math.h>
 
 // extern ADC_HandleTypeDef hadc1; // 移除直接 extern，使用 ADC_HANDLE
 
 AppAdcData_t g_adc_data;
-static AdcProtectionConfig_t prot_conf = {
-    .volt_limit_min = 10.0f,
-    .volt_limit_max = 28.0f,
-    .temp_limit_max = 85.0f,
-    .protection_enable = 1
-};
+static AdcProtectionConfig_t prot_conf; // 由 App_Adc_Init 按参数表填充
 
 // 转换系数 (需根据实际硬件修改)
 #define COEFF_VOLT  (3.3f / 4095.0f * 11.0f) // 假设分压比 11 (10k+1k)
@@ -31,11 +32,30 @@ static float Calculate_NTC(uint16_t adc_val) {
     return temp;
 }
 
+// ---------------- 运行参数 (定点: mA / 0.1V / 0.1℃) ----------------
+static int32_t Param_GetImax(uint8_t m) { return lroundf(prot_conf.curr_limit_max[m] * 1000.0f); }
+static int32_t Param_GetVmin(uint8_t i) { (void)i; return lroundf(prot_conf.volt_limit_min * 10.0f); }
+static int32_t Param_GetVmax(uint8_t i) { (void)i; return lroundf(prot_conf.volt_limit_max * 10.0f); }
+static int32_t Param_GetTmax(uint8_t i) { (void)i; return lroundf(prot_conf.temp_limit_max * 10.0f); }
+static int32_t Param_GetProt(uint8_t i) { (void)i; return prot_conf.protection_enable; }
+
+static void Param_SetImax(uint8_t m, int32_t v) { prot_conf.curr_limit_max[m] = v / 1000.0f; }
+static void Param_SetVmin(uint8_t i, int32_t v) { (void)i; prot_conf.volt_limit_min = v / 10.0f; }
+static void Param_SetVmax(uint8_t i, int32_t v) { (void)i; prot_conf.volt_limit_max = v / 10.0f; }
+static void Param_SetTmax(uint8_t i, int32_t v) { (void)i; prot_conf.temp_limit_max = v / 10.0f; }
+static void Param_SetProt(uint8_t i, int32_t v) { (void)i; App_Adc_SetProtectEnable((uint8_t)v); }
+
+static const ParamDesc_t adc_params[] = {
+    { 0x20, MAX_MOTORS, PARAM_U16, "IMAX", "mA",    0,    20000, 5000, Param_GetImax, Param_SetImax },
+    { 0x28, 1,          PARAM_U16, "VMIN", "0.1V",  0,    600,   90,   Param_GetVmin, Param_SetVmin },
+    { 0x29, 1,          PARAM_U16, "VMAX", "0.1V",  0,    600,   280,  Param_GetVmax, Param_SetVmax },
+    { 0x2A, 1,          PARAM_I32, "TMAX", "0.1C",  -400, 1500,  850,  Param_GetTmax, Param_SetTmax },
+    { 0x2B, 1,          PARAM_U8,  "PROT", "",      0,    1,     1,    Param_GetProt, Param_SetProt },
+};
+
 void App_Adc_Init(void) {
-    // 初始化默认保护参数
-    for(int i=0; i<MAX_MOTORS; i++) {
-        prot_conf.curr_limit_max[i] = 5.0f; // 默认 5A
-    }
+    // 保护阈值: 默认值与已保存值由参数注册表应用
+    App_Param_Register(adc_params, sizeof(adc_params) / sizeof(adc_params[0]));
 
     // 启动 ADC DMA (循环模式)
     if (HAL_ADC_Start_DMA(&hadc1, (uint32_t*)g_adc_data.raw, 4) != HAL_OK) {
@@ -43,6 +63,14 @@ void App_Adc_Init(void) {
     }
 }
 
+void App_Adc_Suspend(void) {
+    HAL_ADC_Stop_DMA(&hadc1); // 同时清除 ADON, ADC 下电
+}
+
+void App_Adc_Resume(void) {
+    HAL_ADC_Start_DMA(&hadc1, (uint32_t*)g_adc_data.raw, 4);
+}
+
 void App_Adc_ConfigProtect_Global(float v_min, float v_max, float t_max) {
     prot_conf.volt_limit_min = v_min;
     prot_conf.volt_limit_max = v_max;
@@ -55,6 +83,61 @@ void App_Adc_ConfigProtect_Motor(uint8_t id, float i_max) {
     }
 }
 
+void App_Adc_SetProtectEnable(uint8_t enable) {
+    prot_conf.protection_enable = enable ? 1 : 0;
+}
+
+void App_Adc_GetProtectConfig(AdcProtectionConfig_t *conf) {
+    if (conf) *conf = prot_conf;
+}
+
+uint8_t App_Adc_Undervoltage(void) {
+    return g_adc_data.voltage_V < prot_conf.volt_limit_min;
+}
+
+uint8_t App_Adc_GetCurrentTrip(uint8_t id, volatile const uint16_t **raw, uint16_t *limit) {
+    if (id != 0 || !prot_conf.protection_enable) return 0; // 目前仅电机 0 接有电流采样
+    float lim = prot_conf.curr_limit_max[id] / COEFF_CURR;
+    *raw = &g_adc_data.raw[AD_IDX_CUR];
+    *limit = (lim >= 4095.0f) ? 4095u : (uint16_t)lim;
+    return 1;
+}
+
+// 位置监视: 主循环设置, DMA 中断检查
+typedef struct {
+    volatile uint8_t armed;
+    uint8_t  id;
+    uint8_t  above;
+    uint16_t level;
+} AdcWatch_t;
+
+static AdcWatch_t adc_watch[ADC_WATCH_MAX];
+
+void App_Adc_Watch(uint8_t w, uint8_t id, uint16_t level, uint8_t above) {
+    if (w >= ADC_WATCH_MAX || id >= MAX_MOTORS) return;
+    adc_watch[w].armed = 0;
+    adc_watch[w].id = id;
+    adc_watch[w].above = above;
+    adc_watch[w].level = level;
+    adc_watch[w].armed = 1; // 参数先于使能位写入
+}
+
+void App_Adc_Unwatch(uint8_t w) {
+    if (w < ADC_WATCH_MAX) adc_watch[w].armed = 0;
+}
+
+static void Adc_CheckWatch(void) {
+    for (uint8_t w = 0; w < ADC_WATCH_MAX; w++) {
+        AdcWatch_t *aw = &adc_watch[w];
+        if (!aw->armed) continue;
+        uint16_t pos = g_adc_data.position[aw->id];
+        if (aw->above ? (pos >= aw->level) : (pos < aw->level)) {
+            aw->armed = 0;
+            EventBus_Post(EVT_ADC);
+        }
+    }
+}
+
 uint16_t App_Adc_GetPos(uint8_t id) {
     if (id >= MAX_MOTORS) return 0;
     return g_adc_data.position[id];
@@ -84,10 +167,15 @@ void App_Adc_Process(void) {
     
     g_adc_data.current_A[0] = (float)g_adc_data.raw[AD_IDX_CUR] * COEFF_CURR;
     g_adc_data.position[0]  = g_adc_data.raw[AD_IDX_POS];
+    Adc_CheckWatch();
 
     // 快速保护检查：过流
     if (prot_conf.protection_enable) {
         if (g_adc_data.current_A[0] > prot_conf.curr_limit_max[0]) {
+             if (g_adc_data.error_code != 3) {
+                 g_adc_data.error_time_us = BSP_Time_GetUs();
+                 App_Fault_Report(FAULT_OC, 0, 0); // 停机前记录, 保留运行状态
+             }
              g_adc_data.error_code = 3; // OC
              App_Motor_Stop(0); // 立即停止该电机
         }
@@ -101,6 +189,9 @@ void App_Adc_Process(void) {
         
         g_adc_data.voltage_V = (float)g_adc_data.raw[AD_IDX_VOL] * COEFF_VOLT;
         g_adc_data.temperature_C = Calculate_NTC(g_adc_data.raw[AD_IDX_NTC]);
+
+        // 掉电预警: 先于欠压保护停机写快照, 记下仍在进行的运动 (与保护开关无关)
+        if (g_adc_data.voltage_V < prot_conf.volt_limit_min) App_Snapshot_OnPowerFail(SNAP_SRC_VBUS);
         
         // 慢速保护检查
         if (prot_conf.protection_enable) {
@@ -110,6 +201,10 @@ void App_Adc_Process(void) {
             else if (g_adc_data.temperature_C > prot_conf.temp_limit_max) err = 4; // OT
             
             if (err != 0) {
+                if (g_adc_data.error_code != err) {
+                    g_adc_data.error_time_us = BSP_Time_GetUs();
+                    App_Fault_Report((FaultCode_t)err, 0, 0);
+                }
                 g_adc_data.error_code = err;
                 // 严重系统故障，停止所有
                 for(int i=0; i<MAX_MOTORS; i++) App_Motor_Stop(i);
@@ -0,0 +1,234 @@
+#include "app_fault.h"
+#include "app_motor.h"
+#include "app_linkage.h"
+#include "app_adc.h"
+#include "app_lin.h"
+#include "app_param.h"
+#include "bsp_bldc.h"
+#include "bsp_conf.h"
+#include "bsp_crc.h"
+#include "flash_job.h"
+#include "event_bus.h"
+#define LOG_MODULE LOG_MOD_SYS
+#include "log.h"
+#include <stddef.h>
+
+_Static_assert(sizeof(FaultRecord_t) == 36, "fault record layout is part of the export format");
+
+#define FAULT_SLOTS         (FLASH_PAGE_SIZE / sizeof(FaultRecord_t))
+#define FAULT_SLOT(p, i)    ((const FaultRecord_t *)(fault_page[p] + (uint32_t)(i) * sizeof(FaultRecord_t)))
+
+static const uint32_t fault_page[2] = { FLASH_FAULT_PAGE0_ADDR, FLASH_FAULT_PAGE1_ADDR };
+static const char *const fault_names[FAULT_CODE_COUNT] = {
+    "NONE", "OV", "UV", "OC", "OT", "STALL", "LIMIT", "LIN", "CRC"
+};
+
+static uint8_t  f_page = 0;      // 当前写入页
+static uint8_t  f_next = 0;      // 当前页下一个空位
+static uint32_t f_seq = 0;
+static uint16_t f_boot = 0;
+static uint8_t  f_busy = 0;      // 有记录正在写入
+static uint8_t  f_erasing = 0;   // 正在擦除的页数
+
+// 待写记录: 中断与主循环都可能上报, 入队时关中断; 下标自由递增
+static FaultRecord_t f_pending[FAULT_PENDING_MAX];
+static volatile uint8_t f_head = 0;
+static volatile uint8_t f_tail = 0;
+
+static uint8_t  f_seen[FAULT_CODE_COUNT];
+static uint32_t f_last_ms[FAULT_CODE_COUNT];
+static uint16_t f_repeat[FAULT_CODE_COUNT];
+static FaultStat_t f_stat;
+
+static uint32_t lin_poll_tick = 0;
+static uint32_t lin_err_total = 0;
+static uint8_t  lin_polled = 0;
+
+// 参数 FLTMASK: bit n = 记录故障码 n
+static uint16_t fault_mask = 0x1FE;
+
+static int32_t Param_GetMask(uint8_t i) { (void)i; return fault_mask; }
+static void Param_SetMask(uint8_t i, int32_t v) { (void)i; fault_mask = (uint16_t)v; }
+
+static const ParamDesc_t fault_params[] = {
+    { 0x40, 1, PARAM_U16, "FLTMASK", "", 0, 0xFFFF, 0x1FE, Param_GetMask, Param_SetMask },
+};
+
+static uint8_t Fault_Erased(const FaultRecord_t *r) {
+    const uint32_t *w = (const uint32_t *)r;
+    for (uint32_t i = 0; i < sizeof(*r) / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return 0;
+    }
+    return 1;
+}
+
+static uint8_t Fault_Valid(const FaultRecord_t *r) {
+    return r->code != FAULT_NONE && r->code < FAULT_CODE_COUNT
+        && r->crc == BSP_Crc_Calc(r, offsetof(FaultRecord_t, crc));
+}
+
+void App_Fault_Init(void) {
+    App_Param_Register(fault_params, sizeof(fault_params) / sizeof(fault_params[0]));
+
+    // 两页中序号最大的有效记录所在页为当前页, 空位从该页最后一条已用记录之后开始
+    uint8_t last[2] = { 0, 0 };
+    uint8_t found = 0;
+    uint32_t max_seq = 0;
+    uint16_t max_boot = 0;
+    for (uint8_t p = 0; p < 2; p++) {
+        for (uint8_t i = 0; i < FAULT_SLOTS; i++) {
+            const FaultRecord_t *r = FAULT_SLOT(p, i);
+            if (Fault_Erased(r)) continue;
+            last[p] = i + 1u;
+            if (!Fault_Valid(r)) continue;
+            if (!found || (int32_t)(r->seq - max_seq) > 0) {
+                max_seq = r->seq;
+                f_page = p;
+            }
+            if (!found || (int16_t)(r->boot - max_boot) > 0) max_boot = r->boot;
+            found = 1;
+        }
+    }
+    f_next = last[f_page];
+    f_seq = found ? max_seq + 1u : 0;
+    f_boot = found ? (uint16_t)(max_boot + 1u) : 0;
+    LOG_INFO("Fault log: page=%d next=%d seq=%lu boot=%u\r\n", f_page, f_next, f_seq, f_boot);
+}
+
+void App_Fault_Report(FaultCode_t code, uint8_t motor, uint8_t detail) {
+    if (code == FAULT_NONE || code >= FAULT_CODE_COUNT || !(fault_mask & (1u << code))) return;
+    if (motor >= MAX_MOTORS) motor = 0;
+    EventBus_Post(EVT_FAULT); // 连发抑制只影响记录, 事件照常发布
+
+    uint32_t now = HAL_GetTick();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    f_stat.reported++;
+    if (f_seen[code] && now - f_last_ms[code] < FAULT_HOLDOFF_MS) {
+        f_repeat[code]++;
+        f_stat.suppressed++;
+    } else if ((uint8_t)(f_head - f_tail) >= FAULT_PENDING_MAX) {
+        f_stat.dropped++;
+    } else {
+        FaultRecord_t *r = &f_pending[f_head % FAULT_PENDING_MAX];
+        r->time_ms = now;
+        r->code = (uint8_t)code;
+        r->motor = motor;
+        r->motor_mode = App_Motor_GetMode(motor);
+        r->link_mode = App_Linkage_GetMode();
+        r->link_step = App_Linkage_GetStep();
+        r->detail = detail;
+        r->repeat = f_repeat[code];
+        r->vbus_dv = (uint16_t)(g_adc_data.voltage_V * 10.0f);
+        r->temp_dc = (int16_t)(g_adc_data.temperature_C * 10.0f);
+        r->cur_ma = (uint16_t)(g_adc_data.current_A[motor] * 1000.0f);
+        r->adc_pos = g_adc_data.position[motor];
+        r->duty = motors[motor].state.current_duty;
+        r->position = BSP_BLDC_GetPosition(motor);
+        f_repeat[code] = 0;
+        f_seen[code] = 1;
+        f_last_ms[code] = now;
+        f_head++;
+    }
+    __set_PRIMASK(primask);
+}
+
+static void Fault_OnWritten(void *ctx, uint8_t ok) {
+    (void)ctx;
+    f_busy = 0;
+    f_tail++;
+    if (ok) f_stat.written++;
+    else f_stat.dropped++;
+}
+
+static void Fault_OnErased(void *ctx, uint8_t ok) {
+    (void)ctx;
+    if (f_erasing) f_erasing--;
+    if (!ok) LOG_ERROR("Fault log erase failed\r\n");
+}
+
+static void Fault_Erase(uint8_t page) {
+    FlashJob_t job = { .op = FLASH_JOB_ERASE, .addr = fault_page[page], .cb = Fault_OnErased };
+    if (FlashJob_Submit(&job)) f_erasing++;
+}
+
+// LIN 总线错误计数增加时上报一次 (同码抑制限制写入频率)
+static void Fault_PollLin(void) {
+    if (HAL_GetTick() - lin_poll_tick < FAULT_LIN_POLL_MS) return;
+    lin_poll_tick = HAL_GetTick();
+
+    LinBusStat_t st;
+    App_LIN_GetBusStat(&st);
+    uint32_t total = 0;
+    for (int i = 1; i < LIN_ERR_COUNT; i++) total += st.err[i];
+    if (lin_polled && total > lin_err_total) App_Fault_Report(FAULT_LIN, 0, st.last_err);
+    lin_err_total = total; // AT+LINSTAT=0 清零后重新同步
+    lin_polled = 1;
+}
+
+void App_Fault_Process(void) {
+    Fault_PollLin();
+
+    if (f_busy || f_erasing || f_head == f_tail) return;
+
+    if (f_next >= FAULT_SLOTS) {
+        // 当前页写满: 擦除较旧的一页继续写
+        f_page ^= 1u;
+        f_next = 0;
+        Fault_Erase(f_page);
+        return;
+    }
+
+    FaultRecord_t *r = &f_pending[f_tail % FAULT_PENDING_MAX];
+    r->seq = f_seq;
+    r->boot = f_boot;
+    r->crc = BSP_Crc_Calc(r, offsetof(FaultRecord_t, crc));
+
+    FlashJob_t job = { .op = FLASH_JOB_PROGRAM, .addr = (uint32_t)FAULT_SLOT(f_page, f_next),
+                       .len = sizeof(*r), .src = r, .cb = Fault_OnWritten };
+    if (!FlashJob_Submit(&job)) return;
+    f_seq++;
+    f_next++;
+    f_busy = 1;
+}
+
+const FaultRecord_t *App_Fault_Get(uint8_t idx) {
+    if (f_erasing) return NULL;
+    // 两页各自按序追加: 当前页从后往前, 再到另一页
+    for (uint8_t k = 0; k < 2; k++) {
+        uint8_t p = f_page ^ k;
+        for (int i = (k == 0 ? f_next : (int)FAULT_SLOTS) - 1; i >= 0; i--) {
+            const FaultRecord_t *r = FAULT_SLOT(p, i);
+            if (!Fault_Valid(r)) continue;
+            if (idx-- == 0) return r;
+        }
+    }
+    return NULL;
+}
+
+void App_Fault_Clear(void) {
+    Fault_Erase(0);
+    Fault_Erase(1);
+    f_page = 0;
+    f_next = 0;
+    LOG_INFO("Fault log cleared\r\n");
+}
+
+void App_Fault_GetStat(FaultStat_t *stat) {
+    if (!stat) return;
+    *stat = f_stat;
+    stat->capacity = 2u * FAULT_SLOTS;
+    stat->boot = f_boot;
+    stat->next_seq = f_seq;
+    stat->count = 0;
+    if (f_erasing) return;
+    for (uint8_t p = 0; p < 2; p++) {
+        for (uint8_t i = 0; i < FAULT_SLOTS; i++) {
+            if (Fault_Valid(FAULT_SLOT(p, i))) stat->count++;
+        }
+    }
+}
+
+const char *App_Fault_Name(uint8_t code) {
+    return (code < FAULT_CODE_COUNT) ? fault_names[code] : "?";
+}
@@ -0,0 +1,120 @@
+#include "app_integrity.h"
+#include "app_fault.h"
+#include "app_linkprog.h"
+#include "bsp_conf.h"
+#include "bsp_crc.h"
+#include "bsp_time.h"
+#include "flash_kv.h"
+#include "flash_job.h"
+#define LOG_MODULE LOG_MOD_SYS
+#include "log.h"
+#include <string.h>
+
+#define INTEG_BENCH_BYTES   (16u * 1024u) // 未签名镜像的测速长度
+
+// 镜像信息 (链接脚本放在向量表之后), length 由 Tools/fw_crc.py 在构建后填入
+__attribute__((section(".fw_info"), used))
+const FwInfo_t fw_info = { FW_INFO_MAGIC, FW_INFO_UNSIGNED };
+
+static IntegReport_t integ_report;
+
+// 构建后才填入的字段: 经 volatile 读取, 避免编译器按初值常量折叠
+static uint32_t Integ_ImageLength(void) {
+    return ((const volatile FwInfo_t *)&fw_info)->length;
+}
+
+static void Integ_CheckImage(IntegReport_t *r) {
+    uint32_t len = Integ_ImageLength();
+
+    r->image_len = len;
+    r->image_crc = 0;
+    r->image_expect = 0;
+    r->image_us = 0;
+    if (len == FW_INFO_UNSIGNED) {
+        r->image = INTEG_IMAGE_UNSIGNED;
+        return;
+    }
+    if ((len & 3u) || len < sizeof(fw_info) || len > FLASH_APP_END - FLASH_BASE - 4u) {
+        r->image = INTEG_IMAGE_BAD;
+        return;
+    }
+
+    uint32_t t0 = BSP_Time_GetUs32();
+    r->image_crc = BSP_Crc_Calc((const void *)FLASH_BASE, len);
+    r->image_us = BSP_Time_GetUs32() - t0;
+    r->image_expect = *(const volatile uint32_t *)(FLASH_BASE + len);
+    r->image = (r->image_crc == r->image_expect) ? INTEG_IMAGE_OK : INTEG_IMAGE_BAD;
+}
+
+static void Integ_CheckConfig(IntegReport_t *r) {
+    FlashKvCheck_t chk;
+    // 作业队列未完成时不等待 (运动中擦除会推迟), 沿用上次结果
+    r->cfg_busy = (FlashKV_Verify(&chk) < 0);
+    if (r->cfg_busy) return;
+    r->cfg_records = chk.records;
+    r->cfg_legacy = chk.legacy;
+    r->cfg_bad = chk.bad;
+}
+
+void App_Integrity_Check(IntegReport_t *report) {
+    IntegReport_t r = integ_report;
+
+    Integ_CheckImage(&r);
+    Integ_CheckConfig(&r);
+    if (r.image == INTEG_IMAGE_BAD) {
+        r.failures++;
+        App_Fault_Report(FAULT_CRC, 0, INTEG_SRC_IMAGE);
+        LOG_ERROR("Image CRC mismatch: len=%lu crc=%08lx expect=%08lx\r\n", r.image_len, r.image_crc, r.image_expect);
+    }
+    if (r.cfg_bad && !r.cfg_busy) {
+        r.failures++;
+        App_Fault_Report(FAULT_CRC, 0, INTEG_SRC_CONFIG);
+        LOG_WARN("Config store: %u bad records\r\n", r.cfg_bad);
+    }
+    r.prog_bad = App_LinkProg_CheckSlots(&r.prog_slots);
+    if (r.prog_bad) {
+        r.failures++;
+        App_Fault_Report(FAULT_CRC, 0, INTEG_SRC_PROGRAM);
+        LOG_WARN("Linkage program store: %u bad slots\r\n", r.prog_bad);
+    }
+    integ_report = r;
+    if (report) *report = r;
+}
+
+void App_Integrity_Init(void) {
+    memset(&integ_report, 0, sizeof(integ_report));
+    FlashJob_Flush(); // 上电时电机尚未启动, 先写完存储迁移的记录再校验
+    App_Integrity_Check(NULL);
+    LOG_INFO("Integrity: image=%d len=%lu %luus, cfg rec=%u legacy=%u bad=%u, prog slots=%u bad=%u\r\n",
+             integ_report.image, integ_report.image_len, integ_report.image_us,
+             integ_report.cfg_records, integ_report.cfg_legacy, integ_report.cfg_bad,
+             integ_report.prog_slots, integ_report.prog_bad);
+}
+
+void App_Integrity_GetReport(IntegReport_t *report) {
+    *report = integ_report;
+}
+
+void App_Integrity_Bench(IntegBench_t *bench) {
+    uint32_t len = Integ_ImageLength();
+    const void *data = (const void *)FLASH_BASE;
+    uint32_t crc[3];
+    uint32_t t0;
+
+    if (len == FW_INFO_UNSIGNED || (len & 3u) || len > FLASH_APP_END - FLASH_BASE) len = INTEG_BENCH_BYTES;
+    bench->bytes = len;
+
+    t0 = BSP_Time_GetUs32();
+    crc[0] = BSP_Crc_CalcPath(data, len, BSP_CRC_PATH_DMA);
+    bench->us_dma = BSP_Time_GetUs32() - t0;
+
+    t0 = BSP_Time_GetUs32();
+    crc[1] = BSP_Crc_CalcPath(data, len, BSP_CRC_PATH_CPU);
+    bench->us_cpu = BSP_Time_GetUs32() - t0;
+
+    t0 = BSP_Time_GetUs32();
+    crc[2] = BSP_Crc_CalcPath(data, len, BSP_CRC_PATH_SW);
+    bench->us_sw = BSP_Time_GetUs32() - t0;
+
+    bench->match = (crc[0] == crc[1] && crc[1] == crc[2]);
+}
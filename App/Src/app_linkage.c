@@ -1,463 +1,381 @@
 #include "app_linkage.h"
 #include "app_motor.h"
 #include "app_adc.h" // 引用ADC数据
-
-
-
-// --- 定义 ---
-typedef enum {
-    SM_IDLE,
-    SM_INIT,    // 初始化/准备步骤
-    SM_STEP_1,
-    SM_STEP_2,
-    SM_STEP_3,
-    SM_STEP_4,
-	SM_STEP_5,
-	SM_STEP_6,
-	SM_STEP_7,
-	//可增加步骤
-    SM_WAIT_FINISH // 等待该轮最后动作��成
-} LinkState_t;
-
-
-
+#include "app_param.h"
+#include "app_linkvm.h"
+#include "app_linkprog.h"
+#include "bsp_bldc.h"
+#include "event_bus.h"
+#define LOG_MODULE LOG_MOD_LINK
+#include "log.h"
+#include <string.h>
+
+
+
+// 联动由字节码程序描述 (指令集见 app_linkvm.h), 每个实例一个解释器上下文,
+// 实例阻塞在等待类指令上时休眠, 由事件总线唤醒 (见 app_linkage.h).
+// 模式 1~6 为内置程序, 与原手写状态机的动作和时序一致.
+
+// --- 内置程序 ---
+// 模式1: 简单的往复运动 (时间控制): 正转 2 秒 -> 停顿 500ms -> 反转 2 秒
+static const uint8_t prog_mode_1[] = {
+    /* 0 */ LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_TIME(0, MOTOR_DIR_CW, 800, 2000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_DELAY(500),
+            LVM_I_MOVE_TIME(0, MOTOR_DIR_CCW, 800, 2000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_LOOP(0),
+};
+
+// 模式2: 位置控制, 每轮单向跑 5000 脉冲
+static const uint8_t prog_mode_2[] = {
+    /* 0 */ LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_POS(0, MOTOR_DIR_CW, 600, 5000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_LOOP(0),
+};
+
+// 模式3: 多段速定位: 慢速 1000 脉冲 -> 快速 4000 脉冲 -> 停顿 1 秒 -> 回到起点
+static const uint8_t prog_mode_3[] = {
+    /* 0 */ LVM_I_MOVE_POS(0, MOTOR_DIR_CW, 200, 1000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_POS(0, MOTOR_DIR_CW, 800, 4000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_DELAY(1000),
+            LVM_I_MOVE_POS(0, MOTOR_DIR_CCW, 1000, 5000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_LOOP(0),
+};
+
+// 模式4: 带限位保护的顺序动作 (单电机演示, 第二个动作可改为电机 1):
+// 正转 (限位/5000 脉冲) -> 再正转 (限位/4000 脉冲) -> 停顿 1 秒 -> 反转找反向限位
+static const uint8_t prog_mode_4[] = {
+    /* 0 */ LVM_I_MOVE_POS_LIM(0, MOTOR_DIR_CW, 500, 5000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_POS_LIM(0, MOTOR_DIR_CW, 600, 4000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_DELAY(1000),
+            LVM_I_MOVE_POS_LIM(0, MOTOR_DIR_CCW, 500, 10000),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_LOOP(0),
+};
+
+// 模式5: 基于 ADC 绝对位置: 去 ADC=1000 -> 去 ADC=3000 -> 停顿 2 秒 -> 回 ADC=1000
+static const uint8_t prog_mode_5[] = {
+    /* 0 */ LVM_I_MOVE_ADC(0, 800, 1000, 10, 200),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_ADC(0, 600, 3000, 10, 200),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_DELAY(2000),
+            LVM_I_MOVE_ADC(0, 800, 1000, 10, 200),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_LOOP(0),
+};
+
+// 模式6: ADC 模拟限位往复: 正转至 ADC >= 4000 (约 3.3V) 停, 停顿 500ms, 反转至 ADC <= 100 停, 停顿 500ms
+static const uint8_t prog_mode_6[] = {
+    /* 0 */ LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_MAN(0, MOTOR_DIR_CW, 1000),
+            LVM_I_WAIT_ADC(0, LVM_COND_GE, 4000),
+            LVM_I_STOP(0),
+            LVM_I_DELAY(500),
+            LVM_I_WAIT_IDLE(0),
+            LVM_I_MOVE_MAN(0, MOTOR_DIR_CCW, 1000),
+            LVM_I_WAIT_ADC(0, LVM_COND_LE, 100),
+            LVM_I_STOP(0),
+            LVM_I_DELAY(500),
+            LVM_I_LOOP(0),
+};
+
+typedef struct {
+    const uint8_t *code;
+    uint16_t len;
+} LinkProgram_t;
+
+#define LINK_PROG(p) { (p), sizeof(p) }
+static const LinkProgram_t link_builtin[] = {
+    [LINK_MODE_1] = LINK_PROG(prog_mode_1),
+    [LINK_MODE_2] = LINK_PROG(prog_mode_2),
+    [LINK_MODE_3] = LINK_PROG(prog_mode_3),
+    [LINK_MODE_4] = LINK_PROG(prog_mode_4),
+    [LINK_MODE_5] = LINK_PROG(prog_mode_5),
+    [LINK_MODE_6] = LINK_PROG(prog_mode_6),
+};
+#define LINK_BUILTIN_COUNT (sizeof(link_builtin) / sizeof(link_builtin[0]))
 
 // --- 变量 ---
-static uint8_t current_mode = 0;
-static uint32_t target_loops = 0;     // 目标总次数 (0=无限)
-static uint32_t current_loop_cnt = 0; // 当前已执行次数
-static LinkState_t sm_state = SM_IDLE;
-static uint32_t sm_timer = 0;
-
-// --- 函数声明 ---不同的运行逻辑
-static void Logic_Mode_1(void);
-static void Logic_Mode_2(void);
-static void Logic_Mode_3(void);
-static void Logic_Mode_4(void);
-static void Logic_Mode_5(void); // Mode 5 declaration
-static void Logic_Mode_6(void); // Mode 6 declaration
+typedef struct {
+    uint8_t  mode;          // 0 = 未运行
+    uint8_t  last_mode;
+    uint8_t  ready;         // 已唤醒, 待执行
+    uint32_t wait_evt;      // 阻塞时等待的事件位掩码
+    uint32_t wakeups;
+    uint32_t motors;        // 占用的电机
+    LinkVm_t vm;
+} LinkInst_t;
+
+// 实例 n 使用事件定时器 n 与 ADC 位置监视 n
+_Static_assert(LINK_INSTANCES <= EVENT_TIMER_MAX && LINK_INSTANCES <= ADC_WATCH_MAX, "not enough wake sources");
+
+static LinkInst_t link_inst[LINK_INSTANCES];
+static uint8_t link_rr = 0; // 本轮最先执行的实例
+
+// 上电默认联动 (参数 BOOTMODE / BOOTLOOP)
+static uint8_t boot_mode = LINK_MODE_6;
+static uint32_t boot_loops = 0;
 
 // --- 接口实现 ---
 
-void App_Linkage_Init(void) {
-    current_mode = LINK_MODE_IDLE;
+static int32_t Param_GetBootMode(uint8_t i)  { (void)i; return boot_mode; }
+static int32_t Param_GetBootLoops(uint8_t i) { (void)i; return (int32_t)boot_loops; }
+static void Param_SetBootMode(uint8_t i, int32_t v)  { (void)i; boot_mode = (uint8_t)v; }
+static void Param_SetBootLoops(uint8_t i, int32_t v) { (void)i; boot_loops = (uint32_t)v; }
+
+static const ParamDesc_t link_params[] = {
+    { 0x30, 1, PARAM_U8,  "BOOTMODE", "",     0, LINK_MODE_SLOT(LINKPROG_SLOTS - 1), LINK_MODE_6, Param_GetBootMode, Param_SetBootMode },
+    { 0x31, 1, PARAM_U32, "BOOTLOOP", "loop", 0, 1000000,     0,           Param_GetBootLoops, Param_SetBootLoops },
+};
+
+// 事件派发 (主循环): 唤醒等待该类事件的实例, 条件是否满足由解释器重新判断
+static void Link_OnEvent(uint32_t events, void *ctx) {
+    (void)ctx;
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        LinkInst_t *li = &link_inst[i];
+        if (li->mode != LINK_MODE_IDLE && !li->ready && (li->wait_evt & events)) {
+            li->ready = 1;
+            li->wakeups++;
+        }
+    }
 }
 
+void App_Linkage_Init(void) {
+    memset(link_inst, 0, sizeof(link_inst));
+    link_rr = 0;
+    App_Param_Register(link_params, sizeof(link_params) / sizeof(link_params[0]));
+    EventBus_Subscribe(EVT_BIT(EVT_MOTOR_DONE) | EVT_BIT(EVT_TIMER) | EVT_BIT(EVT_ADC), Link_OnEvent, NULL);
+}
 
-
-void App_Linkage_SetMode(uint8_t mode_id, uint32_t loop_count) {
-    current_mode = mode_id;
-    target_loops = loop_count;
-    current_loop_cnt = 0;
-    
-    if (mode_id == 0) {
-        // 紧急停止所有
-        App_Motor_Stop(0); 
-        // App_Motor_Stop(1); ...
-		
-		
-        sm_state = SM_IDLE;
-    } else {
-        // 启动新任务
-        sm_state = SM_INIT; 
-    }
+void App_Linkage_StartDefault(void) {
+    App_Linkage_SetMode(boot_mode, boot_loops);
 }
 
-// 统一的状态机调度器
-void App_Linkage_Process(void) {
-    if (current_mode == 0) return;
-
-    switch (current_mode) {
-        case 1: Logic_Mode_1(); break;
-        case 2: Logic_Mode_2(); break;
-		case 3: Logic_Mode_3(); break;
-        case 4: Logic_Mode_4(); break;
-        case 5: Logic_Mode_5(); break; // Mode 5 case
-        case 6: Logic_Mode_6(); break; // Mode 6 case (Analog Reciprocating)
-        // Case 3, 4...
-        default:  
-            current_mode = 0; // 未知模式，自动停止
-            break;
+// 内置程序或 Flash 程序槽, 未找到时 prog 不变
+static void Link_Lookup(uint8_t mode_id, LinkProgram_t *prog) {
+    if (mode_id < LINK_BUILTIN_COUNT && link_builtin[mode_id].code) {
+        *prog = link_builtin[mode_id];
+    } else if (mode_id >= LINK_MODE_SLOT(0) && mode_id < LINK_MODE_SLOT(LINKPROG_SLOTS)) {
+        App_LinkProg_Get((uint8_t)(mode_id - LINK_MODE_SLOT(0)), &prog->code, &prog->len);
     }
 }
 
-// --- 辅助函数：处理循环计数 ---
-// 在每一轮逻辑结束时调用此函数
-// 返回 1 表示继续下一轮，返回 0 表示全部完成需停止
-static uint8_t Check_Loop_Finish(void) {
-    current_loop_cnt++;
-    
-    // 如果 target_loops 为 0，表示无限循环，始终返回 1
-    if (target_loops == 0) return 1;
-    
-    // 检查是否达到目标次数
-    if (current_loop_cnt >= target_loops) {
-        current_mode = 0; // 停止联动
-        sm_state = SM_IDLE;
-        // 可选：在这里调用 AT_SendResponse 发送 "+LINK:DONE"
-        return 0; 
+static void Link_StopMotors(uint32_t motors) {
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) {
+        if (motors & (1u << i)) App_Motor_Stop(i);
     }
-    
-    // 未达到，重置状态继续
-    return 1;
 }
 
-// ============================================================
-// 下面是具体的联动逻辑实现区域
-// ============================================================
+// 取消登记的唤醒条件
+static void Link_Disarm(uint8_t inst) {
+    link_inst[inst].ready = 0;
+    link_inst[inst].wait_evt = 0;
+    EventBus_StopTimer(inst);
+    App_Adc_Unwatch(inst);
+}
 
-// 模式1: 简单的往复运动
-static void Logic_Mode_1(void) {
-    switch (sm_state) {
-        case SM_INIT:
-            // 可以在这里做一些复位操作
-            sm_state = SM_STEP_1;
-            break;
+// 实例阻塞: 按等待条件登记唤醒源后休眠
+static void Link_Block(uint8_t inst) {
+    LinkInst_t *li = &link_inst[inst];
+    LinkVmBlockInfo_t b;
 
-        case SM_STEP_1:
-            // 动作：电机1 正转 2秒
-            if (!App_Motor_IsBusy(0)) {
-                App_Motor_MoveTime(0, 0, 800, 2000);
-                sm_state = SM_STEP_2;
-            }
+    Link_Disarm(inst);
+    App_LinkVm_GetBlock(&li->vm, &b);
+    switch (b.kind) {
+        case LVM_BLOCK_MOTOR:
+            li->wait_evt = EVT_BIT(EVT_MOTOR_DONE);
             break;
-            
-        case SM_STEP_2:
-            // 等待动作完成
-            if (!App_Motor_IsBusy(0)) {
-                sm_timer = HAL_GetTick(); // 停顿计时开始
-                sm_state = SM_STEP_3;
-            }
+        case LVM_BLOCK_TIME:
+            li->wait_evt = EVT_BIT(EVT_TIMER);
+            EventBus_StartTimer(inst, b.remain_ms);
             break;
-            
-        case SM_STEP_3:
-            // 停顿 500ms 后反转
-            if (HAL_GetTick() - sm_timer > 500) {
-                App_Motor_MoveTime(0, 1, 800, 2000); // 反转 2秒
-                sm_state = SM_WAIT_FINISH;
-            }
-            break;
-
-        case SM_WAIT_FINISH:
-            // 等待最后一步完成
-            if (!App_Motor_IsBusy(0)) {
-                // === 一轮结束，检查循环 ===
-                if (Check_Loop_Finish()) {
-                    sm_state = SM_STEP_1; // 回到第一步，开始���一轮
-                }
-            }
+        case LVM_BLOCK_ADC:
+            if (b.never) break; // 永远等不到, 休眠直到被停止
+            li->wait_evt = EVT_BIT(EVT_ADC);
+            App_Adc_Watch(inst, b.motor, b.level, b.above);
             break;
-            
         default:
-            sm_state = SM_IDLE;
+            li->ready = 1;
             break;
     }
 }
 
+// 实例结束: 释放电机占用, 保留解释器状态供查询
+static void Link_Finish(uint8_t inst) {
+    Link_Disarm(inst);
+    link_inst[inst].mode = LINK_MODE_IDLE;
+    link_inst[inst].motors = 0;
+}
 
-// 模式2: 另一种逻辑 (例如基于位置)
-static void Logic_Mode_2(void) {
-    switch (sm_state) {
-        case SM_INIT:
-            sm_state = SM_STEP_1;
-            break;
+void App_Linkage_Stop(uint8_t inst) {
+    if (inst >= LINK_INSTANCES) return;
+    LinkInst_t *li = &link_inst[inst];
+    if (li->mode != LINK_MODE_IDLE) LOG_DEBUG("Linkage %d mode %d stop\r\n", inst, li->mode);
+    Link_StopMotors(li->motors);
+    App_LinkVm_Stop(&li->vm);
+    Link_Finish(inst);
+}
 
-        case SM_STEP_1:
-            // 动作：电机1 跑 5000 脉冲
-            if (!App_Motor_IsBusy(0)) {
-                App_Motor_MovePos(0, 0, 600, 5000);
-                sm_state = SM_WAIT_FINISH;
-            }
-            break;
-            
-        case SM_WAIT_FINISH:
-            if (!App_Motor_IsBusy(0)) {
-                // === 一轮结束 ===
-                if (Check_Loop_Finish()) {
-                    // 模式2可能只需要单向跑，下一轮继续跑
-                    sm_state = SM_STEP_1; 
-                }
-            }
-            break;
-            
-        default:
-            sm_state = SM_IDLE;
-            break;
+LinkResult_t App_Linkage_Run(uint8_t inst, uint8_t mode_id, uint32_t loop_count) {
+    if (inst >= LINK_INSTANCES) return LINK_ERR_INST;
+    LinkInst_t *li = &link_inst[inst];
+
+    // 换程序: 先停本实例
+    App_Linkage_Stop(inst);
+    if (mode_id == LINK_MODE_IDLE) return LINK_OK;
+
+    LinkProgram_t prog = { NULL, 0 };
+    Link_Lookup(mode_id, &prog); // 未找到时 code = NULL, 装入报 LVM_ERR_EMPTY
+    if (!App_LinkVm_Start(&li->vm, prog.code, prog.len, loop_count)) {
+        LOG_WARN("Linkage %d mode %d not runnable, err=%d pc=%u\r\n", inst, mode_id, li->vm.err, li->vm.pc);
+        return LINK_ERR_MODE; // 未知模式 / 空槽 / 程序校验失败
     }
-}
-   
-/**
- * @brief 逻辑3: 多段速定位 (位置控制)
- * 流程: M1慢速走到1000脉冲 -> 快速走到5000脉冲 -> 回到0
- */
-static void Logic_Mode_3(void) {
-    switch (sm_state) {
-		
-		case SM_INIT:
-            sm_state = SM_STEP_1;
-            break;
-		
-        case SM_STEP_1: // 第一段: 慢速
-            // ID=0, Dir=CW, Speed=300, Target=1000 pulses
-            App_Motor_MovePos(0, 0, 200, 1000);
-            sm_state = SM_STEP_2;
-            break;
-            
-        case SM_STEP_2: // 等待
-            if (!App_Motor_IsBusy(0)) sm_state = SM_STEP_3;
-            break;
-            
-        case SM_STEP_3: // 第二段: 快速追击
-            // ID=0, Dir=CW, Speed=800, Target=4000 pulses (累加)
-            App_Motor_MovePos(0, 0, 800, 4000);
-            sm_state = SM_STEP_4;
-            break;
-            
-        case SM_STEP_4: // 等待
-            if (!App_Motor_IsBusy(0)) {
-                sm_timer = HAL_GetTick();
-                sm_state = SM_STEP_5;
-            }
-            break;
-            
-        case SM_STEP_5: // 停顿500ms后回零
-            if (HAL_GetTick() - sm_timer > 1000) {
-                // ID=0, Dir=CCW, Speed=1000, Target=5000 pulses (假设回原点)
-                App_Motor_MovePos(0, 1, 1000, 5000);
-                sm_state = SM_WAIT_FINISH;
-            }
-            break;
-            
-        case SM_WAIT_FINISH:
-            // 等待最后一步完成
-            if (!App_Motor_IsBusy(0)) {
-                // === 一轮结束，检查循环 ===
-                if (Check_Loop_Finish()) {
-                    sm_state = SM_STEP_1; // 回到第一步，开始���一轮
-                }
-            }
-            break;
-            
-        default:
-            sm_state = SM_IDLE;
-            break;
+
+    // 电机占用检查 (程序已通过校验)
+    uint32_t motors = App_LinkVm_Motors(prog.code, prog.len);
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        if (i != inst && link_inst[i].mode != LINK_MODE_IDLE && (link_inst[i].motors & motors)) {
+            LOG_WARN("Linkage %d mode %d: motors 0x%lx owned by linkage %d\r\n", inst, mode_id,
+                     link_inst[i].motors & motors, i);
+            App_LinkVm_Stop(&li->vm);
+            return LINK_ERR_BUSY;
+        }
     }
+
+    li->mode = mode_id;
+    li->last_mode = mode_id;
+    li->motors = motors;
+    li->ready = 1; // 立即执行第一条指令
+    li->wakeups = 0;
+    LOG_DEBUG("Linkage %d mode %d start, loops=%lu motors=0x%lx\r\n", inst, mode_id, loop_count, motors);
+    return LINK_OK;
 }
 
+void App_Linkage_SetMode(uint8_t mode_id, uint32_t loop_count) {
+    if (mode_id == LINK_MODE_IDLE) {
+        // 紧急停止所有
+        for (uint8_t i = 0; i < LINK_INSTANCES; i++) App_Linkage_Stop(i);
+        for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Stop(i);
+        return;
+    }
+    App_Linkage_Run(0, mode_id, loop_count);
+}
 
-/**
- * @brief 逻辑4: 带限位保护的多电机顺序动作
- * 场景: M1 正转 -> 触限位/到位 -> M2 正转 -> 触限位/到位 -> 停顿 -> M2 反转 -> M1 反转
- */
-static void Logic_Mode_4(void) {
-    switch (sm_state) {
-        
-        case SM_INIT:
-            sm_state = SM_STEP_1;
-            break;
-        
-        case SM_STEP_1: // 第1步: 电机1 正转 (带限位保护)
-            // ID=0, CW, Speed=500, Max=5000 pulses
-            // 只要碰到配置好的限位开关1，或者跑满了5000脉冲，电机就会停
-            App_Motor_MovePosWithLimit(0, 0, 500, 5000);
-            sm_state = SM_STEP_2;
-            break;
-            
-        case SM_STEP_2: // 等待 M1 停止
-            if (!App_Motor_IsBusy(0)) {
-                sm_state = SM_STEP_3;
-            }
-            break;
-            
-        case SM_STEP_3: // 第2步: 电机2 正转 (带限位保护)
-            // 假设我们有第二个电机 (ID=1)。如果是单电机测试，这里可以复用 ID=0 模拟效果
-            // App_Motor_MovePosWithLimit(1, 0, 500, 4000);
-            
-            // 为了演示，这里继续用 ID=0 模拟第二个动作，您可以改成 ID=1
-            App_Motor_MovePosWithLimit(0, 0, 600, 4000); 
-            sm_state = SM_STEP_4;
-            break;
-            
-        case SM_STEP_4: // 等待 M2 停止 & 开始计时
-            if (!App_Motor_IsBusy(0)) { // 检查对应电机是否停止
-                sm_timer = HAL_GetTick();
-                sm_state = SM_STEP_5;
-            }
-            break;
-            
-        case SM_STEP_5: // 第3步: 停顿 1秒
-            if (HAL_GetTick() - sm_timer > 1000) {
-                sm_state = SM_STEP_6;
-            }
-            break;
-            
-        case SM_STEP_6: // 第4步: 电机2 反转退回 (找反向限位)
-            // ID=0(模拟M2), CCW, Speed=500, 回退足够远的距离以确保碰到开关
-            App_Motor_MovePosWithLimit(0, 1, 500, 10000); 
-            sm_state = SM_STEP_7;
-            break;
-            
-        case SM_STEP_7: // 等待 M2 退回完成
-            if (!App_Motor_IsBusy(0)) {
-                sm_state = SM_WAIT_FINISH; // 这里暂时只演示到这里，可以继续添加 M1 退回逻辑
-            }
-            break;
-            
-        // ... 可以继续添加 STEP_8 (M1 反转) ...
-
-        case SM_WAIT_FINISH:
-            if (!App_Motor_IsBusy(0)) { // 检查所有相关电机
-                if (Check_Loop_Finish()) {
-                    sm_state = SM_STEP_1;
-                }
-            }
-            break;
-            
-        default:
-            sm_state = SM_IDLE;
-            break;
+void App_Linkage_ReleaseMotor(uint8_t id) {
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        if (link_inst[i].mode != LINK_MODE_IDLE && (link_inst[i].motors & (1u << id))) App_Linkage_Stop(i);
     }
 }
 
-/**
- * @brief 逻辑5: 基于ADC绝对位置的多电机联动 (Mode 5)
- * 流程: M1去位置A -> 到位 -> M1(或M2)去位置B -> 停顿 -> 回到起点
- */
-static void Logic_Mode_5(void) {
-    switch (sm_state) {
-        
-        case SM_INIT:
-            sm_state = SM_STEP_1;
-            break;
-            
-        case SM_STEP_1: // 第1步: 电机1 移动到 ADC=1000
-            // ID=0, Speed=800, Target=1000, Tolerance=10, Range=200
-            App_Motor_MoveAdcPosWithLimit(0, 800, 1000, 10, 200);
-            sm_state = SM_STEP_2;
-            break;
-            
-        case SM_STEP_2: // 等待 M1 到位
-            if (!App_Motor_IsBusy(0)) {
-                // 如果是多电机，这里可以启动电机2
-                sm_state = SM_STEP_3;
-            }
-            break;
-            
-        case SM_STEP_3: // 第2步: 模拟电机2 (这里仍用ID0演示) 移动到 ADC=3000
-             // App_Motor_MoveAdcPosWithLimit(1, ...);
-            App_Motor_MoveAdcPosWithLimit(0, 600, 3000, 10, 200);
-            sm_state = SM_STEP_4;
-            break;
+void App_Linkage_StopMode(uint8_t mode_id) {
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        if (link_inst[i].mode == mode_id) App_Linkage_Stop(i);
+    }
+}
 
-        case SM_STEP_4: // 等待 M2 到位 & 启动计时
-            if (!App_Motor_IsBusy(0)) {
-                sm_timer = HAL_GetTick();
-                sm_state = SM_STEP_5;
+// 统一的调度器: 被唤醒的实例连续执行到再次阻塞 (最多 LINK_STEP_BURST 条), 起点轮转
+void App_Linkage_Process(void) {
+    for (uint8_t k = 0; k < LINK_INSTANCES; k++) {
+        uint8_t inst = (uint8_t)((link_rr + k) % LINK_INSTANCES);
+        LinkInst_t *li = &link_inst[inst];
+        if (li->mode == LINK_MODE_IDLE || !li->ready) continue;
+
+        for (uint8_t n = 0; n < LINK_STEP_BURST; n++) {
+            uint8_t state = App_LinkVm_Step(&li->vm);
+            if (state == LVM_STATE_ERROR) {
+                // 程序在运行中损坏: 刹停占用的电机 (可能停在手动运动中)
+                LOG_ERROR("Linkage %d mode %d aborted, err=%d pc=%u\r\n", inst, li->mode, li->vm.err, li->vm.pc);
+                Link_StopMotors(li->motors);
+                Link_Finish(inst);
+                break;
             }
-            break;
-            
-        case SM_STEP_5: // 第3步: 停顿 2秒
-            if (HAL_GetTick() - sm_timer > 2000) {
-                sm_state = SM_STEP_6;
+            if (state != LVM_STATE_RUN) {
+                // 完成目标轮数 / 执行到 END
+                LOG_DEBUG("Linkage %d mode %d done, loops=%lu\r\n", inst, li->mode, li->vm.loops_done);
+                Link_Finish(inst);
+                break;
             }
-            break;
-            
-        case SM_STEP_6: // 第4步: 返回起点 (ADC=1000)
-             // 假设同时或者顺序回 
-            App_Motor_MoveAdcPosWithLimit(0, 800, 1000, 10, 200);
-            sm_state = SM_WAIT_FINISH;
-            break;
-            
-        case SM_WAIT_FINISH:
-            // 检查完成情况
-            if (!App_Motor_IsBusy(0)) {
-                if (Check_Loop_Finish()) {
-                    sm_state = SM_STEP_1; // 继续下一轮
-                }
+            if (li->vm.blocked != LVM_BLOCK_NONE) {
+                Link_Block(inst);
+                break;
             }
-            break;
-            
-        default:
-            sm_state = SM_IDLE;
-            break;
+        }
     }
+    link_rr = (uint8_t)((link_rr + 1u) % LINK_INSTANCES);
 }
 
-/**
- * @brief 逻辑6: 模拟开关往复运动 (ADC Position)
- * Logic:
- *  - Default: Start CW
- *  - If ADC >= 3.3V (High Threshold) -> Stop & Switch to CCW
- *  - If ADC <= 0V (Low Threshold) -> Stop & Switch to CW
- */
-static void Logic_Mode_6(void) {
-    uint16_t adc_val = App_Adc_GetPos(0); 
-    // Thresholds: 0-4095 scale. 
-    // 0V ~ 100
-    // 3.3V ~ 4000
-    const uint16_t THRESHOLD_LOW = 100;
-    const uint16_t THRESHOLD_HIGH = 4000;
-    const uint16_t SPEED = 1000; // Speed 800
-
-    switch (sm_state) {
-        case SM_INIT:
-            // 默认 CW
-            sm_state = SM_STEP_1; 
-            break;
-
-        case SM_STEP_1: // Action: CW
-            // Start moving CW indefinitely until stopped
-             if (!App_Motor_IsBusy(0)) {
-                // Manual Move continues until Stop is called
-                App_Motor_MoveManual(0, 0, SPEED); // 0=CW
-                sm_state = SM_STEP_2;
-            }
-            break;
+uint8_t App_Linkage_GetMode(void) {
+    return link_inst[0].mode;
+}
 
-        case SM_STEP_2: // Monitor CW
-            // Check High Limit (3.3V)
-            if (adc_val >= THRESHOLD_HIGH) {
-                App_Motor_Stop(0);
-                sm_timer = HAL_GetTick(); // Start delay
-                sm_state = SM_STEP_3;
-            }
-            break;
+uint8_t App_Linkage_GetStep(void) {
+    return (link_inst[0].vm.pc > 0xFF) ? 0xFF : (uint8_t)link_inst[0].vm.pc;
+}
 
-        case SM_STEP_3: // Wait Delay before CCW
-            if (HAL_GetTick() - sm_timer > 500) { 
-                sm_state = SM_STEP_4;
-            }
-            break;
-            
-        case SM_STEP_4: // Action: CCW
-             if (!App_Motor_IsBusy(0)) {
-                 App_Motor_MoveManual(0, 1, SPEED); // 1=CCW
-                 sm_state = SM_STEP_5;
-             }
-             break;
-
-        case SM_STEP_5: // Monitor CCW
-             // Check Low Limit (0V)
-             if (adc_val <= THRESHOLD_LOW) {
-                 App_Motor_Stop(0);
-                 sm_timer = HAL_GetTick();
-                 sm_state = SM_STEP_6;
-             }
-             break;
-
-        case SM_STEP_6: // Wait Delay before CW (Cycle complete)
-             if (HAL_GetTick() - sm_timer > 500) {
-                 // Check Loop Limit (1 cycle = CW + CCW)
-                 if (Check_Loop_Finish()) {
-                     sm_state = SM_STEP_1; // Loop back to CW
-                 }
-             }
-             break;
+uint8_t App_Linkage_Idle(void) {
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        if (link_inst[i].mode != LINK_MODE_IDLE) return 0;
+    }
+    return 1;
+}
 
-        default:
-            sm_state = SM_IDLE;
-            break;
+uint8_t App_Linkage_Ready(void) {
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        if (link_inst[i].mode != LINK_MODE_IDLE && link_inst[i].ready) return 1;
     }
+    return 0;
 }
 
+void App_Linkage_GetStat(uint8_t inst, LinkInstStat_t *st) {
+    memset(st, 0, sizeof(*st));
+    if (inst >= LINK_INSTANCES) return;
+    const LinkInst_t *li = &link_inst[inst];
+    st->mode = li->mode;
+    st->last_mode = li->last_mode;
+    st->state = li->vm.state;
+    st->err = li->vm.err;
+    st->pc = li->vm.pc;
+    st->motors = li->motors;
+    st->loops_done = li->vm.loops_done;
+    st->loops_target = li->vm.loops_target;
+    st->steps = li->vm.steps;
+    st->blocked = (li->mode != LINK_MODE_IDLE) ? li->vm.blocked : LVM_BLOCK_NONE;
+    st->wakeups = li->wakeups;
+}
+
+void App_Linkage_GetResume(uint8_t inst, LinkageResume_t *r) {
+    if (!r || inst >= LINK_INSTANCES) return;
+    const LinkInst_t *li = &link_inst[inst];
+    r->mode = li->mode;
+    r->reserved = 0;
+    r->pc = li->vm.pc;
+    r->loops_done = li->vm.loops_done;
+    r->loops_target = li->vm.loops_target;
+    for (uint8_t i = 0; i < LINKVM_REGS; i++) r->reg[i] = li->vm.reg[i];
+}
 
+void App_Linkage_Resume(uint8_t inst, const LinkageResume_t *r) {
+    if (inst >= LINK_INSTANCES) return;
+    if (!r || r->mode == LINK_MODE_IDLE) {
+        App_Linkage_Stop(inst);
+        return;
+    }
+    LinkInst_t *li = &link_inst[inst];
+    // 指令等待的运动已由电机续跑, 停顿计时从头开始
+    if (App_Linkage_Run(inst, r->mode, r->loops_target) != LINK_OK || !App_LinkVm_Seek(&li->vm, r->pc)) {
+        App_Linkage_Stop(inst);
+        return;
+    }
+    li->vm.loops_done = r->loops_done;
+    for (uint8_t i = 0; i < LINKVM_REGS; i++) li->vm.reg[i] = r->reg[i];
+    LOG_INFO("Linkage %d resumed: mode=%d pc=%u loop=%lu/%lu\r\n", inst, r->mode, r->pc, r->loops_done, r->loops_target);
+}
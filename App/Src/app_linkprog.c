@@ -0,0 +1,183 @@
+#include "app_linkprog.h"
+#include "app_linkage.h"
+#include "app_linkvm.h"
+#include "bsp_crc.h"
+#include "flash_job.h"
+#define LOG_MODULE LOG_MOD_LINK
+#include "log.h"
+#include <string.h>
+
+#define LINKPROG_JOB_CHAIN  2           // 槽写入作业链 (擦除 + 字节码 + 头部)
+#define LINKPROG_CODE(addr) ((const uint8_t *)(addr) + sizeof(LinkProgHeader_t))
+
+_Static_assert(sizeof(LinkProgHeader_t) % 4 == 0, "program header must be word aligned");
+
+static const uint32_t prog_slot_addr[LINKPROG_SLOTS] = { FLASH_PROG_SLOT0_ADDR, FLASH_PROG_SLOT1_ADDR };
+
+// 上传暂存区: 与槽内布局相同, END 校验通过后整体写入
+static union {
+    LinkProgHeader_t hdr;
+    uint8_t raw[FLASH_PAGE_SIZE];
+} up_page;
+static LinkProgUpload_t up;
+static uint8_t prog_erasing[LINKPROG_SLOTS]; // 删除的擦除作业已排队, 擦完前不可运行
+
+static const LinkProgHeader_t *Prog_Header(uint8_t slot) {
+    return (const LinkProgHeader_t *)prog_slot_addr[slot];
+}
+
+// 头部合法且 CRC 正确
+static uint8_t Prog_Valid(uint8_t slot) {
+    const LinkProgHeader_t *h = Prog_Header(slot);
+    if (h->magic != LINKPROG_MAGIC || h->len == 0 || h->len > LINKPROG_MAX_LEN) return 0;
+    return BSP_Crc_Calc(LINKPROG_CODE(h), h->len) == h->crc;
+}
+
+static uint8_t Prog_Busy(uint8_t slot) {
+    return prog_erasing[slot] || (up.state == LINKPROG_UP_WRITING && up.slot == slot);
+}
+
+// 槽即将被擦除: 正在运行该槽程序的联动先停止 (程序直接从 Flash 执行)
+static void Prog_Release(uint8_t slot) {
+    App_Linkage_StopMode(LINK_MODE_SLOT(slot));
+}
+
+void App_LinkProg_Init(void) {
+    memset(&up, 0, sizeof(up));
+    for (uint8_t i = 0; i < LINKPROG_SLOTS; i++) {
+        LinkProgInfo_t info;
+        App_LinkProg_GetInfo(i, &info);
+        if (info.valid) LOG_INFO("Linkage slot %d: len=%u crc=%08lx\r\n", i, info.len, info.crc); // 名称在 RAM 副本中, 延迟日志无法还原, 用 AT+PROG 查看
+    }
+}
+
+LinkProgResult_t App_LinkProg_Begin(uint8_t slot, uint16_t len, const char *name) {
+    if (up.state == LINKPROG_UP_WRITING) return LINKPROG_ERR_STATE;
+    if (slot >= LINKPROG_SLOTS || len == 0 || len > LINKPROG_MAX_LEN) return LINKPROG_ERR_ARG;
+    if (name && strlen(name) > LINKPROG_NAME_LEN) return LINKPROG_ERR_ARG;
+
+    memset(&up_page, 0xFF, sizeof(up_page));
+    memset(up_page.hdr.name, 0, sizeof(up_page.hdr.name));
+    if (name) memcpy(up_page.hdr.name, name, strlen(name));
+    up_page.hdr.magic = LINKPROG_MAGIC;
+    up_page.hdr.len = len;
+    up_page.hdr.reserved = 0;
+
+    up.state = LINKPROG_UP_RECEIVING;
+    up.slot = slot;
+    up.len = len;
+    up.received = 0;
+    return LINKPROG_OK;
+}
+
+LinkProgResult_t App_LinkProg_Write(uint16_t off, const uint8_t *data, uint16_t n) {
+    if (up.state != LINKPROG_UP_RECEIVING) return LINKPROG_ERR_STATE;
+    if (off != up.received) return LINKPROG_ERR_OFFSET; // 只接受顺序写入, 重发的块同样拒绝
+    if (n == 0 || (uint32_t)off + n > up.len) return LINKPROG_ERR_ARG;
+    memcpy(&up_page.raw[sizeof(LinkProgHeader_t) + off], data, n);
+    up.received = (uint16_t)(up.received + n);
+    return LINKPROG_OK;
+}
+
+static void Prog_OnWritten(void *ctx, uint8_t ok) {
+    (void)ctx;
+    up.state = LINKPROG_UP_IDLE;
+    if (ok && Prog_Valid(up.slot)) {
+        up.last_result = LINKPROG_OK;
+        up.uploads++;
+        LOG_INFO("Linkage slot %d written, len=%u\r\n", up.slot, up.len);
+    } else {
+        up.last_result = LINKPROG_ERR_FLASH;
+        LOG_ERROR("Linkage slot %d write failed\r\n", up.slot);
+    }
+}
+
+static LinkProgResult_t Prog_Finish(LinkProgResult_t res) {
+    up.last_result = res;
+    if (res != LINKPROG_OK) up.state = LINKPROG_UP_IDLE;
+    return res;
+}
+
+LinkProgResult_t App_LinkProg_End(uint32_t crc) {
+    const uint8_t *code = &up_page.raw[sizeof(LinkProgHeader_t)];
+
+    if (up.state != LINKPROG_UP_RECEIVING) return LINKPROG_ERR_STATE;
+    if (up.received != up.len) return Prog_Finish(LINKPROG_ERR_LENGTH);
+    if (BSP_Crc_Calc(code, up.len) != crc) return Prog_Finish(LINKPROG_ERR_CRC);
+    up.vm_err = App_LinkVm_Verify(code, up.len, &up.vm_err_pc);
+    if (up.vm_err != LVM_ERR_NONE) return Prog_Finish(LINKPROG_ERR_VERIFY);
+    if (FlashJob_Free() < 3) return Prog_Finish(LINKPROG_ERR_FLASH);
+
+    up_page.hdr.crc = crc;
+    Prog_Release(up.slot);
+
+    // 先写字节码, 最后写头部: 中途掉电时头部不完整, 槽视为无效
+    uint32_t addr = prog_slot_addr[up.slot];
+    FlashJob_t erase = { .op = FLASH_JOB_ERASE, .chain = LINKPROG_JOB_CHAIN, .addr = addr };
+    FlashJob_t body = { .op = FLASH_JOB_PROGRAM, .chain = LINKPROG_JOB_CHAIN, .addr = addr + sizeof(LinkProgHeader_t),
+                        .len = (uint16_t)((up.len + 1u) & ~1u), .src = code };
+    FlashJob_t head = { .op = FLASH_JOB_PROGRAM, .chain = LINKPROG_JOB_CHAIN, .addr = addr,
+                        .len = sizeof(LinkProgHeader_t), .src = &up_page.hdr, .cb = Prog_OnWritten };
+    FlashJob_Submit(&erase);
+    FlashJob_Submit(&body);
+    FlashJob_Submit(&head);
+    up.state = LINKPROG_UP_WRITING;
+    return Prog_Finish(LINKPROG_OK);
+}
+
+void App_LinkProg_Abort(void) {
+    if (up.state == LINKPROG_UP_RECEIVING) up.state = LINKPROG_UP_IDLE;
+}
+
+static void Prog_OnDeleted(void *ctx, uint8_t ok) {
+    uint8_t *erasing = (uint8_t *)ctx;
+    *erasing = 0;
+    if (!ok) LOG_ERROR("Linkage slot %d erase failed\r\n", (int)(erasing - prog_erasing));
+}
+
+LinkProgResult_t App_LinkProg_Delete(uint8_t slot) {
+    if (slot >= LINKPROG_SLOTS) return LINKPROG_ERR_ARG;
+    if (up.state != LINKPROG_UP_IDLE && up.slot == slot) return LINKPROG_ERR_STATE;
+    if (prog_erasing[slot] || Prog_Header(slot)->magic == 0xFFFFFFFFu) return LINKPROG_OK; // 已是空槽 / 正在擦除
+
+    // 擦除可能因运动推迟数秒: 提交即标记为忙, 期间 RUN 与 BOOTMODE 都拒绝该槽
+    FlashJob_t job = { .op = FLASH_JOB_ERASE, .addr = prog_slot_addr[slot], .cb = Prog_OnDeleted,
+                       .ctx = &prog_erasing[slot] };
+    if (!FlashJob_Submit(&job)) return LINKPROG_ERR_FLASH;
+    prog_erasing[slot] = 1;
+    Prog_Release(slot);
+    return LINKPROG_OK;
+}
+
+uint8_t App_LinkProg_Get(uint8_t slot, const uint8_t **code, uint16_t *len) {
+    if (slot >= LINKPROG_SLOTS || Prog_Busy(slot) || !Prog_Valid(slot)) return 0;
+    *code = LINKPROG_CODE(Prog_Header(slot));
+    *len = Prog_Header(slot)->len;
+    return 1;
+}
+
+void App_LinkProg_GetInfo(uint8_t slot, LinkProgInfo_t *info) {
+    memset(info, 0, sizeof(*info));
+    if (slot >= LINKPROG_SLOTS || Prog_Busy(slot)) return;
+    const LinkProgHeader_t *h = Prog_Header(slot);
+    if (h->magic != LINKPROG_MAGIC) return;
+    info->valid = Prog_Valid(slot);
+    info->len = h->len;
+    info->crc = h->crc;
+    memcpy(info->name, h->name, LINKPROG_NAME_LEN);
+}
+
+void App_LinkProg_GetUpload(LinkProgUpload_t *u) {
+    *u = up;
+}
+
+uint8_t App_LinkProg_CheckSlots(uint8_t *used) {
+    uint8_t n = 0, bad = 0;
+    for (uint8_t i = 0; i < LINKPROG_SLOTS; i++) {
+        if (Prog_Busy(i) || Prog_Header(i)->magic == 0xFFFFFFFFu) continue;
+        n++;
+        if (!Prog_Valid(i)) bad++;
+    }
+    if (used) *used = n;
+    return bad;
+}
@@ -0,0 +1,306 @@
+#include "app_linkvm.h"
+#include "app_motor.h"
+#include "app_adc.h"
+#include "bsp_bldc.h"
+#include "bsp_conf.h"
+#include <string.h>
+
+#define LINKVM_MAX_LEN      1024 // 校验时指令边界位图的容量
+
+typedef struct {
+    GPIO_TypeDef *port;
+    uint16_t pin;
+} LinkOut_t;
+
+static const LinkOut_t link_outs[] = LINK_OUT_TABLE;
+#define LINK_OUT_COUNT (sizeof(link_outs) / sizeof(link_outs[0]))
+
+// 指令长度 (含操作码), 0 = 未知操作码
+uint8_t App_LinkVm_OpLen(uint8_t op) {
+    switch (op) {
+        case LVM_END:          return 1;
+        case LVM_NOP:          return 1;
+        case LVM_MOVE_TIME:    return 9;
+        case LVM_MOVE_POS:     return 9;
+        case LVM_MOVE_POS_LIM: return 9;
+        case LVM_MOVE_ADC:     return 10;
+        case LVM_MOVE_MAN:     return 5;
+        case LVM_STOP:         return 2;
+        case LVM_WAIT_IDLE:    return 2;
+        case LVM_DELAY:        return 5;
+        case LVM_WAIT_ADC:     return 5;
+        case LVM_JMP:          return 3;
+        case LVM_BR_ADC:       return 7;
+        case LVM_LOOP:         return 3;
+        case LVM_SET_REG:      return 4;
+        case LVM_DJNZ:         return 4;
+        case LVM_SET_OUT:      return 3;
+        default:               return 0;
+    }
+}
+
+static inline uint16_t Vm_U16(const uint8_t *p) {
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t Vm_U32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint8_t Vm_MotorOk(uint8_t m, uint8_t allow_all) {
+    return m < MAX_MOTORS || (allow_all && m == LINKVM_ALL_MOTORS);
+}
+
+// 跳转目标的偏移 (非跳转指令返回 0xFFFF)
+static uint16_t Vm_JumpTarget(const uint8_t *p) {
+    switch (p[0]) {
+        case LVM_JMP:    return Vm_U16(p + 1);
+        case LVM_BR_ADC: return Vm_U16(p + 5);
+        case LVM_LOOP:   return Vm_U16(p + 1);
+        case LVM_DJNZ:   return Vm_U16(p + 2);
+        default:         return 0xFFFF;
+    }
+}
+
+static uint8_t Vm_CheckArgs(const uint8_t *p) {
+    switch (p[0]) {
+        case LVM_MOVE_TIME:
+        case LVM_MOVE_POS:
+        case LVM_MOVE_POS_LIM:
+        case LVM_MOVE_MAN:    return Vm_MotorOk(p[1], 0) && p[2] <= MOTOR_DIR_CCW;
+        case LVM_MOVE_ADC:    return Vm_MotorOk(p[1], 0);
+        case LVM_STOP:
+        case LVM_WAIT_IDLE:   return Vm_MotorOk(p[1], 1);
+        case LVM_WAIT_ADC:
+        case LVM_BR_ADC:      return Vm_MotorOk(p[1], 0) && p[2] <= LVM_COND_GT;
+        case LVM_SET_REG:
+        case LVM_DJNZ:        return p[1] < LINKVM_REGS;
+        case LVM_SET_OUT:     return p[1] < LINK_OUT_COUNT && p[2] <= 1;
+        default:              return 1;
+    }
+}
+
+uint8_t App_LinkVm_Verify(const uint8_t *code, uint16_t len, uint16_t *err_pc) {
+    uint8_t starts[LINKVM_MAX_LEN / 8];
+    uint16_t pc;
+
+    if (err_pc) *err_pc = 0;
+    if (!code || len == 0) return LVM_ERR_EMPTY;
+    if (len > LINKVM_MAX_LEN) return LVM_ERR_TRUNCATED;
+
+    // 第一遍: 标记指令边界, 检查操作码与长度
+    memset(starts, 0, sizeof(starts));
+    for (pc = 0; pc < len; ) {
+        uint8_t n = App_LinkVm_OpLen(code[pc]);
+        if (err_pc) *err_pc = pc;
+        if (n == 0) return LVM_ERR_OPCODE;
+        if ((uint32_t)pc + n > len) return LVM_ERR_TRUNCATED;
+        starts[pc >> 3] |= (uint8_t)(1u << (pc & 7u));
+        pc += n;
+    }
+    // 第二遍: 操作数范围与跳转目标
+    for (pc = 0; pc < len; pc += App_LinkVm_OpLen(code[pc])) {
+        const uint8_t *p = code + pc;
+        uint16_t to = Vm_JumpTarget(p);
+        if (err_pc) *err_pc = pc;
+        if (!Vm_CheckArgs(p)) return LVM_ERR_ARG;
+        if (to != 0xFFFF && (to >= len || !(starts[to >> 3] & (1u << (to & 7u))))) return LVM_ERR_JUMP;
+    }
+    return LVM_ERR_NONE;
+}
+
+uint32_t App_LinkVm_Motors(const uint8_t *code, uint16_t len) {
+    uint32_t mask = 0;
+    for (uint16_t pc = 0; pc < len; pc += App_LinkVm_OpLen(code[pc])) {
+        switch (code[pc]) {
+            case LVM_MOVE_TIME:
+            case LVM_MOVE_POS:
+            case LVM_MOVE_POS_LIM:
+            case LVM_MOVE_ADC:
+            case LVM_MOVE_MAN:
+            case LVM_STOP:
+                mask |= (code[pc + 1] == LINKVM_ALL_MOTORS) ? ((1u << MAX_MOTORS) - 1u) : (1u << code[pc + 1]);
+                break;
+            default:
+                break;
+        }
+    }
+    return mask;
+}
+
+uint8_t App_LinkVm_Start(LinkVm_t *vm, const uint8_t *code, uint16_t len, uint32_t loops) {
+    memset(vm, 0, sizeof(*vm));
+    vm->code = code;
+    vm->len = len;
+    vm->loops_target = loops;
+    vm->err = App_LinkVm_Verify(code, len, &vm->pc);
+    if (vm->err != LVM_ERR_NONE) {
+        vm->state = LVM_STATE_ERROR;
+        return 0;
+    }
+    vm->pc = 0;
+    vm->state = LVM_STATE_RUN;
+    return 1;
+}
+
+void App_LinkVm_Stop(LinkVm_t *vm) {
+    vm->state = LVM_STATE_IDLE;
+    vm->waiting = 0;
+}
+
+uint8_t App_LinkVm_Seek(LinkVm_t *vm, uint16_t pc) {
+    if (vm->state != LVM_STATE_RUN) return 0;
+    uint16_t at = 0;
+    while (at < pc && at < vm->len) at += App_LinkVm_OpLen(vm->code[at]);
+    if (at != pc) return 0;
+    vm->pc = pc;
+    vm->waiting = 0;
+    return 1;
+}
+
+static uint8_t Vm_Busy(uint8_t m) {
+    if (m != LINKVM_ALL_MOTORS) return App_Motor_IsBusy(m);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) {
+        if (App_Motor_IsBusy(i)) return 1;
+    }
+    return 0;
+}
+
+static uint8_t Vm_Cond(uint16_t a, uint8_t cond, uint16_t b) {
+    switch (cond) {
+        case LVM_COND_LT: return a < b;
+        case LVM_COND_GE: return a >= b;
+        case LVM_COND_LE: return a <= b;
+        default:          return a > b;
+    }
+}
+
+uint8_t App_LinkVm_Step(LinkVm_t *vm) {
+    vm->blocked = LVM_BLOCK_NONE;
+    if (vm->state != LVM_STATE_RUN) return vm->state;
+    if (vm->pc >= vm->len) {
+        vm->state = LVM_STATE_DONE; // 执行到程序末尾等同 END
+        return vm->state;
+    }
+
+    const uint8_t *p = vm->code + vm->pc;
+    uint16_t next = (uint16_t)(vm->pc + App_LinkVm_OpLen(p[0]));
+
+    switch (p[0]) {
+        case LVM_END:
+            vm->state = LVM_STATE_DONE;
+            return vm->state;
+        case LVM_MOVE_TIME:
+            App_Motor_MoveTime(p[1], p[2], Vm_U16(p + 3), Vm_U32(p + 5));
+            break;
+        case LVM_MOVE_POS:
+            App_Motor_MovePos(p[1], p[2], Vm_U16(p + 3), (int32_t)Vm_U32(p + 5));
+            break;
+        case LVM_MOVE_POS_LIM:
+            App_Motor_MovePosWithLimit(p[1], p[2], Vm_U16(p + 3), (int32_t)Vm_U32(p + 5));
+            break;
+        case LVM_MOVE_ADC:
+            App_Motor_MoveAdcPosWithLimit(p[1], Vm_U16(p + 2), Vm_U16(p + 4), Vm_U16(p + 6), Vm_U16(p + 8));
+            break;
+        case LVM_MOVE_MAN:
+            App_Motor_MoveManual(p[1], p[2], Vm_U16(p + 3));
+            break;
+        case LVM_STOP:
+            if (p[1] != LINKVM_ALL_MOTORS) {
+                App_Motor_Stop(p[1]);
+            } else {
+                for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Stop(i);
+            }
+            break;
+        case LVM_WAIT_IDLE:
+            if (Vm_Busy(p[1])) {
+                vm->blocked = LVM_BLOCK_MOTOR;
+                return vm->state;
+            }
+            break;
+        case LVM_DELAY:
+            // 首次执行开始计时, 超过 ms 后继续 (与原状态机 "> ms" 一致)
+            if (!vm->waiting) {
+                vm->waiting = 1;
+                vm->wait_start = HAL_GetTick();
+                vm->blocked = LVM_BLOCK_TIME;
+                return vm->state;
+            }
+            if (HAL_GetTick() - vm->wait_start <= Vm_U32(p + 1)) {
+                vm->blocked = LVM_BLOCK_TIME;
+                return vm->state;
+            }
+            vm->waiting = 0;
+            break;
+        case LVM_WAIT_ADC:
+            if (!Vm_Cond(App_Adc_GetPos(p[1]), p[2], Vm_U16(p + 3))) {
+                vm->blocked = LVM_BLOCK_ADC;
+                return vm->state;
+            }
+            break;
+        case LVM_JMP:
+            next = Vm_U16(p + 1);
+            break;
+        case LVM_BR_ADC:
+            if (Vm_Cond(App_Adc_GetPos(p[1]), p[2], Vm_U16(p + 3))) next = Vm_U16(p + 5);
+            break;
+        case LVM_LOOP:
+            vm->loops_done++;
+            if (vm->loops_target && vm->loops_done >= vm->loops_target) {
+                vm->pc = next;
+                vm->state = LVM_STATE_DONE;
+                return vm->state;
+            }
+            next = Vm_U16(p + 1);
+            break;
+        case LVM_SET_REG:
+            vm->reg[p[1]] = Vm_U16(p + 2);
+            break;
+        case LVM_DJNZ:
+            if (vm->reg[p[1]] && --vm->reg[p[1]]) next = Vm_U16(p + 2);
+            break;
+        case LVM_SET_OUT:
+            HAL_GPIO_WritePin(link_outs[p[1]].port, link_outs[p[1]].pin, p[2] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+            break;
+        case LVM_NOP:
+            break;
+        default:
+            // 装入时已校验, 运行中出现未知操作码说明程序所在 Flash 被改写 (如槽被擦除): 终止, 不原地空转
+            vm->err = LVM_ERR_OPCODE;
+            vm->state = LVM_STATE_ERROR;
+            return vm->state;
+    }
+    vm->pc = next;
+    vm->steps++;
+    return vm->state;
+}
+
+void App_LinkVm_GetBlock(const LinkVm_t *vm, LinkVmBlockInfo_t *b) {
+    memset(b, 0, sizeof(*b));
+    if (vm->state != LVM_STATE_RUN || vm->blocked == LVM_BLOCK_NONE) return;
+    const uint8_t *p = vm->code + vm->pc;
+    b->kind = vm->blocked;
+    switch (vm->blocked) {
+        case LVM_BLOCK_MOTOR:
+            b->motor = p[1];
+            break;
+        case LVM_BLOCK_TIME: {
+            // 条件为 "已过时间 > ms", 即再过 ms + 1 - elapsed 毫秒
+            uint32_t elapsed = HAL_GetTick() - vm->wait_start;
+            uint32_t ms = Vm_U32(p + 1);
+            b->remain_ms = (elapsed <= ms) ? (ms - elapsed + 1u) : 1u;
+            break;
+        }
+        case LVM_BLOCK_ADC: {
+            uint16_t v = Vm_U16(p + 3);
+            b->motor = p[1];
+            // 统一成 ">= level" 或 "< level"
+            b->above = (p[2] == LVM_COND_GE || p[2] == LVM_COND_GT);
+            b->level = (p[2] == LVM_COND_LE || p[2] == LVM_COND_GT) ? (uint16_t)(v + 1u) : v;
+            b->never = (p[2] == LVM_COND_GT && v == 0xFFFF) || (p[2] == LVM_COND_LT && v == 0);
+            break;
+        }
+        default:
+            break;
+    }
+}
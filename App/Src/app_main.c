@@ -1,28 +1,51 @@
 #include "app_main.h"
 #include "bsp_bldc.h"
+#include "bsp_time.h"
+#include "bsp_crc.h"
 
 #include "app_motor.h"
 #include "app_linkage.h"
+#include "app_linkprog.h"
 #include "app_adc.h"
 #include "app_storage.h"
+#include "app_power.h"
+#include "app_snapshot.h"
+#include "app_fault.h"
+#include "app_integrity.h"
+#include "app_param.h"
 
 #include "at_command.h"
+#include "app_lin.h"
+#include "app_telemetry.h"
+#include "flash_job.h"
+#include "event_bus.h"
 #include "log.h"
 #include "bsp_conf.h"
 
 // extern UART_HandleTypeDef huart1; // 移除
 
 void App_Init(void) {
+    BSP_Time_Init();    // 微秒时基, 日志与事件时间戳依赖它
+    BSP_Crc_Init();     // CRC 服务, 存储记录校验依赖它
     App_Storage_Init(); // 优先初始化存储，获取ID等配置
+    App_Fault_Init();   // 故障历史, 须在 ADC 保护 / 电机启动前就绪
+    App_Integrity_Init(); // 校验固件镜像、配置存储与联动程序槽, 失败记入故障历史
     BSP_BLDC_Init();
     App_Motor_Init();
     App_Adc_Init(); // 启动ADC采样
     AT_Init(&LOG_UART_HANDLE); // 使用宏
+    // 应用已保存的波特率 (无效值时保持 CubeMX 默认 115200)
+    if (AT_IsValidBaudRate(g_Config.baud_rate)) {
+        AT_ApplyBaudRate(g_Config.baud_rate);
+    }
 	Log_Init(&LOG_UART_HANDLE); // 使用宏
+    App_Telemetry_Init(&LOG_UART_HANDLE); // 遥测推送与 AT 共用串口
 
-        // 初始化联动模块并默认启动 Mode 6 (模拟往复)
+    // 初始化联动模块并启动默认联动 (参数 BOOTMODE, 出厂为 Mode 6 模拟往复)
+    // 有掉电快照且参数 RESUME = 1 时改为续跑掉电前的运动与联动
+    App_LinkProg_Init(); // 上传的联动程序槽 (BOOTMODE 可指向槽)
     App_Linkage_Init(); 
-    App_Linkage_SetMode(6, 0); 
+    if (!App_Snapshot_Init()) App_Linkage_StartDefault(); 
 
 
 }
@@ -33,6 +56,20 @@ void App_Loop(void) {
     
     // 2. 业务逻辑
     // App_Adc_Process(); // 已移至 DMA 中断中回调
+    EventBus_Process(); // 派发中断与上一轮产生的事件 (唤醒等待中的联动)
+    App_LIN_Process();  // 执行中断中收到的 LIN 指令 (先于电机状态机)
     App_Motor_Process();
-    App_Linkage_Process();
+    if (!App_Snapshot_Holding()) App_Linkage_Process(); // 掉电预警后暂停, 电压回升后续跑
+    App_Snapshot_Process();
+    App_Fault_Process(); // 写入故障记录 (经 Flash 作业队列)
+    App_Storage_Process(); // 续写存储忙时推迟的配置 / 参数
+    App_Param_Process();
+    FlashJob_Process();  // 后台 Flash 写入/擦除, 每次只执行一小段
+    App_Power_Process(); // 满足休眠条件时在此进入 Stop 模式, 唤醒后返回
+
+    // 3. 延迟日志输出 (文本模式下为空操作)
+    Log_Process();
+
+    // 4. 无事可做时 WFI, 等待下一个中断
+    App_Power_Idle();
 }
@@ -1,12 +1,28 @@
 #include "app_motor.h"
 #include "bsp_bldc.h"
 #include "app_adc.h"
+#include "bsp_time.h"
+#include "bsp_conf.h"
+#include "app_param.h"
+#include "flash_job.h"
+#include "app_fault.h"
+#include "event_bus.h"
+#define LOG_MODULE LOG_MOD_MOTOR
+#include "log.h"
 #include <stdlib.h> // for abs if needed
+#include <string.h>
+
+#if MAX_MOTORS > BSP_TIME_ALARM_LIN
+#error "MAX_MOTORS exceeds available TIM3 alarm channels"
+#endif
+
+// ADC 位置闭环的最小 (蠕动) 速度; 脉冲位置运动的蠕动速度为参数 MINSPD
+#define MOTOR_ADC_MIN_SPEED  300
 
 typedef struct {
     CtrlMode_t mode;
-    uint32_t start_tick;
-    uint32_t target_time;
+    uint64_t start_us;     // 定时运行: 开始时刻
+    uint64_t end_us;       // 定时运行: 结束时刻
     int32_t target_pulse;
     // ADC 位置控制相关
     uint16_t target_adc;
@@ -33,14 +49,154 @@ typedef struct {
 
 static AppMotorCtrl_t ctrl_vars[MAX_MOTORS];
 
+// 同步启动: 运动参数在布防时已写入 ctrl_vars, 启动中断只需写输出并切换模式
+typedef struct {
+    CtrlMode_t kind;      // CTRL_RUN_TIME / CTRL_RUN_POS / CTRL_RUN_ADC_POS
+    uint16_t duty;        // 起始占空比
+    uint64_t us;          // 定时运行: 时长
+} PendingMove_t;
+
+static PendingMove_t pending_moves[MAX_MOTORS];
+
+// 堵转检测: 有输出但超过 stall_ms 没有 FG 脉冲即停机 (参数 STALLm, 0 = 不检测)
+static uint16_t stall_ms[MAX_MOTORS];
+static uint8_t  stall_armed[MAX_MOTORS];
+static uint32_t stall_ref_us[MAX_MOTORS]; // 起转时刻或最近一次 FG 脉冲
+
+// 限位开关引脚 (bsp_conf.h), 由参数 LIMITm 启用; 未列出的电机端口为 NULL, 不检测
+typedef struct {
+    GPIO_TypeDef *cw_port;
+    uint16_t cw_pin;
+    GPIO_TypeDef *ccw_port;
+    uint16_t ccw_pin;
+} MotorLimitPins_t;
+
+static const MotorLimitPins_t limit_pins[MAX_MOTORS] = {
+    { MOTOR0_LIMIT_CW_PORT, MOTOR0_LIMIT_CW_PIN, MOTOR0_LIMIT_CCW_PORT, MOTOR0_LIMIT_CCW_PIN },
+};
+
+// ---------------- 运行参数 ----------------
+static int32_t Param_GetDecel(uint8_t m)  { return (int32_t)ctrl_vars[m].decel_range_pulses; }
+static int32_t Param_GetMinSpd(uint8_t m) { return ctrl_vars[m].min_approach_speed; }
+static int32_t Param_GetStall(uint8_t m)  { return stall_ms[m]; }
+static void Param_SetStall(uint8_t m, int32_t v) { stall_ms[m] = (uint16_t)v; }
+
+static void Param_SetDecel(uint8_t m, int32_t v) {
+    ctrl_vars[m].decel_range_pulses = (uint32_t)v;
+}
+
+static void Param_SetMinSpd(uint8_t m, int32_t v) {
+    ctrl_vars[m].min_approach_speed = (uint16_t)v;
+}
+
+// 0 = 不检测, 1 = 低电平触发, 2 = 高电平触发
+static int32_t Param_GetLimit(uint8_t m) {
+    if (!ctrl_vars[m].limit_configured) return 0;
+    return (ctrl_vars[m].limit_level == GPIO_PIN_SET) ? 2 : 1;
+}
+
+static void Param_SetLimit(uint8_t m, int32_t v) {
+    if (v == 0) {
+        App_Motor_ConfigLimit(m, NULL, 0, NULL, 0, GPIO_PIN_RESET);
+    } else {
+        const MotorLimitPins_t *p = &limit_pins[m];
+        // 输入 + 上拉 (低电平触发) / 下拉 (高电平触发), 开关悬空时不误触发
+        GPIO_InitTypeDef gpio = {0};
+        gpio.Mode = GPIO_MODE_INPUT;
+        gpio.Pull = (v == 2) ? GPIO_PULLDOWN : GPIO_PULLUP;
+        if (p->cw_port)  { gpio.Pin = p->cw_pin;  HAL_GPIO_Init(p->cw_port, &gpio); }
+        if (p->ccw_port) { gpio.Pin = p->ccw_pin; HAL_GPIO_Init(p->ccw_port, &gpio); }
+        App_Motor_ConfigLimit(m, p->cw_port, p->cw_pin, p->ccw_port, p->ccw_pin,
+                              (v == 2) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    }
+}
+
+static const ParamDesc_t motor_params[] = {
+    { 0x10, MAX_MOTORS, PARAM_U32, "DECEL",  "pulse", 0, 1000000, 2500, Param_GetDecel,  Param_SetDecel },
+    { 0x14, MAX_MOTORS, PARAM_U16, "MINSPD", "pwm",   0, 1000,    100,  Param_GetMinSpd, Param_SetMinSpd },
+    { 0x18, MAX_MOTORS, PARAM_U8,  "LIMIT",  "",      0, 2,       0,    Param_GetLimit,  Param_SetLimit },
+    { 0x1C, MAX_MOTORS, PARAM_U16, "STALL",  "ms",    0, 10000,   0,    Param_GetStall,  Param_SetStall },
+};
+
+// ---------------- Flash 擦除守护 ----------------
+// 擦除期间 (约 20~40ms) 中断暂停, 由 RAM 中的守护按寄存器直接停机, 并轮询 FG 补计脉冲.
+// 位置 / ADC 位置闭环的减速与到位停机需要主循环, 守护无法覆盖, 这些模式下请求推迟擦除.
+static uint8_t guard_motor[FLASH_JOB_GUARD_MAX]; // 守护条目 -> 电机号
+
+static uint8_t Motor_FlashGuardPrepare(BSP_FlashGuard_t *guard, uint8_t max, uint8_t *defer) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MAX_MOTORS && n < max; i++) {
+        const AppMotorCtrl_t *c = &ctrl_vars[i];
+        const BLDC_Config_t *hw = &motors[i].config;
+        BSP_FlashGuard_t *g = &guard[n];
+        guard_motor[n++] = i;
+
+        // 停止 / 等待启动的电机也可能仍在惯性滑行, FG 一律计数
+        if (hw->fg_port) {
+            g->fg_idr = &hw->fg_port->IDR;
+            g->fg_mask = hw->fg_pin;
+            g->fg_count = &motors[i].state.pulse_count;
+            g->fg_pos = &motors[i].state.position;
+            g->fg_step = (motors[i].state.dir == MOTOR_DIR_CW) ? 1 : -1;
+        }
+
+        if (c->mode == CTRL_STOP) continue;
+        if (c->mode != CTRL_RUN_TIME && c->mode != CTRL_RUN_MANUAL) *defer = 1;
+        if (c->mode == CTRL_WAIT_START) continue; // 等待中已刹车, 启动闹钟在擦除后补执行
+
+        g->pwm_ccr = &hw->htim_pwm->Instance->CCR1 + (hw->pwm_channel >> 2);
+        g->brake_bsrr = &hw->brake_port->BSRR;
+        g->brake_bits = (uint32_t)hw->brake_pin << 16; // 低电平刹车
+        g->use_pvd = (PWR->CR & PWR_CR_PVDE) != 0; // 快照要等擦除结束, 先停机; 运动状态仍由快照记录以便续跑
+
+        if (c->mode == CTRL_RUN_TIME) {
+            uint64_t now = BSP_Time_GetUs();
+            if (c->end_us < now + 1000000u) { // 远超一次擦除的截止时刻无需守护, 也避免 32 位时刻回绕
+                g->use_deadline = 1;
+                g->deadline_us = (uint32_t)c->end_us;
+            }
+        }
+
+        App_Adc_GetCurrentTrip(i, &g->cur_raw, &g->cur_limit);
+
+        if (c->use_limit) {
+            GPIO_TypeDef *port = (c->dir == MOTOR_DIR_CW) ? c->port_cw : c->port_ccw;
+            uint16_t pin = (c->dir == MOTOR_DIR_CW) ? c->pin_cw : c->pin_ccw;
+            if (port) {
+                g->limit_idr = &port->IDR;
+                g->limit_mask = pin;
+                g->limit_level = (c->limit_level == GPIO_PIN_SET) ? pin : 0;
+            }
+        }
+    }
+    return n;
+}
+
+// 擦除后同步软件状态 (输出已由守护关闭, 脉冲已补计)
+static void Motor_FlashGuardFinish(const BSP_FlashGuard_t *guard, uint8_t count) {
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t id = guard_motor[k];
+        // 补计的沿没有时刻, 以擦除结束为最近边沿, 堵转检测不把擦除时间算作无 FG
+        if (guard[k].fg_edges) motors[id].state.last_fg_us = BSP_Time_GetUs32();
+        if (guard[k].tripped == BSP_FLASH_TRIP_NONE) continue;
+        LOG_WARN("Motor %d stopped during flash erase, trip=%d\r\n", id, guard[k].tripped);
+        if (guard[k].tripped == BSP_FLASH_TRIP_CURRENT) App_Fault_Report(FAULT_OC, id, 0);
+        if (guard[k].tripped == BSP_FLASH_TRIP_LIMIT) {
+            App_Fault_Report(FAULT_LIMIT, id, ctrl_vars[id].dir);
+            EventBus_Post(EVT_LIMIT);
+        }
+        App_Motor_Stop(id);
+    }
+}
+
 void App_Motor_Init(void) {
     for(int i=0; i<MAX_MOTORS; i++) {
         ctrl_vars[i].mode = CTRL_STOP;
-        // 默认减速配置
-        ctrl_vars[i].decel_range_pulses = 100; // 默认剩下100脉冲开始减速
-        ctrl_vars[i].min_approach_speed = 300; // 最低PWM占空比
         ctrl_vars[i].limit_configured = 0;
     }
+    // 减速距离 / 蠕动速度 / 限位配置: 默认值与已保存值由参数注册表应用
+    App_Param_Register(motor_params, sizeof(motor_params) / sizeof(motor_params[0]));
+    FlashJob_SetGuard(Motor_FlashGuardPrepare, Motor_FlashGuardFinish);
 }
 
 // 供用户配置预减速参数
@@ -50,6 +206,12 @@ void App_Motor_ConfigDecel(uint8_t id, uint32_t decel_pulses, uint16_t min_speed
     ctrl_vars[id].min_approach_speed = min_speed;
 }
 
+void App_Motor_GetDecel(uint8_t id, uint32_t *decel_pulses, uint16_t *min_speed) {
+    if(id >= MAX_MOTORS) return;
+    if (decel_pulses) *decel_pulses = ctrl_vars[id].decel_range_pulses;
+    if (min_speed) *min_speed = ctrl_vars[id].min_approach_speed;
+}
+
 // 供用户配置限位开关
 void App_Motor_ConfigLimit(uint8_t id, GPIO_TypeDef* cw_port, uint16_t cw_pin, 
                            GPIO_TypeDef* ccw_port, uint16_t ccw_pin, GPIO_PinState active_level) 
@@ -60,108 +222,230 @@ void App_Motor_ConfigLimit(uint8_t id, GPIO_TypeDef* cw_port, uint16_t cw_pin,
     ctrl_vars[id].port_ccw = ccw_port;
     ctrl_vars[id].pin_ccw = ccw_pin;
     ctrl_vars[id].limit_level = active_level;
-    ctrl_vars[id].limit_configured = 1;
+    ctrl_vars[id].limit_configured = (cw_port != NULL || ccw_port != NULL); // 端口均为 NULL 即取消限位
 }
 
-void App_Motor_MoveTime(uint8_t id, uint8_t dir, uint16_t speed, uint32_t ms) {
-    if(id >= MAX_MOTORS) return;
-    
-    ctrl_vars[id].mode = CTRL_RUN_TIME;
-    ctrl_vars[id].target_time = ms;
-    ctrl_vars[id].start_tick = HAL_GetTick();
-    ctrl_vars[id].use_limit = 0; // 默认不启用，如需启用可自行修改或增加接口
-    
-    BSP_BLDC_Brake(id, 0); // 松刹车
-    BSP_BLDC_SetDir(id, (MotorDir_t)dir);
-    BSP_BLDC_SetSpeed(id, speed);
+// ---------------- 运动启停 ----------------
+// ctrl_vars 与电机输出由主循环 (AT / LIN / 联动 / 闭环调速) 和中断 (TIM3 闹钟到时 / 同步启动,
+// ADC 过流保护, 掉电快照) 共同改写: 主循环里 "改参数 + 写输出 + 切模式" 的序列在关中断下完成,
+// 中断只会看到完整的前后状态; 中断中只写寄存器级输出和模式字, 不执行完整的运动指令.
+static inline uint32_t Motor_Lock(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
 }
 
-void App_Motor_MovePos(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses) {
-    if(id >= MAX_MOTORS) return;
-    
-    ctrl_vars[id].mode = CTRL_RUN_POS;
-    ctrl_vars[id].target_pulse = pulses;
-    ctrl_vars[id].cruise_speed = speed;
-    ctrl_vars[id].dir = dir;
-    ctrl_vars[id].use_limit = 0; // 原接口不启用限位
-    
-    BSP_BLDC_ResetPulse(id); // 归零，相对运动
-    
-    BSP_BLDC_Brake(id, 0);
-    BSP_BLDC_SetDir(id, (MotorDir_t)dir);
-    
-    // 刚启动时，如果总距离很短，可能直接进入减速区
-    if (pulses <= (int32_t)ctrl_vars[id].decel_range_pulses) {
-         BSP_BLDC_SetSpeed(id, ctrl_vars[id].min_approach_speed);
-    } else {
-         BSP_BLDC_SetSpeed(id, speed);
-    }
+static inline void Motor_Unlock(uint32_t primask) {
+    __set_PRIMASK(primask);
 }
 
-void App_Motor_MovePosWithLimit(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses) {
-    if(id >= MAX_MOTORS) return;
-    
-    // 复用 MovePos 逻辑，仅置位 use_limit
-    App_Motor_MovePos(id, dir, speed, pulses);
-    
-    // 如果配置了引脚，则开启检测限位开关
-    if (ctrl_vars[id].limit_configured) {
-        ctrl_vars[id].use_limit = 1;
+// 定时运行到期 (TIM3 比较中断上下文)
+static void Motor_TimeAlarm(uint8_t id) {
+    if (ctrl_vars[id].mode == CTRL_RUN_TIME) {
+        App_Motor_Stop(id);
     }
 }
-void App_Motor_MoveAdcPos(uint8_t id, uint16_t speed, uint16_t target_adc, uint16_t tolerance, uint16_t range_adc) {
-    if(id >= MAX_MOTORS) return;
 
-    ctrl_vars[id].mode = CTRL_RUN_ADC_POS;
-    ctrl_vars[id].target_adc = target_adc;
-    ctrl_vars[id].adc_tolerance = tolerance;
-    ctrl_vars[id].adc_decel_range = range_adc;
-    ctrl_vars[id].cruise_speed = speed;
-    ctrl_vars[id].min_approach_speed = 300; // 默认最小速度
-    ctrl_vars[id].use_limit = 0; // 默认不开限位，如需可另加接口
+// 定时运行: 以实际输出时刻为起点, 由 TIM3 比较通道在到期时刻停机 (约 1us 精度)
+static void Motor_ArmTimeEnd(uint8_t id, uint64_t us) {
+    ctrl_vars[id].start_us = BSP_Time_GetUs();
+    ctrl_vars[id].end_us = ctrl_vars[id].start_us + us;
+    BSP_Time_SetAlarm(BSP_TIME_ALARM_MOTOR(id), ctrl_vars[id].end_us, Motor_TimeAlarm, id);
+}
+
+// 按 ctrl_vars 中已备好的方向启动输出, 最后切换模式 (关中断下或中断上下文调用)
+static void Motor_Output(uint8_t id, CtrlMode_t mode, uint16_t duty) {
+    if (mode == CTRL_RUN_POS || mode == CTRL_RUN_MANUAL) BSP_BLDC_ResetPulse(id); // 归零，相对运动
+    BSP_BLDC_Brake(id, 0); // 松刹车
+    BSP_BLDC_SetDir(id, (MotorDir_t)ctrl_vars[id].dir);
+    BSP_BLDC_SetSpeed(id, duty);
+    ctrl_vars[id].mode = mode;
+}
+
+// 预备位置运动参数 (不动输出), 返回起始占空比
+static uint16_t Motor_PreparePos(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses, uint8_t with_limit) {
+    AppMotorCtrl_t *c = &ctrl_vars[id];
+    c->target_pulse = pulses;
+    c->cruise_speed = speed;
+    c->dir = dir;
+    c->use_limit = with_limit && c->limit_configured; // 配置了引脚才检测限位开关
+
+    // 刚启动时，如果总距离很短，可能直接进入减速区
+    return (pulses <= (int32_t)c->decel_range_pulses) ? c->min_approach_speed : speed;
+}
+
+// 预备 ADC 位置运动参数 (不动输出), 已在允许误差内返回 0
+static uint8_t Motor_PrepareAdc(uint8_t id, uint16_t speed, uint16_t target_adc, uint16_t tolerance,
+                                uint16_t range_adc, uint8_t with_limit) {
+    AppMotorCtrl_t *c = &ctrl_vars[id];
+    c->target_adc = target_adc;
+    c->adc_tolerance = tolerance;
+    c->adc_decel_range = range_adc;
+    c->cruise_speed = speed;
+    c->use_limit = with_limit && c->limit_configured;
 
     // 初始判断方向
     uint16_t current_adc = App_Adc_GetPos(id);
-    if (abs((int)current_adc - (int)target_adc) <= tolerance) {
-        App_Motor_Stop(id);
-        return;
-    }
+    if (abs((int)current_adc - (int)target_adc) <= tolerance) return 0;
 
     // 简单逻辑：目标大则正转，目标小则反转（需根据实际传感器安装方向确认）
     // 假设：ADC增大 = 正转
-    if (target_adc > current_adc) {
-        ctrl_vars[id].dir = MOTOR_DIR_CW;
+    c->dir = (target_adc > current_adc) ? MOTOR_DIR_CW : MOTOR_DIR_CCW;
+    return 1;
+}
+
+void App_Motor_MoveTime(uint8_t id, uint8_t dir, uint16_t speed, uint32_t ms) {
+    App_Motor_MoveTimeUs(id, dir, speed, (uint64_t)ms * 1000u);
+}
+
+void App_Motor_MoveTimeUs(uint8_t id, uint8_t dir, uint16_t speed, uint64_t us) {
+    if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    ctrl_vars[id].use_limit = 0; // 默认不启用，如需启用可自行修改或增加接口
+    ctrl_vars[id].dir = dir;
+    Motor_ArmTimeEnd(id, us);
+    Motor_Output(id, CTRL_RUN_TIME, speed);
+    Motor_Unlock(primask);
+}
+
+static void Motor_MovePos(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses, uint8_t with_limit) {
+    if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    uint16_t duty = Motor_PreparePos(id, dir, speed, pulses, with_limit);
+    Motor_Output(id, CTRL_RUN_POS, duty);
+    Motor_Unlock(primask);
+}
+
+void App_Motor_MovePos(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses) {
+    Motor_MovePos(id, dir, speed, pulses, 0); // 原接口不启用限位
+}
+
+void App_Motor_MovePosWithLimit(uint8_t id, uint8_t dir, uint16_t speed, int32_t pulses) {
+    Motor_MovePos(id, dir, speed, pulses, 1);
+}
+
+static void Motor_MoveAdcPos(uint8_t id, uint16_t speed, uint16_t target_adc, uint16_t tolerance,
+                             uint16_t range_adc, uint8_t with_limit) {
+    if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    if (Motor_PrepareAdc(id, speed, target_adc, tolerance, range_adc, with_limit)) {
+        Motor_Output(id, CTRL_RUN_ADC_POS, speed);
     } else {
-        ctrl_vars[id].dir = MOTOR_DIR_CCW;
+        App_Motor_Stop(id);
     }
+    Motor_Unlock(primask);
+}
 
-    BSP_BLDC_Brake(id, 0);
-    BSP_BLDC_SetDir(id, (MotorDir_t)ctrl_vars[id].dir);
-    BSP_BLDC_SetSpeed(id, speed);
+void App_Motor_MoveAdcPos(uint8_t id, uint16_t speed, uint16_t target_adc, uint16_t tolerance, uint16_t range_adc) {
+    Motor_MoveAdcPos(id, speed, target_adc, tolerance, range_adc, 0); // 默认不开限位
 }
 
 void App_Motor_MoveAdcPosWithLimit(uint8_t id, uint16_t speed, uint16_t target_adc, uint16_t tolerance, uint16_t range_adc) {
+    Motor_MoveAdcPos(id, speed, target_adc, tolerance, range_adc, 1);
+}
+
+// 启动时刻到达 (TIM3 比较中断上下文): 只写输出并切换模式, 定时运行的结束闹钟复用同一通道
+static void Motor_StartAlarm(uint8_t id) {
+    if (ctrl_vars[id].mode != CTRL_WAIT_START) return;
+    const PendingMove_t *p = &pending_moves[id];
+    if (p->kind == CTRL_RUN_TIME) Motor_ArmTimeEnd(id, p->us);
+    Motor_Output(id, p->kind, p->duty);
+}
+
+// 参数已写入 ctrl_vars (关中断下调用)
+static void Motor_ArmStart(uint8_t id, uint64_t at_us, CtrlMode_t kind, uint16_t duty, uint64_t us) {
+    pending_moves[id].kind = kind;
+    pending_moves[id].duty = duty;
+    pending_moves[id].us = us;
+    ctrl_vars[id].mode = CTRL_WAIT_START;
+    ctrl_vars[id].start_us = at_us;
+    BSP_Time_SetAlarm(BSP_TIME_ALARM_MOTOR(id), at_us, Motor_StartAlarm, id);
+}
+
+void App_Motor_MoveTimeAt(uint8_t id, uint64_t at_us, uint8_t dir, uint16_t speed, uint32_t ms) {
     if(id >= MAX_MOTORS) return;
-    
-    // 复用 MoveAdcPos 逻辑
-    App_Motor_MoveAdcPos(id, speed, target_adc, tolerance, range_adc);
-    
-    // 如果配置了引脚，则开启检测限位开关
-    if (ctrl_vars[id].limit_configured) {
-        ctrl_vars[id].use_limit = 1;
-    }
+    uint32_t primask = Motor_Lock();
+    App_Motor_Stop(id); // 等待期间刹车
+    ctrl_vars[id].use_limit = 0;
+    ctrl_vars[id].dir = dir;
+    Motor_ArmStart(id, at_us, CTRL_RUN_TIME, speed, (uint64_t)ms * 1000u);
+    Motor_Unlock(primask);
+}
+
+void App_Motor_MovePosAt(uint8_t id, uint64_t at_us, uint8_t dir, uint16_t speed, int32_t pulses, uint8_t with_limit) {
+    if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    App_Motor_Stop(id);
+    uint16_t duty = Motor_PreparePos(id, dir, speed, pulses, with_limit);
+    Motor_ArmStart(id, at_us, CTRL_RUN_POS, duty, 0);
+    Motor_Unlock(primask);
 }
+
+void App_Motor_MoveAdcPosAt(uint8_t id, uint64_t at_us, uint16_t speed, uint16_t target_adc,
+                            uint16_t tolerance, uint16_t range_adc, uint8_t with_limit) {
+    if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    App_Motor_Stop(id);
+    // 方向按布防时的位置预判, 启动时已在误差内则由 App_Motor_Process 立即停机
+    Motor_PrepareAdc(id, speed, target_adc, tolerance, range_adc, with_limit);
+    Motor_ArmStart(id, at_us, CTRL_RUN_ADC_POS, speed, 0);
+    Motor_Unlock(primask);
+}
+
+// 可在中断中调用
 void App_Motor_Stop(uint8_t id) {
     if(id >= MAX_MOTORS) return;
+    uint32_t primask = Motor_Lock();
+    if (ctrl_vars[id].mode != CTRL_STOP) EventBus_Post(EVT_MOTOR_DONE); // 等待该电机停止的联动由此唤醒
     ctrl_vars[id].mode = CTRL_STOP;
+    BSP_Time_CancelAlarm(BSP_TIME_ALARM_MOTOR(id));
     BSP_BLDC_SetSpeed(id, 0);
     BSP_BLDC_Brake(id, 1);
+    Motor_Unlock(primask);
+}
+
+// 闭环调速: 关中断下确认模式未被中断改写 (到时 / 保护停机) 再写输出
+static void Motor_Update(uint8_t id, CtrlMode_t mode, uint8_t dir, uint16_t duty) {
+    uint32_t primask = Motor_Lock();
+    if (ctrl_vars[id].mode == mode) {
+        if (dir != ctrl_vars[id].dir) {
+            ctrl_vars[id].dir = dir;
+            BSP_BLDC_SetDir(id, (MotorDir_t)dir);
+        }
+        BSP_BLDC_SetSpeed(id, duty);
+    }
+    Motor_Unlock(primask);
+}
+
+// 堵转检测, 检出时停机并返回 1
+static uint8_t Motor_CheckStall(uint8_t i) {
+    CtrlMode_t mode = ctrl_vars[i].mode;
+    if (stall_ms[i] == 0 || mode == CTRL_STOP || mode == CTRL_WAIT_START || motors[i].state.current_duty == 0) {
+        stall_armed[i] = 0;
+        return 0;
+    }
+    uint32_t now = BSP_Time_GetUs32();
+    uint32_t last_fg = motors[i].state.last_fg_us;
+    if (!stall_armed[i]) {
+        stall_armed[i] = 1;
+        stall_ref_us[i] = now;
+    }
+    if ((int32_t)(last_fg - stall_ref_us[i]) > 0) stall_ref_us[i] = last_fg;
+    if (now - stall_ref_us[i] < (uint32_t)stall_ms[i] * 1000u) return 0;
+
+    LOG_WARN("Motor %d stalled: no FG for %d ms, duty=%d\r\n", i, stall_ms[i], motors[i].state.current_duty);
+    App_Fault_Report(FAULT_STALL, i, 0);
+    App_Motor_Stop(i);
+    stall_armed[i] = 0;
+    return 1;
 }
 
 void App_Motor_Process(void) {
     for(int i=0; i<MAX_MOTORS; i++) {
+        if (Motor_CheckStall((uint8_t)i)) continue;
+
         // 限位开关检测
-        if (ctrl_vars[i].use_limit && ctrl_vars[i].mode != CTRL_STOP) {
+        if (ctrl_vars[i].use_limit && ctrl_vars[i].mode != CTRL_STOP && ctrl_vars[i].mode != CTRL_WAIT_START) {
             uint8_t stop_req = 0;
             // 正转检测 CW 开关
             if (ctrl_vars[i].dir == MOTOR_DIR_CW && ctrl_vars[i].port_cw != NULL) {
@@ -177,13 +461,17 @@ void App_Motor_Process(void) {
             }
             
             if (stop_req) {
+                 LOG_INFO("Motor %d limit switch hit, dir=%d\r\n", i, ctrl_vars[i].dir);
+                 App_Fault_Report(FAULT_LIMIT, (uint8_t)i, ctrl_vars[i].dir);
+                 EventBus_Post(EVT_LIMIT);
                  App_Motor_Stop(i);
                  continue; // 跳过后续逻辑
             }
         }
 
         if (ctrl_vars[i].mode == CTRL_RUN_TIME) {
-            if (HAL_GetTick() - ctrl_vars[i].start_tick >= ctrl_vars[i].target_time) {
+            // 正常由闹钟停机, 此处仅作兜底
+            if (BSP_Time_GetUs() >= ctrl_vars[i].end_us) {
                 App_Motor_Stop(i);
             }
         }
@@ -204,7 +492,7 @@ void App_Motor_Process(void) {
                 uint16_t new_speed = ctrl_vars[i].min_approach_speed + 
                                      (speed_range * remain) / ctrl_vars[i].decel_range_pulses;
                 
-                BSP_BLDC_SetSpeed(i, new_speed);
+                Motor_Update((uint8_t)i, CTRL_RUN_POS, ctrl_vars[i].dir, new_speed);
             }
         }
         else if (ctrl_vars[i].mode == CTRL_RUN_ADC_POS) {
@@ -220,21 +508,17 @@ void App_Motor_Process(void) {
                 // 2. 动态调整方向 (防止越过目标后无法回头)
                 // 假设 CW 增加 ADC
                 uint8_t needed_dir = (diff > 0) ? MOTOR_DIR_CW : MOTOR_DIR_CCW;
-                if (needed_dir != ctrl_vars[i].dir) {
-                    ctrl_vars[i].dir = needed_dir;
-                    BSP_BLDC_SetDir(i, (MotorDir_t)needed_dir);
-                }
 
                 // 3. 计算速度 (预减速)
                 uint16_t set_speed = ctrl_vars[i].cruise_speed;
                 if (abs_diff <= ctrl_vars[i].adc_decel_range) {
-                    uint32_t speed_range = ctrl_vars[i].cruise_speed - ctrl_vars[i].min_approach_speed;
-                    if (ctrl_vars[i].cruise_speed < ctrl_vars[i].min_approach_speed) speed_range = 0;
+                    uint32_t speed_range = ctrl_vars[i].cruise_speed - MOTOR_ADC_MIN_SPEED;
+                    if (ctrl_vars[i].cruise_speed < MOTOR_ADC_MIN_SPEED) speed_range = 0;
                     
-                    set_speed = ctrl_vars[i].min_approach_speed + 
+                    set_speed = MOTOR_ADC_MIN_SPEED + 
                                 (speed_range * abs_diff) / ctrl_vars[i].adc_decel_range;
                 }
-                BSP_BLDC_SetSpeed(i, set_speed);
+                Motor_Update((uint8_t)i, CTRL_RUN_ADC_POS, needed_dir, set_speed);
             }
         }
     }
@@ -245,19 +529,86 @@ uint8_t App_Motor_IsBusy(uint8_t id) {
     return (ctrl_vars[id].mode != CTRL_STOP);
 }
 
+uint8_t App_Motor_GetMode(uint8_t id) {
+    if(id >= MAX_MOTORS) return CTRL_STOP;
+    return (uint8_t)ctrl_vars[id].mode;
+}
+
+void App_Motor_GetResume(uint8_t id, MotorResume_t *r) {
+    if (id >= MAX_MOTORS || !r) return;
+    const AppMotorCtrl_t *c = &ctrl_vars[id];
+    memset(r, 0, sizeof(*r));
+    r->mode = CTRL_STOP;
+    r->dir = c->dir;
+    r->with_limit = c->use_limit;
+    r->speed = c->cruise_speed;
+
+    switch (c->mode) {
+        case CTRL_RUN_MANUAL:
+            r->mode = CTRL_RUN_MANUAL;
+            r->speed = motors[id].state.current_duty;
+            r->dir = motors[id].state.dir;
+            break;
+        case CTRL_RUN_TIME: {
+            uint64_t now = BSP_Time_GetUs();
+            if (c->end_us > now) {
+                r->mode = CTRL_RUN_TIME;
+                r->speed = motors[id].state.current_duty;
+                r->dir = motors[id].state.dir;
+                r->arg = (int32_t)((c->end_us - now) / 1000u);
+            }
+            break;
+        }
+        case CTRL_RUN_POS: {
+            int32_t remain = c->target_pulse - abs(BSP_BLDC_GetPulse(id));
+            if (remain > 0) {
+                r->mode = CTRL_RUN_POS;
+                r->arg = remain;
+            }
+            break;
+        }
+        case CTRL_RUN_ADC_POS:
+            r->mode = CTRL_RUN_ADC_POS;
+            r->arg = c->target_adc;
+            r->tolerance = c->adc_tolerance;
+            r->range = c->adc_decel_range;
+            break;
+        default: // 停止 / 同步启动等待中 (启动时刻已失效)
+            break;
+    }
+}
+
+void App_Motor_Resume(uint8_t id, const MotorResume_t *r) {
+    if (id >= MAX_MOTORS || !r) return;
+    switch (r->mode) {
+        case CTRL_RUN_MANUAL:
+            App_Motor_MoveManual(id, r->dir, r->speed);
+            break;
+        case CTRL_RUN_TIME:
+            App_Motor_MoveTime(id, r->dir, r->speed, (uint32_t)r->arg);
+            break;
+        case CTRL_RUN_POS:
+            if (r->with_limit) App_Motor_MovePosWithLimit(id, r->dir, r->speed, r->arg);
+            else App_Motor_MovePos(id, r->dir, r->speed, r->arg);
+            break;
+        case CTRL_RUN_ADC_POS:
+            if (r->with_limit) App_Motor_MoveAdcPosWithLimit(id, r->speed, (uint16_t)r->arg, r->tolerance, r->range);
+            else App_Motor_MoveAdcPos(id, r->speed, (uint16_t)r->arg, r->tolerance, r->range);
+            break;
+        default:
+            return;
+    }
+    LOG_INFO("Motor %d resumed: mode=%d dir=%d speed=%d arg=%ld\r\n", id, r->mode, r->dir, r->speed, r->arg);
+}
+
 void App_Motor_MoveManual(uint8_t id, uint8_t dir, uint16_t speed) {
     if(id >= MAX_MOTORS) return;
     
-    // 设置内部状态为手动
-    ctrl_vars[id].mode = CTRL_RUN_MANUAL;
-    
-    // 复位脉冲（可选，看需求）
-    BSP_BLDC_ResetPulse(id);
-    
-    // 直接下发指令
-    BSP_BLDC_Brake(id, 0);
-    BSP_BLDC_SetDir(id, (MotorDir_t)dir);
-    BSP_BLDC_SetSpeed(id, speed);
+    // 直接下发指令, 内部状态为手动 (复位脉冲)
+    uint32_t primask = Motor_Lock();
+    ctrl_vars[id].dir = dir;
+    Motor_Output(id, CTRL_RUN_MANUAL, speed);
+    Motor_Unlock(primask);
 }
 
 // duplicate App_Motor_Process removed; use the primary implementation above.
@@ -0,0 +1,148 @@
+#include "app_param.h"
+#include "flash_kv.h"
+#define LOG_MODULE LOG_MOD_STORAGE
+#include "log.h"
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+static const ParamDesc_t *param_tables[PARAM_MAX_TABLES];
+static uint8_t param_table_len[PARAM_MAX_TABLES];
+static uint8_t param_table_cnt = 0;
+static uint8_t param_save_pending = 0; // 存储忙, 部分参数尚未写入, 由 App_Param_Process 重试
+
+static uint8_t Param_InRange(const ParamDesc_t *d, int32_t v) {
+    return v >= d->min && v <= d->max;
+}
+
+void App_Param_Register(const ParamDesc_t *table, uint8_t count) {
+    if (!table || param_table_cnt >= PARAM_MAX_TABLES) {
+        LOG_ERROR("Param table full\r\n");
+        return;
+    }
+    param_tables[param_table_cnt] = table;
+    param_table_len[param_table_cnt] = count;
+    param_table_cnt++;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const ParamDesc_t *d = &table[i];
+        for (uint8_t k = 0; k < d->count; k++) {
+            int32_t v;
+            if (FlashKV_Read(PARAM_KV_KEY(d->id + k), &v, sizeof(v)) != sizeof(v) || !Param_InRange(d, v)) {
+                v = d->def;
+            }
+            d->set(k, v);
+        }
+    }
+}
+
+uint8_t App_Param_At(uint16_t pos, ParamRef_t *ref) {
+    for (uint8_t t = 0; t < param_table_cnt; t++) {
+        for (uint8_t i = 0; i < param_table_len[t]; i++) {
+            const ParamDesc_t *d = &param_tables[t][i];
+            if (pos < d->count) {
+                if (ref) {
+                    ref->desc = d;
+                    ref->idx = (uint8_t)pos;
+                }
+                return 1;
+            }
+            pos -= d->count;
+        }
+    }
+    return 0;
+}
+
+uint8_t App_Param_Find(uint8_t num, ParamRef_t *ref) {
+    ParamRef_t r;
+    for (uint16_t pos = 0; App_Param_At(pos, &r); pos++) {
+        if (App_Param_Num(&r) == num) {
+            if (ref) *ref = r;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 名称匹配: 普通参数全名, 数组参数为名称 + 十进制下标
+static uint8_t Param_NameMatch(const ParamRef_t *r, const char *name) {
+    size_t n = strlen(r->desc->name);
+    if (strncasecmp(name, r->desc->name, n) != 0) return 0;
+    const char *s = name + n;
+    if (r->desc->count == 1) return *s == '\0';
+    if (*s == '\0') return 0;
+    for (const char *p = s; *p; p++) {
+        if (*p < '0' || *p > '9') return 0;
+    }
+    return atoi(s) == r->idx;
+}
+
+uint8_t App_Param_FindByName(const char *name, ParamRef_t *ref) {
+    if (!name) return 0;
+    ParamRef_t r;
+    for (uint16_t pos = 0; App_Param_At(pos, &r); pos++) {
+        if (Param_NameMatch(&r, name)) {
+            if (ref) *ref = r;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t App_Param_Num(const ParamRef_t *ref) {
+    return (uint8_t)(ref->desc->id + ref->idx);
+}
+
+uint8_t App_Param_Size(const ParamRef_t *ref) {
+    switch (ref->desc->type) {
+        case PARAM_U8:  return 1;
+        case PARAM_U16: return 2;
+        default:        return 4;
+    }
+}
+
+int32_t App_Param_Get(const ParamRef_t *ref) {
+    return ref->desc->get(ref->idx);
+}
+
+ParamStatus_t App_Param_Set(const ParamRef_t *ref, int32_t value) {
+    if (!ref || !ref->desc) return PARAM_ERR_UNKNOWN;
+    if (!Param_InRange(ref->desc, value)) return PARAM_ERR_RANGE;
+    ref->desc->set(ref->idx, value);
+    return PARAM_OK;
+}
+
+ParamStatus_t App_Param_Save(void) {
+    ParamStatus_t st = PARAM_OK;
+    ParamRef_t r;
+    for (uint16_t pos = 0; App_Param_At(pos, &r); pos++) {
+        uint16_t key = PARAM_KV_KEY(App_Param_Num(&r));
+        int32_t v = App_Param_Get(&r);
+        // 从未保存且为默认值: 不占用存储空间
+        if (v == r.desc->def && FlashKV_Read(key, NULL, 0) < 0) continue;
+        FlashKvResult_t res = FlashKV_Write(key, &v, sizeof(v));
+        if (res == FLASH_KV_BUSY) {
+            // 已提交的参数重试时与队列中的记录比较, 不会重复写入
+            param_save_pending = 1;
+            break;
+        }
+        if (res != FLASH_KV_OK) {
+            LOG_ERROR("Param %s%d save failed\r\n", r.desc->name, r.idx);
+            st = PARAM_ERR_FLASH;
+        }
+    }
+    return st;
+}
+
+void App_Param_Process(void) {
+    if (!param_save_pending || FlashKV_Busy()) return;
+    param_save_pending = 0;
+    App_Param_Save();
+}
+
+void App_Param_ResetDefaults(void) {
+    ParamRef_t r;
+    for (uint16_t pos = 0; App_Param_At(pos, &r); pos++) {
+        r.desc->set(r.idx, r.desc->def);
+    }
+}
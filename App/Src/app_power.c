@@ -0,0 +1,92 @@
+#include "app_power.h"
+#include "app_motor.h"
+#include "app_linkage.h"
+#include "app_adc.h"
+#include "app_storage.h"
+#include "app_lin.h"
+#include "app_snapshot.h"
+#include "event_bus.h"
+#include "flash_job.h"
+#include "bsp_bldc.h"
+#include "bsp_power.h"
+#include "bsp_conf.h"
+#include "log.h"
+
+#define POWER_TX_DRAIN_MS   20 // 休眠前等待调试串口发送完成 (AT 应答 / 日志)
+
+static volatile uint8_t sleep_req = POWER_SLEEP_NONE;
+static PowerStat_t power_stat;
+
+void App_Power_RequestSleep(PowerSleepReason_t reason) {
+    sleep_req = (uint8_t)reason;
+}
+
+void App_Power_GetStat(PowerStat_t *stat) {
+    if (stat) *stat = power_stat;
+}
+
+// 总线空闲超时: 仅在电机与联动均空闲时生效, 不打断进行中的运动
+static uint8_t Power_IdleTimeout(void) {
+    if (g_Config.lin_sleep_timeout_s == 0) return 0;
+    if (!App_Linkage_Idle()) return 0;
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) {
+        if (App_Motor_IsBusy(i)) return 0;
+    }
+    LinBusStat_t bus;
+    App_LIN_GetBusStat(&bus);
+    return bus.idle_ms >= g_Config.lin_sleep_timeout_s * 1000u;
+}
+
+static void Power_EnterSleep(uint8_t reason) {
+    LOG_INFO("Sleep: reason=%d\r\n", reason);
+
+    // 1. 停止联动, 刹车所有电机 (PWM 占空比 0, 刹车脚在 Stop 模式中保持)
+    App_Linkage_SetMode(LINK_MODE_IDLE, 0);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Stop(i);
+
+    // 2. 完成排队中的 Flash 作业 (Stop 模式下无法继续), 等待调试串口发完
+    FlashJob_Flush();
+    uint32_t t0 = HAL_GetTick();
+    while (LOG_UART_HANDLE.gState != HAL_UART_STATE_READY && HAL_GetTick() - t0 < POWER_TX_DRAIN_MS) {
+    }
+
+    // 3. 门控 10kHz 节拍与 ADC 采样, 收发器休眠
+    HAL_TIM_Base_Stop_IT(&BASE_TIM_HANDLE);
+    App_Adc_Suspend();
+    App_LIN_Sleep();
+
+    uint8_t wake = BSP_Power_EnterStop(BSP_WAKE_LIN | BSP_WAKE_AT);
+
+    // 4. 恢复 (系统时钟已由 BSP 恢复)
+    App_LIN_Wake();
+    App_Adc_Resume();
+    HAL_TIM_Base_Start_IT(&BASE_TIM_HANDLE);
+
+    power_stat.sleeps++;
+    power_stat.last_reason = reason;
+    power_stat.last_wake = wake;
+    LOG_INFO("Wake: src=%d\r\n", wake);
+}
+
+void App_Power_Process(void) {
+    uint8_t reason = sleep_req;
+    if (reason == POWER_SLEEP_NONE && Power_IdleTimeout()) reason = POWER_SLEEP_LIN_IDLE;
+    if (reason == POWER_SLEEP_NONE) return;
+
+    sleep_req = POWER_SLEEP_NONE;
+    Power_EnterSleep(reason);
+}
+
+void App_Power_Idle(void) {
+    if (!FlashJob_Idle()) return;
+    if (App_Linkage_Ready() && !App_Snapshot_Holding()) return;
+
+    // 关中断下检查并 WFI: 检查之后到来的中断仍会挂起并立即唤醒, 不会丢失事件
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (EventBus_Idle()) {
+        power_stat.idles++;
+        __WFI();
+    }
+    __set_PRIMASK(primask);
+}
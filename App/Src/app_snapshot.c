@@ -0,0 +1,209 @@
+#include "app_snapshot.h"
+#include "app_motor.h"
+#include "app_adc.h"
+#include "app_param.h"
+#include "bsp_flash.h"
+#include "bsp_power.h"
+#include "bsp_conf.h"
+#include "bsp_crc.h"
+#include "flash_job.h"
+#define LOG_MODULE LOG_MOD_STORAGE
+#include "log.h"
+#include <stddef.h>
+#include <string.h>
+
+#define SNAP_MAGIC      0x50414E53u // "SNAP"
+#define SNAP_STATE_LIVE 0xFFFFFFFFu // 状态字保持擦除值 = 有效; 写 0 = 已作废
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint8_t  src;           // SnapSource_t
+    uint8_t  motors;        // MAX_MOTORS
+    uint16_t vbus_dv;
+    int32_t  pos[MAX_MOTORS];
+    MotorResume_t motor[MAX_MOTORS];
+    LinkageResume_t link[LINK_INSTANCES];
+    uint32_t crc;           // CRC (bsp_crc.h), 以上字段
+    uint32_t state;         // 不参与 CRC, 恢复后写 0
+} SnapRecord_t;
+
+_Static_assert(sizeof(SnapRecord_t) % 4 == 0, "snapshot record must be word aligned");
+
+#define SNAP_SLOTS      (FLASH_PAGE_SIZE / sizeof(SnapRecord_t))
+#define SNAP_SLOT_ADDR(i) (FLASH_SNAP_PAGE_ADDR + (uint32_t)(i) * sizeof(SnapRecord_t))
+
+static SnapRecord_t snap_rec;           // 最近一次写入 / 恢复的记录
+static uint32_t snap_seq = 0;
+static uint8_t  snap_next = 0;          // 下一个空位
+static volatile uint8_t snap_armed = 0;
+static volatile uint8_t snap_hold = 0;  // 已触发, 等待电压回升
+static volatile int8_t  snap_saved = -1; // 本次上电写入的记录 (回升后作废)
+static uint8_t  snap_erasing = 0;
+static uint32_t snap_ok_tick = 0;       // 最近一次电压异常时刻
+static SnapStat_t snap_stat;
+
+// 参数 RESUME: 0 = 仅恢复绝对位置, 1 = 同时续跑运动与联动
+static uint8_t resume_enable = 1;
+
+static int32_t Param_GetResume(uint8_t i) { (void)i; return resume_enable; }
+static void Param_SetResume(uint8_t i, int32_t v) { (void)i; resume_enable = (uint8_t)v; }
+
+static const ParamDesc_t snap_params[] = {
+    { 0x38, 1, PARAM_U8, "RESUME", "", 0, 1, 1, Param_GetResume, Param_SetResume },
+};
+
+static uint8_t Snap_SlotErased(uint8_t slot) {
+    const uint32_t *w = (const uint32_t *)SNAP_SLOT_ADDR(slot);
+    for (uint32_t i = 0; i < sizeof(SnapRecord_t) / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return 0;
+    }
+    return 1;
+}
+
+static uint8_t Snap_SlotValid(uint8_t slot) {
+    const SnapRecord_t *r = (const SnapRecord_t *)SNAP_SLOT_ADDR(slot);
+    return r->magic == SNAP_MAGIC && r->motors == MAX_MOTORS && r->state == SNAP_STATE_LIVE
+        && r->crc == BSP_Crc_Calc(r, offsetof(SnapRecord_t, crc));
+}
+
+static void Snap_Invalidate(uint8_t slot) {
+    static const uint16_t zero[2] = { 0, 0 };
+    BSP_Flash_ProgramUrgent(SNAP_SLOT_ADDR(slot) + offsetof(SnapRecord_t, state), zero, 2);
+}
+
+static void Snap_UpdateStat(void) {
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) {
+        snap_stat.pos[i] = snap_rec.pos[i];
+        snap_stat.motor_mode[i] = snap_rec.motor[i].mode;
+    }
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) snap_stat.link[i] = snap_rec.link[i];
+    snap_stat.last_src = snap_rec.src;
+    snap_stat.last_vbus_dv = snap_rec.vbus_dv;
+}
+
+// 续跑快照中断的运动与联动
+static void Snap_Resume(void) {
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Resume(i, &snap_rec.motor[i]);
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) App_Linkage_Resume(i, &snap_rec.link[i]);
+}
+
+static void Snap_OnPvd(void) {
+    App_Snapshot_OnPowerFail(SNAP_SRC_PVD);
+}
+
+static void Snap_OnErased(void *ctx, uint8_t ok) {
+    (void)ctx;
+    snap_erasing = 0;
+    if (ok) snap_next = 0;
+}
+
+uint8_t App_Snapshot_Init(void) {
+    App_Param_Register(snap_params, sizeof(snap_params) / sizeof(snap_params[0]));
+    snap_stat.slot_total = SNAP_SLOTS;
+
+    // 找最新的有效记录, 空位从最后一条已用记录之后开始
+    int best = -1;
+    snap_next = 0;
+    for (uint8_t i = 0; i < SNAP_SLOTS; i++) {
+        if (Snap_SlotErased(i)) continue;
+        snap_next = i + 1u;
+        const SnapRecord_t *r = (const SnapRecord_t *)SNAP_SLOT_ADDR(i);
+        if ((int32_t)(r->seq - snap_seq) >= 0) snap_seq = r->seq + 1u;
+        if (Snap_SlotValid(i) && (best < 0 || (int32_t)(r->seq - ((const SnapRecord_t *)SNAP_SLOT_ADDR(best))->seq) > 0)) {
+            best = i;
+        }
+    }
+
+    uint8_t resumed = 0;
+    if (best >= 0) {
+        memcpy(&snap_rec, (const void *)SNAP_SLOT_ADDR(best), sizeof(snap_rec));
+        Snap_Invalidate((uint8_t)best); // 只恢复一次, 之后未触发快照的断电不会回到旧状态
+        for (uint8_t i = 0; i < MAX_MOTORS; i++) BSP_BLDC_SetPosition(i, snap_rec.pos[i]);
+        if (resume_enable) {
+            Snap_Resume();
+            resumed = 1;
+        }
+        snap_stat.restored = 1;
+        snap_stat.resumed = resumed;
+        Snap_UpdateStat();
+        LOG_INFO("Snapshot restored: slot=%d src=%d pos0=%ld link=%d pc=%u resume=%d\r\n",
+                 best, snap_rec.src, snap_rec.pos[0], snap_rec.link[0].mode, snap_rec.link[0].pc, resumed);
+    }
+    snap_stat.slot_used = snap_next;
+
+    BSP_Power_PvdInit(POWER_PVD_LEVEL, Snap_OnPvd);
+    return resumed;
+}
+
+void App_Snapshot_OnPowerFail(SnapSource_t src) {
+    if (!snap_armed) return;
+    snap_armed = 0;
+    snap_hold = 1;
+
+    // 先记下运动进度再刹车: 降低负载延长维持时间, 同时冻结位置
+    SnapRecord_t *r = &snap_rec;
+    memset(r, 0xFF, sizeof(*r));
+    r->magic = SNAP_MAGIC;
+    r->seq = snap_seq++;
+    r->src = (uint8_t)src;
+    r->motors = MAX_MOTORS;
+    r->vbus_dv = (uint16_t)(g_adc_data.voltage_V * 10.0f);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_GetResume(i, &r->motor[i]);
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) App_Linkage_GetResume(i, &r->link[i]);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Stop(i);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) r->pos[i] = BSP_BLDC_GetPosition(i);
+    r->crc = BSP_Crc_Calc(r, offsetof(SnapRecord_t, crc));
+
+    uint8_t slot = snap_next++;
+    if (BSP_Flash_ProgramUrgent(SNAP_SLOT_ADDR(slot), (const uint16_t *)r, offsetof(SnapRecord_t, state) / 2)) {
+        snap_saved = (int8_t)slot;
+        snap_stat.saves++;
+    } else {
+        snap_stat.failures++;
+    }
+    snap_stat.slot_used = snap_next;
+    Snap_UpdateStat();
+}
+
+void App_Snapshot_Process(void) {
+    if (BSP_Power_PvdLow() || App_Adc_Undervoltage()) {
+        snap_ok_tick = HAL_GetTick();
+        return;
+    }
+    if (HAL_GetTick() - snap_ok_tick < SNAP_ARM_MS) return;
+
+    // 电压跌落后回升 (未掉电): 作废刚写的快照, 按快照续跑被打断的运动
+    if (snap_hold) {
+        int8_t slot = snap_saved;
+        snap_saved = -1;
+        snap_hold = 0;
+        if (slot >= 0) Snap_Invalidate((uint8_t)slot);
+        LOG_WARN("Power recovered without reset, resume=%d\r\n", resume_enable);
+        if (resume_enable) {
+            for (uint8_t i = 0; i < MAX_MOTORS; i++) App_Motor_Resume(i, &snap_rec.motor[i]);
+        } else {
+            App_Linkage_SetMode(LINK_MODE_IDLE, 0);
+        }
+    }
+
+    if (snap_armed || snap_erasing) return;
+    if (snap_next >= SNAP_SLOTS) {
+        // 快照页已写满: 后台擦除, 擦完后再布防
+        FlashJob_t job = { .op = FLASH_JOB_ERASE, .addr = FLASH_SNAP_PAGE_ADDR, .cb = Snap_OnErased };
+        if (FlashJob_Submit(&job)) snap_erasing = 1;
+        return;
+    }
+    snap_armed = 1;
+}
+
+uint8_t App_Snapshot_Holding(void) {
+    return snap_hold;
+}
+
+void App_Snapshot_GetStat(SnapStat_t *stat) {
+    if (!stat) return;
+    *stat = snap_stat;
+    stat->armed = snap_armed;
+    stat->slot_used = snap_next;
+}
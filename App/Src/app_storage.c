@@ -1,71 +1,142 @@
 #include "app_storage.h"
+#include "at_command.h"
+#include "flash_kv.h"
+#include "app_fault.h"
+#include "app_integrity.h"
+#define LOG_MODULE LOG_MOD_STORAGE
+#include "log.h"
 #include <string.h>
+#include <stddef.h>
 
 // 全局配置实例
 AppConfig_t g_Config;
 
+static uint8_t storage_save_pending = 0; // 存储忙, 部分字段尚未写入, 由 App_Storage_Process 重试
+
 // 默认参数配置
 static void SetDefaultConfig(void) {
     g_Config.magic = STORAGE_MAGIC;
     g_Config.device_id = 1;         // 默认ID = 1
-    g_Config.baud_rate = 115200;    // 默认波特率
+    g_Config.baud_rate = AT_BAUD_DEFAULT; // 默认波特率
     g_Config.motor_limit_triggered_val = 0;
+    g_Config.lin_group_mask = 0;    // 默认不加入任何组
+    g_Config.lin_sleep_timeout_s = 0; // 默认不因总线空闲休眠
+    g_Config.lin_master_en = 0;     // 默认仅作从机
+    for (int i = 0; i < LIN_SCHED_MAX; i++) {
+        memset(&g_Config.lin_sched[i], 0, sizeof(LinSchedEntry_t));
+        g_Config.lin_sched[i].id = LIN_SCHED_EMPTY;
+    }
+}
+
+// 配置字段与存储键的对应关系
+// 键一经分配不得复用或修改含义; 新增字段分配新键, 字段长度变化时也应换新键
+typedef struct {
+    uint16_t key;
+    uint16_t offset;
+    uint16_t size;
+} StorageField_t;
+
+#define STORAGE_FIELD(k, member) { (k), offsetof(AppConfig_t, member), sizeof(((AppConfig_t *)0)->member) }
+
+static const StorageField_t storage_fields[] = {
+    STORAGE_FIELD(0x0001, device_id),
+    STORAGE_FIELD(0x0002, baud_rate),
+    STORAGE_FIELD(0x0003, motor_limit_triggered_val),
+    STORAGE_FIELD(0x0004, lin_group_mask),
+    STORAGE_FIELD(0x0005, lin_sleep_timeout_s),
+    STORAGE_FIELD(0x0006, lin_master_en),
+    STORAGE_FIELD(0x0010, lin_sched[0]),
+    STORAGE_FIELD(0x0011, lin_sched[1]),
+    STORAGE_FIELD(0x0012, lin_sched[2]),
+    STORAGE_FIELD(0x0013, lin_sched[3]),
+    STORAGE_FIELD(0x0014, lin_sched[4]),
+    STORAGE_FIELD(0x0015, lin_sched[5]),
+    STORAGE_FIELD(0x0016, lin_sched[6]),
+    STORAGE_FIELD(0x0017, lin_sched[7]),
+};
+#define STORAGE_FIELD_COUNT (sizeof(storage_fields) / sizeof(storage_fields[0]))
+
+// Flash 中已保存的值 (0xFF = 尚未保存), Save 时据此只写有变化的字段
+static AppConfig_t stored_config;
+
+// 越界值恢复默认 (旧版配置没有的字段读到擦除值 0xFF)
+static void SanitizeConfig(void) {
+    if (g_Config.lin_group_mask > 0x0F) g_Config.lin_group_mask = 0;
+    if (g_Config.lin_sleep_timeout_s > STORAGE_SLEEP_TIMEOUT_MAX) g_Config.lin_sleep_timeout_s = 0;
+    if (g_Config.lin_master_en > 1) g_Config.lin_master_en = 0;
+    for (int i = 0; i < LIN_SCHED_MAX; i++) {
+        LinSchedEntry_t *e = &g_Config.lin_sched[i];
+        if (e->id > 0x3F || e->len == 0 || e->len > 8 || e->dir > LIN_SCHED_CMD) e->id = LIN_SCHED_EMPTY;
+    }
+}
+
+// 旧版整页配置没有校验和, 仅凭魔数不能排除损坏; 取值明显不合理时整页丢弃, 不迁移
+// (旧版较早的配置缺少后加的字段, 这些位置为擦除值 0xFF)
+static uint8_t Storage_LegacyPlausible(const AppConfig_t *c) {
+    if (c->device_id == 0 || c->device_id > 0xFF) return 0;
+    if (c->baud_rate != 0 && c->baud_rate != 0xFFFFFFFFu && !AT_IsValidBaudRate(c->baud_rate)) return 0;
+    if (c->lin_group_mask != 0xFFFFFFFFu && c->lin_group_mask > 0x0F) return 0;
+    if (c->lin_master_en != 0xFFFFFFFFu && c->lin_master_en > 1) return 0;
+    return 1;
 }
 
 // 初始化: 从Flash加载参数
 void App_Storage_Init(void) {
-    AppConfig_t *pStoredConfig = (AppConfig_t *)STORAGE_FLASH_PAGE_ADDR;
-
-    // 检查魔数
-    if (pStoredConfig->magic == STORAGE_MAGIC) {
-        // 有效数据，从Flash拷贝到RAM
-        memcpy(&g_Config, pStoredConfig, sizeof(AppConfig_t));
-    } else {
-        // 第一次使用或Flash损坏，加载默认并保存
-        SetDefaultConfig();
-        App_Storage_Save();
+    const AppConfig_t *legacy = (const AppConfig_t *)STORAGE_LEGACY_ADDR;
+
+    SetDefaultConfig();
+    memset(&stored_config, 0xFF, sizeof(stored_config));
+    FlashKV_Init();
+
+    // 存储页 1 被首次整理擦除之前, 旧版整页配置仍可读
+    uint8_t has_legacy = (legacy->magic == STORAGE_MAGIC);
+    if (has_legacy && !Storage_LegacyPlausible(legacy)) {
+        has_legacy = 0;
+        App_Fault_Report(FAULT_CRC, 0, INTEG_SRC_CONFIG); // 故障历史尚未初始化也可上报, 由主循环写入
+        LOG_ERROR("Legacy config page corrupted, ignored\r\n");
     }
-}
+    for (uint32_t i = 0; i < STORAGE_FIELD_COUNT; i++) {
+        const StorageField_t *f = &storage_fields[i];
+        uint8_t *cur = (uint8_t *)&g_Config + f->offset;
+        uint8_t *sto = (uint8_t *)&stored_config + f->offset;
 
-// 保存当前 RAM 中的 g_Config 到 Flash
-void App_Storage_Save(void) {
-    HAL_StatusTypeDef status;
-    FLASH_EraseInitTypeDef EraseInitStruct;
-    uint32_t PageError = 0;
-
-    // 1. 解锁 Flash
-    HAL_FLASH_Unlock();
-
-    // 2. 擦除最后一页
-    EraseInitStruct.TypeErase   = FLASH_TYPEERASE_PAGES;
-    EraseInitStruct.PageAddress = STORAGE_FLASH_PAGE_ADDR;
-    EraseInitStruct.NbPages     = 1;
-
-    status = HAL_FLASHEx_Erase(&EraseInitStruct, &PageError);
-    if (status != HAL_OK) {
-        // 错误处理: 可通过 LOG 打印 Error Code
-        HAL_FLASH_Lock();
-        return;
+        if (FlashKV_Read(f->key, sto, f->size) == f->size) {
+            memcpy(cur, sto, f->size);
+        } else {
+            memset(sto, 0xFF, f->size); // 长度不符视为不存在
+            if (has_legacy) memcpy(cur, (const uint8_t *)legacy + f->offset, f->size);
+        }
     }
+    SanitizeConfig();
+
+    // 迁移旧版配置 / 补齐缺失字段 / 写回修正值; 正常上电无变化, 不写 Flash
+    App_Storage_Save();
+}
 
-    // 3. 编程 (写入)
-    // Flash 必须按 Word (32-bit) 或 Half-Word 写入。这里按 Word 写入。
-    uint32_t *pSource = (uint32_t *)&g_Config;
-    uint32_t DestAddr = STORAGE_FLASH_PAGE_ADDR;
-    uint32_t WordsToWrite = (sizeof(AppConfig_t) + 3) / 4; // 向上取整
+// 保存当前 RAM 中的 g_Config 到 Flash (每个有变化的字段追加一条记录)
+void App_Storage_Save(void) {
+    for (uint32_t i = 0; i < STORAGE_FIELD_COUNT; i++) {
+        const StorageField_t *f = &storage_fields[i];
+        const uint8_t *cur = (const uint8_t *)&g_Config + f->offset;
+        uint8_t *sto = (uint8_t *)&stored_config + f->offset;
 
-    for (uint32_t i = 0; i < WordsToWrite; i++) {
-        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, DestAddr, *pSource);
-        if (status != HAL_OK) {
-            // 写入错误
+        if (memcmp(cur, sto, f->size) == 0) continue;
+        FlashKvResult_t res = FlashKV_Write(f->key, cur, f->size);
+        if (res == FLASH_KV_OK) {
+            memcpy(sto, cur, f->size);
+        } else if (res == FLASH_KV_BUSY) {
+            storage_save_pending = 1;
             break;
+        } else {
+            LOG_ERROR("Config save failed, key=0x%04x\r\n", f->key);
         }
-        DestAddr += 4;
-        pSource++;
     }
+}
 
-    // 4. 上锁
-    HAL_FLASH_Lock();
+void App_Storage_Process(void) {
+    if (!storage_save_pending || FlashKV_Busy()) return;
+    storage_save_pending = 0;
+    App_Storage_Save();
 }
 
 // 修改参数接口示例: Set ID
@@ -76,6 +147,22 @@ void App_Storage_SetDeviceID(uint8_t id) {
     }
 }
 
+void App_Storage_SetLinGroups(uint8_t mask) {
+    mask &= 0x0F;
+    if (g_Config.lin_group_mask != mask) {
+        g_Config.lin_group_mask = mask;
+        App_Storage_Save();
+    }
+}
+
+void App_Storage_SetLinSleepTimeout(uint32_t sec) {
+    if (sec > STORAGE_SLEEP_TIMEOUT_MAX) sec = STORAGE_SLEEP_TIMEOUT_MAX;
+    if (g_Config.lin_sleep_timeout_s != sec) {
+        g_Config.lin_sleep_timeout_s = sec;
+        App_Storage_Save();
+    }
+}
+
 // 恢复出厂
 void App_Storage_ResetFactory(void) {
     SetDefaultConfig();
@@ -29,7 +29,11 @@ typedef struct {
 
 // 2. 运行时状态结构体 (变量)
 typedef struct {
-    volatile int32_t pulse_count; // 累计脉冲数
+    volatile int32_t pulse_count; // 累计脉冲数 (不分方向, 相对运动用)
+    volatile int32_t position;    // 绝对位置 (按方向加减, 掉电快照保存)
+    uint8_t dir;                  // 当前方向 (MotorDir_t)
+    volatile uint32_t last_fg_us;   // 最近一次 FG 边沿时刻 (us, 低32位)
+    volatile uint32_t fg_period_us; // 最近两次 FG 边沿间隔 (us), 可换算转速
     uint16_t current_duty;        // 当前占空比 (0-1000)
     uint8_t is_braking;           // 刹车状态
 } BLDC_State_t;
@@ -50,6 +54,9 @@ void BSP_BLDC_SetDir(uint8_t id, MotorDir_t dir);
 void BSP_BLDC_Brake(uint8_t id, uint8_t enable);
 int32_t BSP_BLDC_GetPulse(uint8_t id);
 void BSP_BLDC_ResetPulse(uint8_t id);
+// 绝对位置: 正转加、反转减; 上电由掉电快照恢复, 回零后可用 SetPosition 校准
+int32_t BSP_BLDC_GetPosition(uint8_t id);
+void BSP_BLDC_SetPosition(uint8_t id, int32_t pos);
 
 // 在 GPIO EXTI 中断中调用此函数
 void BSP_BLDC_OnFG_Interrupt(uint16_t GPIO_Pin);
@@ -12,6 +12,16 @@
 #define MOTOR_TIM_HANDLE        htim4
 extern TIM_HandleTypeDef        MOTOR_TIM_HANDLE;
 
+// 电机0 限位开关 (低/高电平触发由参数 LIMIT0 选择, 0 = 不检测)
+#define MOTOR0_LIMIT_CW_PORT    GPIOA
+#define MOTOR0_LIMIT_CW_PIN     GPIO_PIN_0
+#define MOTOR0_LIMIT_CCW_PORT   GPIOA
+#define MOTOR0_LIMIT_CCW_PIN    GPIO_PIN_1
+
+// 联动程序 SET_OUT 指令可操作的输出脚 (按索引, 见 app_linkvm.h)
+// 示例只有板载指示灯, TIM3 心跳也在翻转它; 接入实际执行器 (气缸阀、指示灯) 后在此追加
+#define LINK_OUT_TABLE          { { LED_01_GPIO_Port, LED_01_Pin } }
+
 // --- 采样相关 ---
 // 基础定时器 (10kHz心跳)
 #define BASE_TIM_HANDLE         htim3
@@ -31,5 +41,25 @@ extern UART_HandleTypeDef       LOG_UART_HANDLE;
 // LIN 总线串口
 #define LIN_UART_HANDLE         huart3
 extern UART_HandleTypeDef       LIN_UART_HANDLE;
+#define LIN_BAUD_NOMINAL        19200
+
+// LIN 自动波特率: TIM2_CH4 输入捕获 (部分重映射2 -> PB11, 与 USART3_RX 同脚)
+#define LIN_AUTOBAUD_TIM        TIM2
+#define LIN_AUTOBAUD_IRQn       TIM2_IRQn
+
+// 掉电预警: VDD 跌破该阈值时写掉电快照 (Flash 编程需 VDD >= 2.0V, 留出稳压器维持时间)
+#define POWER_PVD_LEVEL         PWR_PVDLEVEL_7 // 2.9V
+
+// --- Flash 分区 (页大小 FLASH_PAGE_SIZE = 1KB) ---
+// 以下区域位于 Flash 末尾, 链接脚本 STM32F103C8Tx_FLASH_fixed.ld 的 FLASH LENGTH 已相应缩减
+#define FLASH_APP_END           0x0800E400 // 程序区结束: 镜像及其末尾的 CRC 须在此之前 (Tools/fw_crc.py --limit)
+#define FLASH_PROG_SLOT0_ADDR   0x0800E400 // 联动程序槽 (每槽一页, 见 app_linkprog.h)
+#define FLASH_PROG_SLOT1_ADDR   0x0800E800
+#define FLASH_FAULT_PAGE0_ADDR  0x0800EC00 // 故障历史 (两页环形, 见 app_fault.h)
+#define FLASH_FAULT_PAGE1_ADDR  0x0800F000
+#define FLASH_SNAP_PAGE_ADDR    0x0800F400 // 掉电快照 (保持擦除状态, 见 app_snapshot.h)
+#define FLASH_KV_PAGE0_ADDR     0x0800F800 // 配置存储 (两页交替, 见 flash_kv.h)
+#define FLASH_KV_PAGE1_ADDR     0x0800FC00
+#define FLASH_KV_PAGE_SIZE      FLASH_PAGE_SIZE
 
 #endif
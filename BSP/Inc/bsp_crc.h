@@ -0,0 +1,54 @@
+#ifndef BSP_CRC_H
+#define BSP_CRC_H
+
+#include "main.h"
+
+// CRC 服务 (片内 CRC 外设 + DMA 送数, 无外设时软件计算)
+//
+// 算法与 F1 CRC 外设一致 (CRC-32/MPEG-2): 多项式 0x04C11DB7, 初值 0xFFFFFFFF, 不反射, 结果不取反,
+// 数据按 32 位字 (小端读出) 从最高位开始处理. 长度不是 4 的倍数时, 末尾不足一字的字节以 0xFF 补齐
+// (与擦除状态的 Flash 一致). Tools/fw_crc.py 使用同一算法.
+//
+// 计算途径:
+//   DMA: DMA 存储器到存储器通道把字写入 CRC->DR, CPU 等待传输完成 (源地址须 4 字节对齐)
+//   CPU: CPU 逐字写入 CRC->DR (短数据 / 未对齐)
+//   SW:  查表软件计算 (主机构建 / 外设正被占用, 如掉电快照中断打断了主循环的计算)
+// F1 的 CRC 外设不能装入任意初值, 分段续算只能走软件途径 (BSP_Crc_Software).
+#define BSP_CRC_INIT        0xFFFFFFFFu
+#define BSP_CRC_DMA_MIN     64             // 不短于该长度且对齐时用 DMA
+#define BSP_CRC_DMA_CH      DMA1_Channel2  // 存储器到存储器, 无外设请求, 不占用中断
+#define BSP_CRC_DMA_TC      DMA_ISR_TCIF2
+#define BSP_CRC_DMA_TE      DMA_ISR_TEIF2
+#define BSP_CRC_DMA_CLEAR   DMA_IFCR_CGIF2
+
+#if defined(CRC) && !defined(BSP_CRC_SOFTWARE)
+#define BSP_CRC_HW          1
+#else
+#define BSP_CRC_HW          0
+#endif
+
+typedef enum {
+    BSP_CRC_PATH_AUTO = 0,
+    BSP_CRC_PATH_DMA,
+    BSP_CRC_PATH_CPU,
+    BSP_CRC_PATH_SW,
+} BSP_CrcPath_t;
+
+typedef struct {
+    uint32_t dma_calls;
+    uint32_t cpu_calls;
+    uint32_t sw_calls;
+    uint32_t busy_fallbacks; // 外设被占用改走软件的次数
+    uint32_t dma_errors;     // DMA 传输错误 (已改用 CPU 重算)
+} BSP_CrcStat_t;
+
+void BSP_Crc_Init(void);
+// 计算 data[0..len) 的 CRC (可在中断中调用)
+uint32_t BSP_Crc_Calc(const void *data, uint32_t len);
+// 指定计算途径 (测速用); 无外设时 DMA / CPU 途径退化为软件计算
+uint32_t BSP_Crc_CalcPath(const void *data, uint32_t len, BSP_CrcPath_t path);
+// 软件计算, 从 crc 继续 (首段传 BSP_CRC_INIT); 分段时除最后一段外长度须为 4 的倍数
+uint32_t BSP_Crc_Software(uint32_t crc, const void *data, uint32_t len);
+void BSP_Crc_GetStat(BSP_CrcStat_t *stat);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef BSP_FLASH_H
+#define BSP_FLASH_H
+
+#include "main.h"
+
+// 片内 Flash 编程 / 页擦除
+// F1 为单 Bank: 擦除一页约 20~40ms, 期间 CPU 从 Flash 取指 (含中断向量) 全部停顿.
+// 页擦除因此在 RAM 中执行并关中断等待, 等待期间运行 RAM 中的安全守护:
+//   - 到达截止时刻 (定时运行) / 电流超限 / 限位开关触发 / PVD 掉电预警时直接写寄存器停机 (PWM 比较值清零 + 刹车)
+//   - 轮询 FG 引脚计上升沿, 开中断前补加到脉冲计数与位置 (EXTI 挂起位只能记住一个沿)
+//   - 维持 HAL 毫秒计数 (SysTick) 与微秒时基 (TIM3 更新事件, bsp_time.h)
+// 其余中断挂起, 擦除结束后按优先级补执行: 串口在此期间可能溢出, 掉电快照与 AT+STOP 最多延后一次擦除.
+
+// 放入 RAM 的函数 (链接脚本 .data 段收集 .RamFunc, 启动代码随 .data 一起拷贝)
+#define BSP_RAMFUNC __attribute__((section(".RamFunc"), noinline, long_call))
+
+#define BSP_FLASH_GUARD_MAX      4 // 一次擦除最多的守护条目
+
+// 擦除期间守护动作
+#define BSP_FLASH_TRIP_NONE      0
+#define BSP_FLASH_TRIP_DEADLINE  1 // 到达截止时刻
+#define BSP_FLASH_TRIP_CURRENT   2 // 电流 ADC 原始值超限
+#define BSP_FLASH_TRIP_LIMIT     3 // 限位开关触发
+#define BSP_FLASH_TRIP_POWER     4 // PVD 掉电预警 (快照在擦除后补执行)
+
+typedef struct {
+    volatile uint32_t *pwm_ccr;          // 停机: 写 0
+    volatile uint32_t *brake_bsrr;       // 停机: 写 brake_bits (NULL = 无刹车脚)
+    uint32_t brake_bits;
+    uint8_t  use_deadline;
+    uint32_t deadline_us;                // 到期时刻 (BSP_Time_GetUs 低 32 位)
+    volatile const uint16_t *cur_raw;    // 电流 ADC 原始值 (DMA 持续更新), NULL = 不检测
+    uint16_t cur_limit;
+    volatile const uint32_t *limit_idr;  // 限位开关所在端口 IDR, NULL = 不检测
+    uint16_t limit_mask;
+    uint16_t limit_level;                // 触发时 (IDR & limit_mask) 的值
+    uint8_t  use_pvd;                    // PVD 输出置位时停机
+    volatile const uint32_t *fg_idr;     // FG 所在端口 IDR, NULL = 不计数 (pwm_ccr 可为 NULL: 只计滑行脉冲)
+    uint16_t fg_mask;                    // FG 引脚, 同时是其 EXTI 线
+    volatile int32_t *fg_count;          // 补计目标: 脉冲计数
+    volatile int32_t *fg_pos;            // 补计目标: 绝对位置, 每沿加 fg_step
+    int8_t   fg_step;
+    uint16_t fg_edges;                   // 擦除期间计到的上升沿数 (已补计)
+    uint8_t  tripped;                    // 擦除期间执行了停机: BSP_FLASH_TRIP_xxx
+} BSP_FlashGuard_t;
+
+// 以下操作要求 Flash 已解锁 (HAL_FLASH_Unlock)
+// 编程一个半字并回读校验, 约 50us (期间取指停顿), 成功返回 1
+uint8_t BSP_Flash_ProgramHalf(uint32_t addr, uint16_t data);
+// 擦除 addr 所在页, guard 可为 NULL; 成功返回 1
+uint8_t BSP_Flash_ErasePage(uint32_t addr, BSP_FlashGuard_t *guard, uint8_t count);
+// 中断中调用: 1 = 当前正在补执行擦除期间挂起的中断 (此时的串口溢出等是擦除造成的预期丢失)
+uint8_t BSP_Flash_EraseBacklog(void);
+
+// 掉电快照等中断上下文中使用: 寄存器级编程 count 个半字, 不经 HAL 锁, 不要求预先解锁.
+// 可打断主循环中进行的 HAL 编程 (保存并恢复 LOCK / PG 位); 目标须已擦除, 成功返回 1
+uint8_t BSP_Flash_ProgramUrgent(uint32_t addr, const uint16_t *data, uint16_t count);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef BSP_LIN_BAUD_H
+#define BSP_LIN_BAUD_H
+
+#include "main.h"
+
+// LIN 自动波特率同步
+// 主机与本机 (HSI) 时钟均存在漂移, 每帧在 Break 之后用定时器输入捕获测量 Sync 字段 (0x55)
+// 5 个下降沿跨越 8 个位时间, 据此重算 USART BRR
+#define LIN_AUTOBAUD_EDGES      5
+#define LIN_AUTOBAUD_TOL_PCT    15  // 超出标称波特率 ±15% 的测量视为无效
+
+typedef struct {
+    uint32_t baud;         // 当前使用的波特率
+    int32_t  dev_ppm;      // 最近一次测量相对标称值的偏差 (ppm)
+    int32_t  dev_min_ppm;  // 偏差最小值
+    int32_t  dev_max_ppm;  // 偏差最大值
+    uint32_t syncs;        // 成功同步次数
+    uint32_t rejects;      // 测量超差被丢弃次数
+} LinBaudStat_t;
+
+void BSP_LinBaud_Init(void);
+// 在 LBD (Break 检测) 中断中调用, 开始捕获本帧 Sync 字段
+void BSP_LinBaud_Arm(void);
+// 本帧是否已按 Sync 字段完成同步 (Sync 字节本身可能因中途改 BRR 读数异常)
+uint8_t BSP_LinBaud_Synced(void);
+// 在 TIM2_IRQHandler 中调用
+void BSP_LinBaud_IRQHandler(void);
+void BSP_LinBaud_GetStat(LinBaudStat_t *stat);
+
+#endif
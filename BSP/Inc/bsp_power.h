@@ -0,0 +1,24 @@
+#ifndef BSP_POWER_H
+#define BSP_POWER_H
+
+#include "main.h"
+
+// MCU Stop 模式与唤醒源
+// 唤醒引脚保持 USART 复用输入配置, EXTI 并行检测下降沿 (总线显性 / 串口起始位)
+#define BSP_WAKE_LIN    (1u << 0)  // PB11 (USART3_RX, EXTI11): LIN 总线显性, TJA1021 唤醒后 RXD 拉低
+#define BSP_WAKE_AT     (1u << 1)  // PA10 (USART1_RX, EXTI10): 调试串口 (唤醒字符丢失)
+
+// 进入 Stop 模式 (低功耗稳压器), 直到 wake_mask 中任一唤醒源触发
+// 返回时已恢复 PLL 系统时钟与 SysTick, 返回值为实际唤醒源
+uint8_t BSP_Power_EnterStop(uint8_t wake_mask);
+// 在 EXTI15_10_IRQHandler 中调用
+void BSP_Power_WakeIRQHandler(void);
+
+// 电源电压检测 (PVD): VDD 跌破 PWR_PVDLEVEL_x 时在中断中调用 on_low (最高优先级, 尽快完成)
+// 电压回升不产生回调, 用 BSP_Power_PvdLow() 查询
+void BSP_Power_PvdInit(uint32_t level, void (*on_low)(void));
+uint8_t BSP_Power_PvdLow(void);
+// 在 PVD_IRQHandler 中调用
+void BSP_Power_PvdIRQHandler(void);
+
+#endif
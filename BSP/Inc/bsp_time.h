@@ -0,0 +1,79 @@
+#ifndef BSP_TIME_H
+#define BSP_TIME_H
+
+#include "main.h"
+
+// 64 位单调微秒时基
+// 计数源: TIM3 (1MHz 计数, 100us 更新), 时刻 = 更新事件累计 + CNT;
+// 注意: Stop 模式下 TIM3 停止, 时基不前进; Sleep 模式 (主循环 WFI) 下照常计数
+//
+// 微秒闹钟: 使用 TIM3 的 4 个比较通道 (1MHz 计数), 到期在中断上下文中回调,
+// 精度约 1us (TIM3 节拍只负责把临近到期的闹钟装入比较寄存器)
+#define BSP_TIME_ALARM_COUNT     4
+#define BSP_TIME_ALARM_MOTOR(id) (id)  // 通道 0..MAX_MOTORS-1: 电机定时运行
+#define BSP_TIME_ALARM_LIN       2     // 通道 2: LIN 主机调度表时隙
+#define BSP_TIME_ALARM_EVENT     3     // 通道 3: 事件总线定时器 (event_bus.h)
+#define BSP_TIME_TICK_US         100u  // TIM3 更新周期, 与 tim.c 中 Period + 1 一致
+
+typedef void (*BSP_TimeAlarmCb_t)(uint8_t arg);
+
+void BSP_Time_Init(void);
+uint64_t BSP_Time_GetUs(void);
+uint32_t BSP_Time_GetUs32(void); // 低 32 位, 适合做差 (约 71 分钟回绕)
+
+// 最近一次更新事件的时刻; 只供关中断长时间等待的 RAM 代码 (Flash 页擦除) 使用, 其余模块用 BSP_Time_GetUs
+extern volatile uint64_t bsp_time_us_base;
+
+// 关中断期间代替更新中断推进时基, 返回当前时刻低 32 位. 须在中断关闭时调用; 强制内联, 可用于 RAM 函数
+static inline __attribute__((always_inline)) uint32_t BSP_Time_PollUs32(TIM_TypeDef *tim) {
+    uint32_t cnt = tim->CNT;
+    if (tim->SR & TIM_SR_UIF) {
+        cnt = tim->CNT;
+        tim->SR = (uint32_t)~TIM_SR_UIF;
+        bsp_time_us_base += BSP_TIME_TICK_US;
+    }
+    return (uint32_t)bsp_time_us_base + cnt;
+}
+
+/**
+ * @brief 设置微秒闹钟 (覆盖该通道原有闹钟)
+ * @param ch 通道 0~BSP_TIME_ALARM_COUNT-1
+ * @param when_us 到期时刻 (BSP_Time_GetUs 时基); 已过期则在下一个节拍内回调
+ * @param cb 回调 (中断上下文)
+ * @param arg 回调参数
+ */
+void BSP_Time_SetAlarm(uint8_t ch, uint64_t when_us, BSP_TimeAlarmCb_t cb, uint8_t arg);
+void BSP_Time_CancelAlarm(uint8_t ch);
+
+// 总线时间: 由主机时间同步帧校准的公共时基 (主机本地时基即总线时间)
+// bus = m0 + (local - l0) * (1 + drift)
+// 每次同步以 (本地 Break 时刻, 主机 Break 时刻) 为锚点, 相邻两次同步估计频偏
+#define BSP_TIME_SYNC_STEP_US    10000 // 预测误差超过该值视为时基跳变, 重新锚定并清零频偏
+#define BSP_TIME_SYNC_MAX_PPM    50000 // 频偏估计上限 (HSI 最大偏差 ±5%)
+
+typedef struct {
+    uint8_t  valid;       // 至少完成一次同步
+    uint32_t syncs;       // 同步次数
+    uint32_t steps;       // 重新锚定次数
+    int64_t  offset_us;   // 当前 bus - local
+    int32_t  drift_ppm;   // 本地相对主机的频偏修正 (ppm)
+    int32_t  last_err_us; // 最近一次同步的预测误差 (bus 实际 - bus 预测)
+    int32_t  max_err_us;  // 锚定后最大预测误差 (绝对值)
+    uint64_t last_sync_us;// 最近一次同步的本地时刻
+} BSP_TimeSyncStat_t;
+
+// 同步样本: 同一 Break 的本地时刻与主机时刻 (主循环调用)
+void BSP_Time_SyncSample(uint64_t local_us, uint64_t bus_us);
+uint8_t BSP_Time_SyncValid(void);
+uint64_t BSP_Time_LocalToBus(uint64_t local_us);
+uint64_t BSP_Time_BusToLocal(uint64_t bus_us);
+uint64_t BSP_Time_GetBusUs(void);
+void BSP_Time_GetSyncStat(BSP_TimeSyncStat_t *stat);
+
+// 在 TIM3 中断中调用: OnUpdate 放在 HAL_TIM_IRQHandler 之前, 返回 1 时由调用方执行更新回调;
+// OnTick 在更新回调中最先执行, OnCompare 在比较回调中执行
+uint8_t BSP_Time_OnUpdate(void);
+void BSP_Time_OnTick(void);
+void BSP_Time_OnCompare(uint8_t ch);
+
+#endif
@@ -1,5 +1,6 @@
 #include "bsp_bldc.h"
 #include "bsp_conf.h" // 引用统一配置
+#include "bsp_time.h"
 
 BLDC_Handle_t motors[MAX_MOTORS];
 
@@ -37,6 +38,7 @@ void BSP_BLDC_SetSpeed(uint8_t id, uint16_t duty) {
 
 void BSP_BLDC_SetDir(uint8_t id, MotorDir_t dir) {
     if(id >= MAX_MOTORS) return;
+    motors[id].state.dir = (uint8_t)dir;
     HAL_GPIO_WritePin(motors[id].config.dir_port, motors[id].config.dir_pin, 
                       (dir == MOTOR_DIR_CW) ? GPIO_PIN_SET : GPIO_PIN_RESET);
 }
@@ -59,12 +61,26 @@ void BSP_BLDC_ResetPulse(uint8_t id) {
     motors[id].state.pulse_count = 0;
 }
 
+int32_t BSP_BLDC_GetPosition(uint8_t id) {
+    if(id >= MAX_MOTORS) return 0;
+    return motors[id].state.position;
+}
+
+void BSP_BLDC_SetPosition(uint8_t id, int32_t pos) {
+    if(id >= MAX_MOTORS) return;
+    motors[id].state.position = pos;
+}
+
 // 统一的FG中断处理
 void BSP_BLDC_OnFG_Interrupt(uint16_t GPIO_Pin) {
+    uint32_t now = BSP_Time_GetUs32();
     for(int i = 0; i < MAX_MOTORS; i++) {
         if(GPIO_Pin == motors[i].config.fg_pin) {
             motors[i].state.pulse_count++;
-            // 如果需要根据方向加减计数，可在此处读取 DIR 引脚状态判断
+            // 按方向输出累加绝对位置 (停车惯性滑行期间方向不变)
+            motors[i].state.position += (motors[i].state.dir == MOTOR_DIR_CW) ? 1 : -1;
+            motors[i].state.fg_period_us = now - motors[i].state.last_fg_us;
+            motors[i].state.last_fg_us = now;
         }
     }
 }
@@ -0,0 +1,136 @@
+#include "bsp_crc.h"
+#include <string.h>
+
+// 半字节查表 (16 项, 64 字节): crc_nibble[i] = i << 28 移出 4 位后的余式
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+    0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+};
+
+static BSP_CrcStat_t crc_stat;
+
+uint32_t BSP_Crc_Software(uint32_t crc, const void *data, uint32_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len) {
+        uint32_t w = 0xFFFFFFFFu;
+        uint32_t n = (len < 4u) ? len : 4u;
+        memcpy(&w, p, n);
+        crc ^= w;
+        for (int i = 0; i < 8; i++) crc = (crc << 4) ^ crc_nibble[crc >> 28];
+        p += n;
+        len -= n;
+    }
+    return crc;
+}
+
+#if BSP_CRC_HW
+static volatile uint8_t crc_busy = 0;
+
+// 外设同一时刻只能算一组数据; 被占用 (中断打断了主循环的计算) 时调用方改走软件
+static uint8_t Crc_Acquire(void) {
+    uint32_t primask = __get_PRIMASK();
+    uint8_t ok;
+    __disable_irq();
+    ok = !crc_busy;
+    if (ok) crc_busy = 1;
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+static void Crc_FeedCpu(const uint8_t *p, uint32_t len) {
+    if (((uint32_t)p & 3u) == 0) {
+        const uint32_t *w = (const uint32_t *)p;
+        for (; len >= 4u; len -= 4u) CRC->DR = *w++;
+        p = (const uint8_t *)w;
+    } else {
+        for (; len >= 4u; len -= 4u, p += 4) {
+            uint32_t w;
+            memcpy(&w, p, 4);
+            CRC->DR = w;
+        }
+    }
+    if (len) {
+        uint32_t w = 0xFFFFFFFFu;
+        memcpy(&w, p, len);
+        CRC->DR = w;
+    }
+}
+
+// 存储器到存储器: 源 (CMAR, 递增) -> CRC->DR (CPAR, 固定), 32 位; CNDTR 每次最多 65535 字
+static uint8_t Crc_FeedDma(const uint32_t *p, uint32_t words) {
+    while (words) {
+        uint32_t n = (words > 0xFFFFu) ? 0xFFFFu : words;
+        uint32_t isr;
+
+        BSP_CRC_DMA_CH->CCR = 0;
+        DMA1->IFCR = BSP_CRC_DMA_CLEAR;
+        BSP_CRC_DMA_CH->CPAR = (uint32_t)&CRC->DR;
+        BSP_CRC_DMA_CH->CMAR = (uint32_t)p;
+        BSP_CRC_DMA_CH->CNDTR = n;
+        BSP_CRC_DMA_CH->CCR = DMA_CCR_MEM2MEM | DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1
+                            | DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN;
+        while (!((isr = DMA1->ISR) & (BSP_CRC_DMA_TC | BSP_CRC_DMA_TE))) { }
+        BSP_CRC_DMA_CH->CCR = 0;
+        DMA1->IFCR = BSP_CRC_DMA_CLEAR;
+        if (isr & BSP_CRC_DMA_TE) return 0;
+
+        p += n;
+        words -= n;
+    }
+    return 1;
+}
+#endif
+
+void BSP_Crc_Init(void) {
+#if BSP_CRC_HW
+    __HAL_RCC_CRC_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    BSP_CRC_DMA_CH->CCR = 0;
+#endif
+    memset(&crc_stat, 0, sizeof(crc_stat));
+}
+
+uint32_t BSP_Crc_CalcPath(const void *data, uint32_t len, BSP_CrcPath_t path) {
+#if BSP_CRC_HW
+    const uint8_t *p = (const uint8_t *)data;
+    uint8_t aligned = (((uint32_t)p & 3u) == 0);
+
+    if (path == BSP_CRC_PATH_AUTO) path = (aligned && len >= BSP_CRC_DMA_MIN) ? BSP_CRC_PATH_DMA : BSP_CRC_PATH_CPU;
+    if (path == BSP_CRC_PATH_DMA && (!aligned || len < 4u)) path = BSP_CRC_PATH_CPU;
+    if (path != BSP_CRC_PATH_SW) {
+        if (Crc_Acquire()) {
+            CRC->CR = CRC_CR_RESET;
+            if (path == BSP_CRC_PATH_DMA) {
+                uint32_t words = len / 4u;
+                if (Crc_FeedDma((const uint32_t *)p, words)) {
+                    Crc_FeedCpu(p + words * 4u, len - words * 4u);
+                    crc_stat.dma_calls++;
+                } else {
+                    crc_stat.dma_errors++;
+                    CRC->CR = CRC_CR_RESET;
+                    Crc_FeedCpu(p, len);
+                }
+            } else {
+                Crc_FeedCpu(p, len);
+                crc_stat.cpu_calls++;
+            }
+            uint32_t crc = CRC->DR;
+            crc_busy = 0;
+            return crc;
+        }
+        crc_stat.busy_fallbacks++;
+    }
+#else
+    (void)path;
+#endif
+    crc_stat.sw_calls++;
+    return BSP_Crc_Software(BSP_CRC_INIT, data, len);
+}
+
+uint32_t BSP_Crc_Calc(const void *data, uint32_t len) {
+    return BSP_Crc_CalcPath(data, len, BSP_CRC_PATH_AUTO);
+}
+
+void BSP_Crc_GetStat(BSP_CrcStat_t *stat) {
+    *stat = crc_stat;
+}
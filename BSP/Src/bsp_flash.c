@@ -0,0 +1,123 @@
+#include "bsp_flash.h"
+#include "bsp_conf.h"
+#include "bsp_time.h"
+
+static volatile uint8_t flash_erase_backlog = 0; // 擦除结束, 正在补执行期间挂起的中断
+
+uint8_t BSP_Flash_ProgramHalf(uint32_t addr, uint16_t data) {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, data) != HAL_OK) return 0;
+    return *(const volatile uint16_t *)addr == data;
+}
+
+uint8_t BSP_Flash_ProgramUrgent(uint32_t addr, const uint16_t *data, uint16_t count) {
+    uint32_t primask = __get_PRIMASK();
+    uint8_t ok = 1;
+
+    __disable_irq();
+    while (FLASH->SR & FLASH_SR_BSY) { } // 主循环的半字编程先完成
+    uint32_t cr = FLASH->CR;
+    if (cr & FLASH_CR_LOCK) {
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+    FLASH->CR |= FLASH_CR_PG;
+    for (uint16_t i = 0; i < count && ok; i++) {
+        volatile uint16_t *dst = (volatile uint16_t *)(addr + 2u * i);
+        *dst = data[i];
+        while (FLASH->SR & FLASH_SR_BSY) { }
+        if ((FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) || *dst != data[i]) ok = 0;
+        FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+    }
+    if (!(cr & FLASH_CR_PG)) FLASH->CR &= ~FLASH_CR_PG;
+    if (cr & FLASH_CR_LOCK) FLASH->CR |= FLASH_CR_LOCK;
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+// 守护检查 (RAM): 只访问寄存器与 RAM, 不调用 Flash 中的函数
+// fg_last: 各条目 FG 电平的上次采样
+static inline __attribute__((always_inline)) void Flash_GuardPoll(BSP_FlashGuard_t *guard, uint8_t count, uint16_t *fg_last,
+                                                                   uint32_t now_us) {
+    for (uint8_t i = 0; i < count; i++) {
+        BSP_FlashGuard_t *g = &guard[i];
+        if (g->fg_idr) { // 停机后仍在滑行, 计数不受 tripped 影响
+            uint16_t lvl = (uint16_t)(*g->fg_idr & g->fg_mask);
+            if (lvl && !fg_last[i]) g->fg_edges++; // 与 EXTI 相同: 上升沿
+            fg_last[i] = lvl;
+        }
+        if (g->tripped) continue;
+
+        uint8_t trip = BSP_FLASH_TRIP_NONE;
+        if (g->use_deadline && (int32_t)(now_us - g->deadline_us) >= 0) {
+            trip = BSP_FLASH_TRIP_DEADLINE;
+        } else if (g->cur_raw && *g->cur_raw > g->cur_limit) {
+            trip = BSP_FLASH_TRIP_CURRENT;
+        } else if (g->limit_idr && (*g->limit_idr & g->limit_mask) == g->limit_level) {
+            trip = BSP_FLASH_TRIP_LIMIT;
+        } else if (g->use_pvd && (PWR->CSR & PWR_CSR_PVDO)) {
+            trip = BSP_FLASH_TRIP_POWER;
+        }
+        if (trip) {
+            if (g->pwm_ccr) *g->pwm_ccr = 0;
+            if (g->brake_bsrr) *g->brake_bsrr = g->brake_bits;
+            g->tripped = trip;
+        }
+    }
+}
+
+BSP_RAMFUNC uint8_t BSP_Flash_ErasePage(uint32_t addr, BSP_FlashGuard_t *guard, uint8_t count) {
+    uint32_t primask = __get_PRIMASK();
+    uint32_t ticks = 0;
+    TIM_TypeDef *tim = BASE_TIM_HANDLE.Instance;
+    uint16_t fg_last[BSP_FLASH_GUARD_MAX];
+    uint16_t fg_pend[BSP_FLASH_GUARD_MAX];
+    if (!guard) count = 0;
+    if (count > BSP_FLASH_GUARD_MAX) count = BSP_FLASH_GUARD_MAX;
+
+    __disable_irq();
+    // 关中断前已挂起的 FG 沿仍由 EXTI 中断计数, 擦除期间的沿由守护计数
+    for (uint8_t i = 0; i < count; i++) {
+        guard[i].fg_edges = 0;
+        if (!guard[i].fg_idr) continue;
+        fg_last[i] = (uint16_t)(*guard[i].fg_idr & guard[i].fg_mask);
+        fg_pend[i] = (uint16_t)(EXTI->PR & guard[i].fg_mask);
+    }
+    while (FLASH->SR & FLASH_SR_BSY) { }
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+    FLASH->CR |= FLASH_CR_PER;
+    FLASH->AR = addr;
+    FLASH->CR |= FLASH_CR_STRT;
+
+    while (FLASH->SR & FLASH_SR_BSY) {
+        // TIM3 更新中断同样被挂起, 由此维持微秒时基
+        Flash_GuardPoll(guard, count, fg_last, BSP_Time_PollUs32(tim));
+        if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) { // 读 CTRL 清除 COUNTFLAG
+            uwTick += uwTickFreq;
+            ticks++;
+        }
+    }
+
+    FLASH->CR &= ~FLASH_CR_PER;
+    uint8_t ok = !(FLASH->SR & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR));
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+
+    // 开中断前补计 FG 沿 (掉电快照中断随后即可读到正确位置), 并清除由这些沿置起的挂起位
+    for (uint8_t i = 0; i < count; i++) {
+        BSP_FlashGuard_t *g = &guard[i];
+        if (!g->fg_idr || !g->fg_edges) continue;
+        *g->fg_count += g->fg_edges;
+        *g->fg_pos += (int32_t)g->fg_step * g->fg_edges;
+        if (!fg_pend[i]) EXTI->PR = g->fg_mask;
+    }
+
+    // 已在上面补计的节拍不再由 SysTick 中断重复累加
+    if (ticks) SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+    flash_erase_backlog = 1;
+    __set_PRIMASK(primask); // 擦除期间挂起的中断在此补执行
+    flash_erase_backlog = 0;
+    return ok;
+}
+
+uint8_t BSP_Flash_EraseBacklog(void) {
+    return flash_erase_backlog;
+}
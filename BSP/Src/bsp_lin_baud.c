@@ -0,0 +1,95 @@
+#include "bsp_lin_baud.h"
+#include "bsp_conf.h"
+
+static uint32_t tim_clk = 0;         // TIM2 计数频率
+static uint8_t edge_cnt = 0;
+static uint16_t edge_first = 0;
+static volatile uint8_t synced = 0;
+static LinBaudStat_t stat = { .baud = LIN_BAUD_NOMINAL };
+
+void BSP_LinBaud_Init(void) {
+    // APB1 分频不为 1 时定时器时钟为 PCLK1 的 2 倍
+    tim_clk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) tim_clk *= 2;
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    __HAL_RCC_AFIO_CLK_ENABLE();
+    __HAL_AFIO_REMAP_TIM2_PARTIAL_2(); // CH3/CH4 -> PB10/PB11, CH1/CH2 保持 PA0/PA1 (未使用)
+
+    TIM_TypeDef *tim = LIN_AUTOBAUD_TIM;
+    tim->CR1 = 0;
+    tim->PSC = 0;          // 满速计数, 19200bps 下 8 位时间约 26667 个计数, 不超过 16 位
+    tim->ARR = 0xFFFF;
+    tim->CCMR2 = (TIM_CCMR2_CC4S_0)             // CC4 映射到 TI4
+               | (TIM_CCMR2_IC4F_1);            // 滤波 fCK_INT N=4
+    tim->CCER = TIM_CCER_CC4P | TIM_CCER_CC4E;  // 下降沿捕获
+    tim->EGR = TIM_EGR_UG;
+    tim->SR = 0;
+    tim->CR1 = TIM_CR1_CEN;
+
+    HAL_NVIC_SetPriority(LIN_AUTOBAUD_IRQn, 3, 0); // 与 USART3 同级, 捕获间隔 >= 2 位时间
+    HAL_NVIC_EnableIRQ(LIN_AUTOBAUD_IRQn);
+}
+
+void BSP_LinBaud_Arm(void) {
+    TIM_TypeDef *tim = LIN_AUTOBAUD_TIM;
+    edge_cnt = 0;
+    synced = 0;
+    tim->SR = ~(uint32_t)(TIM_SR_CC4IF | TIM_SR_CC4OF);
+    tim->DIER |= TIM_DIER_CC4IE;
+}
+
+uint8_t BSP_LinBaud_Synced(void) {
+    return synced;
+}
+
+void BSP_LinBaud_IRQHandler(void) {
+    TIM_TypeDef *tim = LIN_AUTOBAUD_TIM;
+    if (!(tim->SR & TIM_SR_CC4IF)) return;
+
+    uint16_t t = (uint16_t)tim->CCR4; // 读 CCR 清除 CC4IF
+    if (tim->SR & TIM_SR_CC4OF) {
+        // 丢沿: 放弃本帧测量
+        tim->SR = ~(uint32_t)TIM_SR_CC4OF;
+        tim->DIER &= ~TIM_DIER_CC4IE;
+        return;
+    }
+
+    if (edge_cnt++ == 0) {
+        edge_first = t;
+        return;
+    }
+    if (edge_cnt < LIN_AUTOBAUD_EDGES) return;
+
+    tim->DIER &= ~TIM_DIER_CC4IE; // 数据字节不再捕获
+
+    // 8 个位时间
+    uint32_t span = (uint16_t)(t - edge_first);
+    if (span == 0) return;
+    uint32_t baud = (uint32_t)(((uint64_t)tim_clk * 8u + span / 2) / span);
+    int32_t dev_ppm = (int32_t)(((int64_t)baud - LIN_BAUD_NOMINAL) * 1000000 / LIN_BAUD_NOMINAL);
+
+    if (dev_ppm > LIN_AUTOBAUD_TOL_PCT * 10000 || dev_ppm < -LIN_AUTOBAUD_TOL_PCT * 10000) {
+        stat.rejects++;
+        return;
+    }
+
+    // BRR = PCLK1 / baud (F1: 16 倍过采样, 低 4 位为小数部分)
+    uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+    LIN_UART_HANDLE.Instance->BRR = (pclk + baud / 2) / baud;
+
+    stat.baud = baud;
+    stat.dev_ppm = dev_ppm;
+    if (stat.syncs == 0 || dev_ppm < stat.dev_min_ppm) stat.dev_min_ppm = dev_ppm;
+    if (stat.syncs == 0 || dev_ppm > stat.dev_max_ppm) stat.dev_max_ppm = dev_ppm;
+    stat.syncs++;
+    synced = 1;
+}
+
+void BSP_LinBaud_GetStat(LinBaudStat_t *out) {
+    if (!out) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = stat;
+    __set_PRIMASK(primask);
+}
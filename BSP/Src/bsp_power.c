@@ -0,0 +1,76 @@
+#include "bsp_power.h"
+
+extern void SystemClock_Config(void); // main.c
+
+#define WAKE_LINE_LIN   EXTI_IMR_MR11
+#define WAKE_LINE_AT    EXTI_IMR_MR10
+
+static volatile uint8_t wake_src = 0;
+static void (*pvd_cb)(void) = NULL;
+
+uint8_t BSP_Power_EnterStop(uint8_t wake_mask) {
+    uint32_t lines = 0;
+    if (wake_mask & BSP_WAKE_LIN) lines |= WAKE_LINE_LIN;
+    if (wake_mask & BSP_WAKE_AT)  lines |= WAKE_LINE_AT;
+    if (lines == 0) return 0; // 无唤醒源时拒绝休眠
+
+    __HAL_RCC_AFIO_CLK_ENABLE();
+    __HAL_RCC_PWR_CLK_ENABLE();
+    // EXTI10 -> PA10, EXTI11 -> PB11
+    AFIO->EXTICR[2] = (AFIO->EXTICR[2] & ~(uint32_t)(AFIO_EXTICR3_EXTI10 | AFIO_EXTICR3_EXTI11))
+                    | AFIO_EXTICR3_EXTI10_PA | AFIO_EXTICR3_EXTI11_PB;
+    EXTI->RTSR &= ~lines;
+    EXTI->FTSR |= lines;
+    EXTI->PR = lines;
+    wake_src = 0;
+    EXTI->IMR |= lines;
+
+    HAL_NVIC_SetPriority(EXTI15_10_IRQn, 3, 0);
+    HAL_NVIC_ClearPendingIRQ(EXTI15_10_IRQn);
+    HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+
+    HAL_SuspendTick();
+    // 关中断下执行 WFI: 检查与休眠之间到来的边沿仍会挂起并立即唤醒
+    __disable_irq();
+    if (wake_src == 0) {
+        HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+    }
+    __enable_irq();
+
+    // 唤醒后系统时钟为 HSI 8MHz, 恢复 PLL 64MHz
+    SystemClock_Config();
+    HAL_ResumeTick();
+
+    EXTI->IMR &= ~lines;
+    EXTI->FTSR &= ~lines;
+    EXTI->PR = lines;
+    HAL_NVIC_DisableIRQ(EXTI15_10_IRQn);
+    return wake_src;
+}
+
+void BSP_Power_WakeIRQHandler(void) {
+    uint32_t pr = EXTI->PR & (WAKE_LINE_LIN | WAKE_LINE_AT);
+    EXTI->PR = pr;
+    if (pr & WAKE_LINE_LIN) wake_src |= BSP_WAKE_LIN;
+    if (pr & WAKE_LINE_AT)  wake_src |= BSP_WAKE_AT;
+}
+
+void BSP_Power_PvdInit(uint32_t level, void (*on_low)(void)) {
+    PWR_PVDTypeDef pvd = { .PVDLevel = level, .Mode = PWR_PVD_MODE_IT_RISING }; // PVDO 上升 = VDD 下降
+    __HAL_RCC_PWR_CLK_ENABLE();
+    pvd_cb = on_low;
+    HAL_PWR_ConfigPVD(&pvd);
+    HAL_PWR_EnablePVD();
+
+    HAL_NVIC_SetPriority(PVD_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(PVD_IRQn);
+}
+
+uint8_t BSP_Power_PvdLow(void) {
+    return (PWR->CSR & PWR_CSR_PVDO) ? 1 : 0;
+}
+
+void BSP_Power_PvdIRQHandler(void) {
+    __HAL_PWR_PVD_EXTI_CLEAR_FLAG();
+    if (pvd_cb) pvd_cb();
+}
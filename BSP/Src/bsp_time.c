@@ -0,0 +1,214 @@
+#include "bsp_time.h"
+#include "bsp_conf.h"
+
+// 时基状态: 最近一次 TIM3 更新事件的时刻 (TIM3 1MHz 计数, CNT 即其后经过的微秒)
+volatile uint64_t bsp_time_us_base = 0;
+
+// 闹钟状态
+typedef struct {
+    uint64_t when_us;
+    BSP_TimeAlarmCb_t cb;
+    uint8_t arg;
+} TimeAlarm_t;
+
+static TimeAlarm_t time_alarms[BSP_TIME_ALARM_COUNT];
+static volatile uint8_t alarm_armed = 0;  // 已设置
+static volatile uint8_t alarm_loaded = 0; // 已装入 TIM3 比较寄存器
+
+void BSP_Time_Init(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    bsp_time_us_base = 0;
+    __set_PRIMASK(primask);
+}
+
+// 中断安全: UIF 置位而更新中断尚未处理时补上一个周期 (见 BSP_Time_OnUpdate)
+uint64_t BSP_Time_GetUs(void) {
+    TIM_TypeDef *tim = BASE_TIM_HANDLE.Instance;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint64_t us = bsp_time_us_base;
+    uint32_t cnt = tim->CNT;
+    if (tim->SR & TIM_SR_UIF) {
+        cnt = tim->CNT; // 回绕后重读, 避免取到回绕前的计数
+        us += BSP_TIME_TICK_US;
+    }
+    us += cnt;
+    __set_PRIMASK(primask);
+    return us;
+}
+
+uint32_t BSP_Time_GetUs32(void) {
+    return (uint32_t)BSP_Time_GetUs();
+}
+
+// HAL 先清 UIF 再回调, 其间被抢占时读数会少一个周期; 因此在 HAL 之前关中断确认更新事件并推进时基
+uint8_t BSP_Time_OnUpdate(void) {
+    TIM_TypeDef *tim = BASE_TIM_HANDLE.Instance;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t upd = (tim->SR & TIM_SR_UIF) != 0;
+    if (upd) {
+        tim->SR = (uint32_t)~TIM_SR_UIF;
+        bsp_time_us_base += BSP_TIME_TICK_US;
+    }
+    __set_PRIMASK(primask);
+    return upd;
+}
+
+static void Alarm_Disable(uint8_t ch) {
+    BASE_TIM_HANDLE.Instance->DIER &= ~(TIM_DIER_CC1IE << ch);
+    alarm_loaded &= (uint8_t)~(1u << ch);
+}
+
+static void Alarm_Fire(uint8_t ch) {
+    Alarm_Disable(ch);
+    alarm_armed &= (uint8_t)~(1u << ch);
+    if (time_alarms[ch].cb) time_alarms[ch].cb(time_alarms[ch].arg);
+}
+
+void BSP_Time_SetAlarm(uint8_t ch, uint64_t when_us, BSP_TimeAlarmCb_t cb, uint8_t arg) {
+    if (ch >= BSP_TIME_ALARM_COUNT) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Alarm_Disable(ch);
+    time_alarms[ch].when_us = when_us;
+    time_alarms[ch].cb = cb;
+    time_alarms[ch].arg = arg;
+    alarm_armed |= (uint8_t)(1u << ch);
+    __set_PRIMASK(primask);
+}
+
+void BSP_Time_CancelAlarm(uint8_t ch) {
+    if (ch >= BSP_TIME_ALARM_COUNT) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Alarm_Disable(ch);
+    alarm_armed &= (uint8_t)~(1u << ch);
+    __set_PRIMASK(primask);
+}
+
+// TIM3 更新中断 (10kHz), 时基已由 BSP_Time_OnUpdate 推进
+void BSP_Time_OnTick(void) {
+    // 把本周期内到期的闹钟装入比较寄存器
+    uint8_t pending = alarm_armed & (uint8_t)~alarm_loaded;
+    if (pending == 0) return;
+
+    TIM_TypeDef *tim = BASE_TIM_HANDLE.Instance;
+    uint64_t now = BSP_Time_GetUs();
+    uint32_t cnt = tim->CNT;
+
+    for (uint8_t ch = 0; ch < BSP_TIME_ALARM_COUNT; ch++) {
+        if (!(pending & (1u << ch))) continue;
+
+        uint64_t when = time_alarms[ch].when_us;
+        if (when <= now + 2) {
+            // 已到期或来不及装载比较值
+            Alarm_Fire(ch);
+        } else if ((when - now) + cnt < tim->ARR) {
+            (&tim->CCR1)[ch] = cnt + (uint32_t)(when - now);
+            tim->SR = ~(TIM_SR_CC1IF << ch);
+            tim->DIER |= (TIM_DIER_CC1IE << ch);
+            alarm_loaded |= (uint8_t)(1u << ch);
+        }
+    }
+}
+
+// TIM3 比较中断
+void BSP_Time_OnCompare(uint8_t ch) {
+    if (ch >= BSP_TIME_ALARM_COUNT) return;
+    if (alarm_loaded & (1u << ch)) {
+        Alarm_Fire(ch);
+    }
+}
+
+// ---------------- 总线时间同步 ----------------
+typedef struct {
+    uint64_t l0;        // 锚点: 本地时刻
+    uint64_t m0;        // 锚点: 总线时刻
+    int32_t drift_ppm;
+} TimeSyncAnchor_t;
+
+static TimeSyncAnchor_t sync_anchor;
+static BSP_TimeSyncStat_t sync_stat;
+
+static uint64_t Sync_LocalToBus(const TimeSyncAnchor_t *a, uint64_t local_us) {
+    int64_t dl = (int64_t)(local_us - a->l0);
+    return a->m0 + (uint64_t)(dl + dl * a->drift_ppm / 1000000);
+}
+
+void BSP_Time_SyncSample(uint64_t local_us, uint64_t bus_us) {
+    TimeSyncAnchor_t a = sync_anchor;
+
+    if (sync_stat.valid) {
+        int64_t err = (int64_t)(bus_us - Sync_LocalToBus(&a, local_us));
+        int64_t dl = (int64_t)(local_us - a.l0);
+        if (err > BSP_TIME_SYNC_STEP_US || err < -BSP_TIME_SYNC_STEP_US || dl <= 0) {
+            // 主机重启 / 本机休眠等造成的跳变: 重新锚定
+            a.drift_ppm = 0;
+            sync_stat.steps++;
+            sync_stat.max_err_us = 0;
+        } else {
+            // 相邻两次同步间的实际频偏, 一阶低通 (1/4) 抑制时间戳抖动
+            int64_t dm = (int64_t)(bus_us - a.m0);
+            int64_t ppm = (dm - dl) * 1000000 / dl;
+            if (ppm > BSP_TIME_SYNC_MAX_PPM) ppm = BSP_TIME_SYNC_MAX_PPM;
+            if (ppm < -BSP_TIME_SYNC_MAX_PPM) ppm = -BSP_TIME_SYNC_MAX_PPM;
+            a.drift_ppm += (int32_t)((ppm - a.drift_ppm) / 4);
+            int32_t abs_err = (int32_t)(err < 0 ? -err : err);
+            if (abs_err > sync_stat.max_err_us) sync_stat.max_err_us = abs_err;
+        }
+        sync_stat.last_err_us = (int32_t)err;
+    }
+
+    a.l0 = local_us;
+    a.m0 = bus_us;
+
+    // 闹钟回调可能在中断中换算时间, 整体替换锚点
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    sync_anchor = a;
+    __set_PRIMASK(primask);
+
+    sync_stat.valid = 1;
+    sync_stat.syncs++;
+    sync_stat.drift_ppm = a.drift_ppm;
+    sync_stat.last_sync_us = local_us;
+}
+
+uint8_t BSP_Time_SyncValid(void) {
+    return sync_stat.valid;
+}
+
+uint64_t BSP_Time_LocalToBus(uint64_t local_us) {
+    if (!sync_stat.valid) return local_us;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    TimeSyncAnchor_t a = sync_anchor;
+    __set_PRIMASK(primask);
+    return Sync_LocalToBus(&a, local_us);
+}
+
+uint64_t BSP_Time_BusToLocal(uint64_t bus_us) {
+    if (!sync_stat.valid) return bus_us;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    TimeSyncAnchor_t a = sync_anchor;
+    __set_PRIMASK(primask);
+    // local = l0 + (bus - m0) / (1 + drift)
+    int64_t dm = (int64_t)(bus_us - a.m0);
+    return a.l0 + (uint64_t)(dm * 1000000 / (1000000 + a.drift_ppm));
+}
+
+uint64_t BSP_Time_GetBusUs(void) {
+    return BSP_Time_LocalToBus(BSP_Time_GetUs());
+}
+
+void BSP_Time_GetSyncStat(BSP_TimeSyncStat_t *stat) {
+    if (!stat) return;
+    *stat = sync_stat;
+    uint64_t now = BSP_Time_GetUs();
+    stat->offset_us = (int64_t)(BSP_Time_LocalToBus(now) - now);
+}
@@ -37,6 +37,7 @@ extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart3;
 
 /* USER CODE BEGIN Private defines */
+extern DMA_HandleTypeDef hdma_usart1_tx;
 
 /* USER CODE END Private defines */
 
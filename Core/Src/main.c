@@ -112,23 +112,8 @@ int main(void)
   App_Init();
   App_LIN_Init();
   
-  // 3. 配置电机参数
-  // 电机0: 最后2500脉冲开始减速, 最低速度PWM=100
-  App_Motor_ConfigDecel(0, 2500, 100);
-  
-  // 电机0: 配置硬件限位开关 (PA0=CW限位, PA1=CCW限位, 低电平触发)
-  //App_Motor_ConfigLimit(0, GPIOA, GPIO_PIN_0, GPIOA, GPIO_PIN_1, GPIO_PIN_RESET);
-
-  // 4. 配置ADC安全保护阈值
-  // 全局: 欠压9V, 过压28V, 过温85度
-  App_Adc_ConfigProtect_Global(9.0f, 28.0f, 85.0f);
-  
-  // 电机0: 过流阈值 5.0A
-  App_Adc_ConfigProtect_Motor(0, 5.0f);
-
-
-  
-
+  // 3. 电机减速/限位与 ADC 保护阈值由参数注册表在 App_Init 中应用
+  //    (默认值见各模块参数表, 运行时用 AT+PARAM 修改, AT+PARAMSAVE 保存)
 
   /* USER CODE END 2 */
 
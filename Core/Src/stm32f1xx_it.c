@@ -24,6 +24,9 @@
 /* USER CODE BEGIN Includes */
 #include "app_lin.h"
  #include "at_command.h"
+#include "bsp_lin_baud.h"
+#include "bsp_power.h"
+#include "bsp_time.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -64,6 +67,7 @@ extern DMA_HandleTypeDef hdma_usart1_rx;
 extern UART_HandleTypeDef huart1;
 extern UART_HandleTypeDef huart3;
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef hdma_usart1_tx;
 
 /* USER CODE END EV */
 
@@ -267,7 +271,8 @@ void EXTI9_5_IRQHandler(void)
 void TIM3_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM3_IRQn 0 */
-
+  // 更新事件由时基先行确认 (清 UIF 并推进时基), HAL 随后只处理比较通道
+  if (BSP_Time_OnUpdate()) HAL_TIM_PeriodElapsedCallback(&htim3);
   /* USER CODE END TIM3_IRQn 0 */
   HAL_TIM_IRQHandler(&htim3);
   /* USER CODE BEGIN TIM3_IRQn 1 */
@@ -311,5 +316,36 @@ void USART3_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles DMA1 channel4 global interrupt (USART1_TX, 遥测推送).
+  */
+void DMA1_Channel4_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_usart1_tx);
+}
+
+/**
+  * @brief This function handles TIM2 global interrupt (LIN Sync 字段输入捕获).
+  */
+void TIM2_IRQHandler(void)
+{
+  BSP_LinBaud_IRQHandler();
+}
+
+/**
+  * @brief This function handles EXTI line[15:10] interrupts (Stop 模式唤醒: PA10 / PB11).
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  BSP_Power_WakeIRQHandler();
+}
+
+/**
+  * @brief This function handles PVD interrupt through EXTI line 16 (掉电预警, 保存快照).
+  */
+void PVD_IRQHandler(void)
+{
+  BSP_Power_PvdIRQHandler();
+}
 
 /* USER CODE END 1 */
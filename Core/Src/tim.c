@@ -21,7 +21,8 @@
 #include "tim.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "app_telemetry.h"
+#include "bsp_time.h"
 /* USER CODE END 0 */
 
 TIM_HandleTypeDef htim3;
@@ -214,6 +215,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     if (htim->Instance == TIM3)
     {
         // 100us 中断周期 (10kHz)
+        BSP_Time_OnTick();      // 微秒时基扩展 + 闹钟装载 (需最先执行)
+        App_Telemetry_OnTick(); // 遥测订阅推送 (中断内组帧 + DMA)
+
         static uint32_t cnt = 0;
         cnt++;
         if (cnt >= 10000) // 100us * 10000 = 1s
@@ -223,4 +227,20 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
         }
     }
 }
+
+// TIM3 比较中断: 微秒闹钟到期
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM3)
+    {
+        switch (htim->Channel)
+        {
+            case HAL_TIM_ACTIVE_CHANNEL_1: BSP_Time_OnCompare(0); break;
+            case HAL_TIM_ACTIVE_CHANNEL_2: BSP_Time_OnCompare(1); break;
+            case HAL_TIM_ACTIVE_CHANNEL_3: BSP_Time_OnCompare(2); break;
+            case HAL_TIM_ACTIVE_CHANNEL_4: BSP_Time_OnCompare(3); break;
+            default: break;
+        }
+    }
+}
 /* USER CODE END 1 */
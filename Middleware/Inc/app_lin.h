@@ -2,14 +2,89 @@
 #define APP_LIN_H
 
 #include "main.h"
+#include "app_storage.h" // LinSchedEntry_t
+
+// 多节点寻址 (帧 ID 由 g_Config.device_id / lin_group_mask 决定, 无需为每块板单独编译)
+// 载荷: [Cmd<<4 | Motor, ...], Motor 为 1-based 电机号, 0 = 本节点全部电机
+#define LIN_ID_NODE_BASE    0x00 // 节点寻址: 0x00 + device_id - 1 (device_id 1~16)
+#define LIN_NODE_MAX        16
+#define LIN_ID_GROUP_BASE   0x20 // 组播: 0x20~0x23 对应组 0~3
+#define LIN_GROUP_MAX       4
+#define LIN_ID_BROADCAST    0x24 // 广播: 所有节点
+#define LIN_ID_TIME_SYNC    0x25 // 时间同步: [Seq, 0, T5..T0] 主机 Break 时刻 (us, 48 位大端), 由主机发送时自动填充
+
+// 节点/组播/广播指令码 (载荷 Byte0 高 4 位)
+#define LIN_NCMD_RUN        1 // [C, Dir, SpdH, SpdL]
+#define LIN_NCMD_STOP       2 // [C]
+#define LIN_NCMD_TIME       3 // [C, Dir, SpdH, SpdL, TimeH, TimeL]
+#define LIN_NCMD_POS        4 // [C, Dir, SpdH, SpdL, P3, P2, P1, P0]
+#define LIN_NCMD_ADC        5 // [C, SpdH, SpdL, AdcH, AdcL, Tol, RngH, RngL]
+#define LIN_NCMD_LINK       6 // [C, Mode, LoopH, LoopL]
+#define LIN_NCMD_START_AT   7 // [C, T3, T2, T1, T0] 总线时间 (us, 低 32 位): 该电机的下一条 TIME/POS/ADC 指令在 T 时刻启动
+#define LIN_START_AT_STALE_US 1000000 // T 已过去超过 1s 视为过期, 指令立即执行
 
 // LIN ID 定义 (根据需求自定义)
 #define LIN_ID_CMD_RUN      0x30 // 指令: 运行/停止 (Data: Type, ID, Dir, SpeedH, SpeedL...)
 #define LIN_ID_CMD_POS      0x31 // 指令: 位置控制 (Data: ID, Dir, SpdH, SpdL, Pos3, Pos2, Pos1, Pos0)
 #define LIN_ID_CMD_ADC      0x32 // 指令: ADC位置 (Data: ID, SpdH, SpdL, TgtH, TgtL, Tol, Rng)
-#define LIN_ID_QUERY        0x33 // 指令: 查询请求 (Data: ID)
+#define LIN_ID_QUERY        0x33 // 指令: 选择状态反馈的电机与节点 (Data: MotorID, NodeID(0=任意))
+
+// 响应: 状态反馈 (从机应答帧, 主机只发 Header)
+// [Busy<<7|ID, Err, PulseH, PulseL, Duty/4, Cur(0.1A), PosH, PosL]
+#define LIN_ID_RESP_STATUS  0x34
+// 响应: 总线健康 (由 LIN_ID_QUERY 选中的节点应答)
+// [CksumErr, ParityErr, FrameErr, Overrun, Noise, SyncErr, IdleH, IdleL], 计数饱和于 255, Idle 单位 10ms
+#define LIN_ID_RESP_BUS     0x35
 
-#define LIN_ID_RESP_STATUS  0x34 // 响应: 状态反馈 (Data: ID, Busy, Pulses...)
+// 主机模式: 时隙最短长度 (ms) = 帧最大时长 1.4 * (34 + 10 * (len + 1)) 位 @ 19200bps, 向上取整
+#define LIN_SCHED_MIN_MS(len)   ((14u * (44u + 10u * (len)) + 191u) / 192u)
+
+// 主机模式: 调度表中应答帧的收集结果
+typedef struct {
+    uint8_t  id;
+    uint8_t  len;
+    uint8_t  data[8];
+    uint32_t rx;        // 有效应答数
+    uint32_t no_resp;   // 时隙内无完整应答次数
+    uint32_t errors;    // 应答校验和错误次数
+    uint64_t last_us;   // 最近一次有效应答的 Break 时刻
+} LinMasterResp_t;
+
+// 接收帧队列深度 (2 的幂): 中断只入队校验通过的帧, 由 App_LIN_Process 在主循环中执行
+#ifndef LIN_RXQ_SIZE
+#define LIN_RXQ_SIZE        8
+#endif
+
+// 接收帧队列统计
+typedef struct {
+    uint32_t queued;     // 入队帧数
+    uint32_t executed;   // 已执行帧数
+    uint32_t overflows;  // 队列满丢弃帧数
+    uint8_t  depth;      // 当前深度
+    uint8_t  depth_max;  // 历史最大深度
+} LinQueueStat_t;
+
+// 总线错误类型
+typedef enum {
+    LIN_ERR_NONE = 0,
+    LIN_ERR_CHECKSUM,   // 校验和错误
+    LIN_ERR_PARITY,     // PID 奇偶错误
+    LIN_ERR_FRAMING,    // 帧中字节停止位错误 (FE, 不含 Break 本身)
+    LIN_ERR_OVERRUN,    // 接收溢出 (ORE)
+    LIN_ERR_NOISE,      // 噪声 (NE)
+    LIN_ERR_SYNC,       // Break 后 Sync 字段错误
+    LIN_ERR_COUNT
+} LinErrType_t;
+
+// 总线健康统计
+typedef struct {
+    uint32_t breaks;                 // 收到的 Break (帧头) 数
+    uint32_t err[LIN_ERR_COUNT];     // 各类错误计数 (err[0] 未用)
+    uint32_t erase_overruns;         // Flash 擦除关中断造成的接收溢出 (预期丢失, 不计入 err)
+    uint8_t  last_err;               // 最近一次错误类型
+    uint64_t last_err_us;            // 最近一次错误时刻 (BSP_Time_GetUs)
+    uint32_t idle_ms;                // 总线空闲时长 (距最近一次 Break/接收字节)
+} LinBusStat_t;
 
 // LIN 协议状态
 typedef enum {
@@ -25,5 +100,25 @@ void App_LIN_Init(void);
 void App_LIN_Process(void);
 void App_LIN_IRQHandler(void);
 void App_LIN_ErrorCallback(UART_HandleTypeDef *huart); // 新增
+void App_LIN_GetQueueStat(LinQueueStat_t *stat);
+void App_LIN_GetBusStat(LinBusStat_t *stat);
+// 按帧 ID 统计: rx = 收到的本节点帧头数, exec = 执行 (SUB) / 应答 (PUB) 次数
+void App_LIN_GetIdStat(uint8_t id, uint16_t *rx, uint16_t *exec);
+void App_LIN_ClearStats(void);
+// 主机模式 (调度表存于 g_Config.lin_sched)
+void App_LIN_MasterEnable(uint8_t enable);      // Flash保存, 上电自动运行
+uint8_t App_LIN_MasterIsEnabled(void);
+uint32_t App_LIN_MasterGetCycles(void);         // 调度表完整轮次
+// 设置/删除时隙 (entry = NULL 删除), Flash保存; 返回 0 表示参数无效
+uint8_t App_LIN_MasterSetSlot(uint8_t idx, const LinSchedEntry_t *entry);
+// 运行时更新指令时隙数据 (不保存), 供联动等上层逻辑驱动下游节点
+uint8_t App_LIN_MasterSetData(uint8_t idx, const uint8_t *data, uint8_t len);
+uint8_t App_LIN_MasterGetResp(uint8_t idx, LinMasterResp_t *resp);
+
+// 低功耗: 收发器休眠 / 唤醒 (由 app_power 调用)
+void App_LIN_Sleep(void);
+void App_LIN_Wake(void);
+// 最近一帧有效帧的 Break 时刻 (BSP_Time_GetUs 时基), 0 表示尚未收到
+uint64_t App_LIN_GetLastFrameTime(void);
 
 #endif
@@ -0,0 +1,51 @@
+#ifndef APP_TELEMETRY_H
+#define APP_TELEMETRY_H
+
+#include "main.h"
+
+// 订阅字段掩码 (AT+SUB 的 <Mask> 参数, 按位或组合)
+#define TELEM_F_PULSES    (1u << 0) // 脉冲计数 (int32)
+#define TELEM_F_SPEED     (1u << 1) // 当前 PWM 占空比 (uint16, 0-1000)
+#define TELEM_F_CURRENT   (1u << 2) // 电流 (int16, mA)
+#define TELEM_F_POSITION  (1u << 3) // ADC 位置原始值 (uint16)
+#define TELEM_F_VOLTAGE   (1u << 4) // 母线电压 (uint16, 10mV)
+#define TELEM_F_TEMP      (1u << 5) // 板载温度 (int16, 0.1C)
+#define TELEM_F_ERROR     (1u << 6) // 错误码 (uint8)
+#define TELEM_F_LINK      (1u << 7) // 联动状态 (uint8 Mode + uint8 Step)
+#define TELEM_F_ALL       0xFFu
+
+// 推送频率上限 (由 TIM3 10kHz 节拍分频得到)
+#define TELEM_TICK_HZ     10000u
+#define TELEM_RATE_MAX    1000u
+
+// 编码格式
+typedef enum {
+    TELEM_FMT_CSV = 0, // "+TLM:v1,v2,...\r\n"
+    TELEM_FMT_BIN = 1  // [0xA5 0x5A Seq Mask Len Payload... Sum]
+} TelemFormat_t;
+
+// 二进制帧同步头
+#define TELEM_BIN_SYNC0   0xA5
+#define TELEM_BIN_SYNC1   0x5A
+
+typedef struct {
+    uint32_t frames_sent;    // 已启动 DMA 的帧数
+    uint32_t frames_dropped; // 串口忙导致丢弃的帧数
+} TelemStats_t;
+
+void App_Telemetry_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief 设置订阅
+ * @param mask 字段掩码, 0 表示取消订阅
+ * @param rate_hz 推送频率 1~TELEM_RATE_MAX
+ * @param fmt 编码格式
+ * @return 0:成功, -1:参数错误
+ */
+int8_t App_Telemetry_Subscribe(uint8_t mask, uint16_t rate_hz, TelemFormat_t fmt);
+void App_Telemetry_GetStats(TelemStats_t *stats);
+
+// 在 TIM3 10kHz 中断中调用: 到期时在中断内组帧并通过 DMA 发出
+void App_Telemetry_OnTick(void);
+
+#endif
@@ -21,6 +21,10 @@ extern "C" {
 #define AT_RX_BUFFER_SIZE     1024  // 接收缓冲区大小
 #define AT_CMD_MAX_LEN        1024  // 最大命令长度
 
+// 波特率切换
+#define AT_BAUD_DEFAULT       115200
+#define AT_BAUD_CONFIRM_MS    3000  // 切换后等待主机以新波特率确认的超时时间
+
 
 /* Exported types ------------------------------------------------------------*/
 // AT命令处理状态
@@ -50,10 +54,16 @@ AtCmdStatus_t AT_ProcessCommand(char *cmd);
 
 // 发送AT响应
 void AT_SendResponse(const char *format, ...);
+// 发送原始二进制数据 (批量导出), 不追加换行
+void AT_SendBinary(const uint8_t *data, uint16_t len);
 
 // 发送错误响应
 void AT_SendErrorResponse(AtCmdStatus_t status);
 
+// 波特率: 检查是否为支持的速率 / 立即切换 (不保存, 发送占用未释放时返回 HAL_BUSY 且不切换)
+bool AT_IsValidBaudRate(uint32_t baud);
+HAL_StatusTypeDef AT_ApplyBaudRate(uint32_t baud);
+
 // UART中断回调函数
 void AT_UART_IdleCallback(UART_HandleTypeDef *huart);
 //void AT_UART_TxCpltCallback(UART_HandleTypeDef *huart);
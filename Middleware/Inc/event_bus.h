@@ -0,0 +1,55 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "stm32f1xx_hal.h"
+
+// 轻量事件总线
+// 事件在产生处发布 (中断或主循环均可, 只置待处理位, 不排队): 同类事件在派发前合并为一次,
+// 订阅者收到的是事件位掩码, 需自行重新检查关心的状态 (哪个电机停了、条件是否满足).
+// 主循环 EventBus_Process() 把待处理事件派发给订阅者; 没有待处理事件时主循环可以 WFI 休眠,
+// 等待者不必每轮轮询电机状态与系统时钟.
+//
+// 定时器: EVENT_TIMER_MAX 个单次软件定时器共用 TIM3 比较通道 BSP_TIME_ALARM_EVENT,
+// 到期在中断中发布 EVT_TIMER (约 1us 精度).
+#define EVENT_SUB_MAX       4
+#define EVENT_TIMER_MAX     4
+
+typedef enum {
+    EVT_MOTOR_DONE = 0,     // 电机由运动转为停止 (到位 / 到时 / 停机指令 / 保护停机)
+    EVT_LIMIT,              // 限位开关触发
+    EVT_FAULT,              // 故障上报 (App_Fault_Report)
+    EVT_TIMER,              // 事件定时器到期
+    EVT_ADC,                // ADC 位置越过监视阈值 (App_Adc_Watch)
+    EVT_LIN_CMD,            // LIN 帧进入接收队列
+    EVT_COUNT
+} EventId_t;
+
+#define EVT_BIT(e)          (1u << (e))
+
+// 派发回调 (主循环上下文), events 为本次派发的事件位掩码中与订阅掩码相交的部分
+typedef void (*EventHandler_t)(uint32_t events, void *ctx);
+
+typedef struct {
+    uint32_t posted[EVT_COUNT]; // 各事件发布次数 (合并前)
+    uint32_t dispatches;        // 派发轮数
+    uint8_t  subscribers;
+    uint8_t  timers_active;     // 当前运行中的定时器数
+    uint32_t pending;           // 当前待处理事件
+} EventBusStat_t;
+
+// 发布事件 (中断安全)
+void EventBus_Post(EventId_t evt);
+// 订阅事件位掩码, 表满返回 0
+uint8_t EventBus_Subscribe(uint32_t mask, EventHandler_t handler, void *ctx);
+// 主循环调用: 派发待处理事件
+void EventBus_Process(void);
+// 没有待处理事件 (关中断后调用, 决定能否 WFI)
+uint8_t EventBus_Idle(void);
+
+// 单次定时器: ms 后发布 EVT_TIMER (重复启动覆盖原到期时刻)
+void EventBus_StartTimer(uint8_t t, uint32_t ms);
+void EventBus_StopTimer(uint8_t t);
+
+void EventBus_GetStat(EventBusStat_t *stat);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef FLASH_JOB_H
+#define FLASH_JOB_H
+
+#include "stm32f1xx_hal.h"
+#include "bsp_flash.h"
+
+// 后台 Flash 作业队列
+// 写入方提交作业后立即返回, 主循环 FlashJob_Process() 每次只执行一小段:
+//   编程: 每次最多 FLASH_JOB_HALF_PER_CALL 个半字 (每个约 50us)
+//   擦除: 一次一页, 在 RAM 中等待并运行安全守护 (见 bsp_flash.h); 守护钩子要求推迟时
+//         最多推迟 FLASH_JOB_DEFER_MAX_MS, 之后带守护执行
+// 作业按提交顺序执行, 完成 (或失败/取消) 时在主循环中回调.
+// 同一 chain (非 0) 的作业中任一失败, 该链中后续作业全部取消 (回调 ok = 0).
+#define FLASH_JOB_QUEUE_SIZE      12
+#define FLASH_JOB_HALF_PER_CALL   8
+#define FLASH_JOB_DEFER_MAX_MS    5000
+#define FLASH_JOB_GUARD_MAX       BSP_FLASH_GUARD_MAX
+
+typedef enum {
+    FLASH_JOB_ERASE = 0,   // 擦除 addr 所在页
+    FLASH_JOB_PROGRAM,     // 写 len 字节 (偶数) 到 addr
+} FlashJobOp_t;
+
+typedef void (*FlashJobCb_t)(void *ctx, uint8_t ok);
+// 编程数据源 (可选): 返回相对作业起点 off 处的半字, 用于从多处拼接数据 (如整理时搬移记录)
+typedef uint16_t (*FlashJobRead_t)(void *ctx, uint32_t off);
+
+typedef struct {
+    uint8_t        op;     // FlashJobOp_t
+    uint8_t        chain;  // 0 = 独立作业
+    uint16_t       len;
+    uint32_t       addr;
+    const void    *src;    // 编程数据 (RAM 或 Flash), 作业完成前须保持有效; read 非 NULL 时忽略
+    FlashJobRead_t read;
+    FlashJobCb_t   cb;     // 可为 NULL
+    void          *ctx;
+} FlashJob_t;
+
+// 擦除守护钩子: prepare 填写守护表并返回条目数, 当前不宜擦除时置 *defer = 1 (请求推迟);
+// finish 在每次带守护的擦除后于主循环中调用, 处理被守护停机的条目与擦除期间补计的 FG 脉冲
+typedef uint8_t (*FlashGuardPrepare_t)(BSP_FlashGuard_t *guard, uint8_t max, uint8_t *defer);
+typedef void (*FlashGuardFinish_t)(const BSP_FlashGuard_t *guard, uint8_t count);
+
+typedef struct {
+    uint32_t done;         // 完成作业数
+    uint32_t failed;       // 失败 / 取消作业数
+    uint32_t erases;       // 页擦除次数
+    uint32_t halfwords;    // 编程半字数
+    uint32_t deferred;     // 擦除被推迟的次数
+    uint32_t trips;        // 擦除期间守护停机次数
+    uint32_t erase_max_us; // 单次擦除最长耗时
+    uint8_t  pending;      // 当前排队作业数
+    uint8_t  pending_max;  // 排队深度峰值
+} FlashJobStat_t;
+
+// 提交作业 (拷贝作业描述), 队列满返回 0
+uint8_t FlashJob_Submit(const FlashJob_t *job);
+uint8_t FlashJob_Free(void);   // 剩余队列空位
+uint8_t FlashJob_Idle(void);   // 队列为空
+// 主循环调用: 执行一小段作业
+void FlashJob_Process(void);
+// 阻塞执行全部作业 (仅上电初始化 / 休眠前调用), 不推迟擦除
+void FlashJob_Flush(void);
+void FlashJob_SetGuard(FlashGuardPrepare_t prepare, FlashGuardFinish_t finish);
+void FlashJob_GetStat(FlashJobStat_t *stat);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef FLASH_KV_H
+#define FLASH_KV_H
+
+#include "stm32f1xx_hal.h"
+
+// Flash 日志结构键值存储 (磨损均衡 + 掉电安全)
+//
+// 两页交替使用, 任一时刻只有一页为活动页. 每次更新在活动页末尾追加一条记录, 不擦除:
+//   [Key|Len (u32)] [Seq (u32)] [Data, 补齐 4 字节] [CRC32 (u32)]
+// CRC 覆盖记录头与数据, 写入顺序为 头 -> 序号 -> 数据 -> CRC, 掉电留下的半条记录因 CRC 不符被忽略,
+// 该键仍读到上一条有效记录. CRC 由 CRC 服务 (bsp_crc.h) 计算; 旧版固件写入的记录为 IEEE 802.3 CRC-32, 仍可读. 活动页写满时把每个键的最新记录搬到另一页, 全部写完后才写页头
+// (魔数 + 代号), 因此搬移中掉电旧页仍然有效; 上电选代号最大的有效页.
+// 上电扫描一遍活动页建立 RAM 索引 (键 -> 最新记录地址), 读操作不再扫描 Flash.
+#define FLASH_KV_MAX_KEYS     40   // RAM 索引容量 (不同键的数量)
+#define FLASH_KV_MAX_LEN      64   // 单条记录数据长度上限 (字节)
+#define FLASH_KV_KEY_ERASED   0xFFFF
+
+typedef enum {
+    FLASH_KV_ERR = 0,     // 参数错误 / 索引满 / 存储满 / 提交失败
+    FLASH_KV_OK,          // 已提交 (或内容未变)
+    FLASH_KV_BUSY,        // 记录缓冲或作业队列已满 / 整理未完成, 稍后重试
+} FlashKvResult_t;
+
+typedef struct {
+    uint8_t  page;        // 活动页 0/1
+    uint32_t gen;         // 活动页代号, 每次整理 (搬页) 加 1
+    uint16_t used;        // 活动页已用字节 (含页头)
+    uint16_t size;        // 页大小
+    uint8_t  keys;        // 索引中的键数
+    uint32_t writes;      // 本次上电追加的记录数
+    uint32_t compacts;    // 本次上电整理次数
+    uint32_t crc_errs;    // 上电扫描发现的损坏记录数
+} FlashKvStat_t;
+
+typedef struct {
+    uint16_t records;     // 活动页中校验通过的记录数 (含已被同键新记录覆盖的)
+    uint16_t legacy;      // 其中使用旧版 CRC 的记录数
+    uint16_t bad;         // 校验失败的记录数
+} FlashKvCheck_t;
+
+// 上电调用: 扫描建立索引. 返回 1 = 找到有效存储, 0 = 空白 (已格式化为新存储)
+uint8_t FlashKV_Init(void);
+// 以下接口都不等待作业队列 (擦除可能因运动推迟), 运动中调用也不会阻塞主循环
+// 读键: 返回数据长度, 键不存在返回 -1; 超出 size 的部分被截断. 尚未写入 Flash 的记录从 RAM 缓冲读取
+int FlashKV_Read(uint16_t key, void *buf, uint16_t size);
+// 写键 (追加新记录, 活动页满时自动整理); 返回 FLASH_KV_BUSY 时未写入, 调用方稍后重试
+FlashKvResult_t FlashKV_Write(uint16_t key, const void *data, uint16_t len);
+// 写入当前会返回 FLASH_KV_BUSY (记录缓冲或队列已满)
+uint8_t FlashKV_Busy(void);
+void FlashKV_GetStat(FlashKvStat_t *stat);
+// 重新校验活动页全部记录 (不修改索引), 返回损坏记录数; 作业队列未完成时返回 -1, chk 不变; chk 可为 NULL
+int FlashKV_Verify(FlashKvCheck_t *chk);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LIN_DIAG_H
+#define LIN_DIAG_H
+
+#include "main.h"
+
+// LIN 诊断帧 (ISO 17987 传输层): 主机请求 0x3C / 从机应答 0x3D, Classic 校验和
+// 帧格式: [NAD, PCI, ...]
+//   SF: PCI = 0x0L,             L = 1~6 字节数据
+//   FF: PCI = 0x1H, LEN(低8位), 12 位总长度, 首帧 5 字节数据
+//   CF: PCI = 0x2N,             N = 序号 1~15 循环, 每帧 6 字节数据
+// 本节点 NAD = g_Config.device_id, 0x7F 为通配 (只执行不应答)
+#define LIN_ID_DIAG_REQ         0x3C
+#define LIN_ID_DIAG_RESP        0x3D
+#define LIN_DIAG_NAD_WILDCARD   0x7F
+#define LIN_DIAG_NAD_SLEEP      0x00 // 休眠指令 (Data1~7 = 0xFF), 所有节点进入休眠
+
+#ifndef LIN_DIAG_BUF_SIZE
+#define LIN_DIAG_BUF_SIZE       128  // 单条请求/应答最大长度
+#endif
+#define LIN_DIAG_TIMEOUT_MS     1000 // 分段接收 / 应答等待超时 (N_Cr / P2*)
+
+// 服务 (SID)
+#define LIN_SID_READ_BY_ID      0xB2 // LIN 节点配置: 读标识 (仅支持 Identifier 0)
+#define LIN_SID_READ_DID        0x22 // 读数据标识
+#define LIN_SID_WRITE_DID       0x2E // 写数据标识
+#define LIN_SID_NEGATIVE        0x7F
+
+// 否定应答码
+#define LIN_NRC_NOT_SUPPORTED   0x11
+#define LIN_NRC_BAD_LENGTH      0x13
+#define LIN_NRC_CONDITIONS      0x22 // 当前状态不允许 (如未开始上传)
+#define LIN_NRC_SEQUENCE        0x24 // 数据块偏移不连续
+#define LIN_NRC_OUT_OF_RANGE    0x31
+#define LIN_NRC_PROG_FAILURE    0x72 // Flash 写入失败
+
+// 数据标识 (DID), 多字节数值均为大端
+#define LIN_DID_DEVICE_ID       0x0100 // [ID]             设备ID / NAD (Flash保存)
+#define LIN_DID_LIN_GROUPS      0x0101 // [Mask]           组播成员掩码 (Flash保存)
+#define LIN_DID_SW_VERSION      0x0102 // ASCII            只读
+#define LIN_DID_DECEL(m)        (0x0110 + (m)) // [P3 P2 P1 P0 MinSpdH MinSpdL] 减速距离/蠕动速度
+#define LIN_DID_CURR_LIMIT(m)   (0x0120 + (m)) // [mA_H mA_L]  过流阈值
+#define LIN_DID_PROTECT         0x0130 // [En VminH VminL VmaxH VmaxL TmaxH TmaxL] 0.1V / 0.1℃
+#define LIN_DID_PARAM_CMD       0x01F0 // 写 [1] = 运行参数保存到 Flash, [2] = 恢复默认值
+#define LIN_DID_PARAM(n)        (0x0200 + (n)) // 运行参数 n (app_param.h), 按类型 1/2/4 字节
+// 联动程序上传 (app_linkprog.h), 运行: LIN 指令 6 Mode = 0x10 + 槽号
+#define LIN_DID_PROG_CTRL       0x0300 // 写 [1 Slot LenH LenL Name..] 开始 / [2 CRC3..CRC0] 结束 / [3] 放弃 / [4 Slot] 删除
+                                       // 读 [State Slot LenH LenL RecvH RecvL Result VmErr PcH PcL]
+#define LIN_DID_PROG_DATA       0x0301 // 写 [OffH OffL Data..] 数据块
+#define LIN_DID_PROG_SLOT(n)    (0x0310 + (n)) // 读 [Valid LenH LenL CRC3..CRC0 Name(8)]
+
+#define LIN_DIAG_SUPPLIER_ID    0x7FFF // 通配供应商
+#define LIN_DIAG_FUNCTION_ID    0x0001
+#define LIN_DIAG_VARIANT        0x01
+
+void LIN_Diag_Init(void);
+// 主循环: 处理一帧 0x3C 主机请求
+void LIN_Diag_OnRequest(const uint8_t *frame);
+// 主循环: 取下一帧 0x3D 应答数据 (8 字节), 无待发应答返回 0
+uint8_t LIN_Diag_NextResponse(uint8_t *frame);
+// 主循环: 超时处理
+void LIN_Diag_Process(void);
+
+#endif
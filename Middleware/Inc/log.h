@@ -13,26 +13,109 @@ typedef enum {
   LOG_LEVEL_DEBUG = 0,
   LOG_LEVEL_INFO,
   LOG_LEVEL_WARNING,
-  LOG_LEVEL_ERROR
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_NONE      // 关闭该模块日志
 } LogLevel_t;
 
+// 模块标签: 各源文件在包含 log.h 之前定义 LOG_MODULE, 未定义时归入 SYS
+typedef enum {
+  LOG_MOD_SYS = 0,
+  LOG_MOD_ADC,
+  LOG_MOD_MOTOR,
+  LOG_MOD_LIN,
+  LOG_MOD_AT,
+  LOG_MOD_LINK,
+  LOG_MOD_STORAGE,
+  LOG_MOD_COUNT
+} LogModule_t;
+
+#ifndef LOG_MODULE
+#define LOG_MODULE LOG_MOD_SYS
+#endif
+
+// 每模块令牌桶默认参数: 平均每秒条数 / 突发条数
+#ifndef LOG_RATE_DEFAULT
+#define LOG_RATE_DEFAULT  20
+#endif
+#ifndef LOG_BURST_DEFAULT
+#define LOG_BURST_DEFAULT 10
+#endif
+
+// 模块运行时统计
+typedef struct {
+  uint8_t  level;       // 当前最小输出级别
+  uint16_t rate;        // 每秒允许条数 (0 = 不限速)
+  uint16_t burst;       // 桶容量
+  uint32_t emitted;     // 已输出条数
+  uint32_t suppressed;  // 因限速被丢弃的条数
+} LogModuleStat_t;
+
 // 设置最小日志级别，低于此级别的不会输出
 #ifndef MIN_LOG_LEVEL
 #define MIN_LOG_LEVEL LOG_LEVEL_DEBUG
 #endif
 
+// 延迟(二进制)日志模式:
+//   0 = 文本模式, Log_Print 现场格式化并阻塞发送
+//   1 = 延迟模式, LOG_* 只把格式串ID + 时间戳 + 原始参数写入环形缓冲区,
+//       由 Log_Process 在主循环中经 DMA 发出, 主机用 Tools/log_decode.py 结合 ELF 还原文本。
+//       可在中断中安全调用; 参数须为 32 位整数或指针 (不支持 %f, %s 仅能还原 Flash 中的常量串)
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 0
+#endif
+
+// 延迟日志环形缓冲区大小 (字节)
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 1024
+#endif
+#define LOG_MAX_ARGS  8
+
+// 二进制日志记录: [A5 4C Len IdL IdH Ts0..Ts3 Arg0(4B)... Sum], Len = Id 到最后一个参数的字节数
+// Ts 为微秒时基低 32 位 (约 71 分钟回绕)
+#define LOG_BIN_SYNC0 0xA5
+#define LOG_BIN_SYNC1 0x4C
+
+#if LOG_DEFERRED
+// 参数个数统计 (0~8)
+#define LOG_NARGS(...)  LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(z, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+
+// 格式串放入 .log_fmt 段 (链接脚本中为 INFO 段, 不占 Flash), 其地址即为消息ID
+#define LOG_EMIT(level, fmt, ...) do { \
+    static const char _log_fmt[] __attribute__((section(".log_fmt"), used)) = fmt; \
+    Log_Deferred(LOG_MODULE, level, _log_fmt, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__); \
+  } while (0)
+#else
+#define LOG_EMIT(level, fmt, ...) Log_Print(LOG_MODULE, level, fmt, ##__VA_ARGS__)
+#endif
+
 // 日志宏
-#define LOG_DEBUG(fmt, ...)   Log_Print(LOG_LEVEL_DEBUG, "[DEBUG] " fmt, ##__VA_ARGS__)
-#define LOG_INFO(fmt, ...)    Log_Print(LOG_LEVEL_INFO, "[INFO] " fmt, ##__VA_ARGS__)
-#define LOG_WARN(fmt, ...)    Log_Print(LOG_LEVEL_WARNING, "[WARN] " fmt, ##__VA_ARGS__)
-#define LOG_ERROR(fmt, ...)   Log_Print(LOG_LEVEL_ERROR, "[ERROR] " fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...)   LOG_EMIT(LOG_LEVEL_DEBUG, "[DEBUG] " fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)    LOG_EMIT(LOG_LEVEL_INFO, "[INFO] " fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)    LOG_EMIT(LOG_LEVEL_WARNING, "[WARN] " fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...)   LOG_EMIT(LOG_LEVEL_ERROR, "[ERROR] " fmt, ##__VA_ARGS__)
 
 // 日志初始化与输出函数
 void Log_Init(UART_HandleTypeDef* huart);
-void Log_Print(LogLevel_t level, const char* fmt, ...);
+void Log_Print(LogModule_t module, LogLevel_t level, const char* fmt, ...);
+
+// 延迟模式: 记录一条二进制日志 (中断安全), nargs 个 32 位参数
+void Log_Deferred(LogModule_t module, LogLevel_t level, const char* fmt_id, uint8_t nargs, ...);
+// 延迟模式: 主循环中调用, 将缓冲区内容经 DMA 发出
+void Log_Process(void);
+// 因缓冲区满而丢弃的记录数
+uint32_t Log_GetDropped(void);
+
+// 运行时配置 (AT+LOGLVL / AT+LOGRATE)
+void Log_SetLevel(LogModule_t module, LogLevel_t level);
+void Log_SetRate(LogModule_t module, uint16_t rate, uint16_t burst);
+void Log_GetModuleStat(LogModule_t module, LogModuleStat_t *stat);
+const char* Log_GetModuleName(LogModule_t module);
+// 按名称查找模块 (不区分大小写), 未找到返回 LOG_MOD_COUNT
+LogModule_t Log_FindModule(const char *name);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif // USER_LOG_H
\ No newline at end of file
+#endif // USER_LOG_H
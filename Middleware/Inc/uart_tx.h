@@ -0,0 +1,19 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include "stm32f1xx_hal.h"
+
+// 串口发送占用
+// AT 应答、日志 (文本阻塞发送 / 延迟日志 DMA) 与遥测 DMA 共用同一串口, 发送方可能在主循环或中断中.
+// "串口空闲 -> 启动发送" 在关中断下一次完成 (UartTx_TryAcquire), 中间不会被其它发送方抢先:
+//   阻塞发送: 占用 -> HAL_UART_Transmit -> UartTx_Release, 期间遥测等其它发送方放弃本次发送
+//   DMA 发送: 占用 -> HAL_UART_Transmit_DMA -> 立即 UartTx_Release, 之后由 gState 表示忙
+#define UART_TX_WAIT_MS     20  // 主循环等待串口的上限 (覆盖一块 128 字节的延迟日志 DMA)
+
+// 串口空闲且无人占用时占用并返回 1 (中断安全)
+uint8_t UartTx_TryAcquire(UART_HandleTypeDef *huart);
+// 主循环中最多等待 timeout_ms, 中断中只尝试一次
+uint8_t UartTx_Acquire(UART_HandleTypeDef *huart, uint32_t timeout_ms);
+void UartTx_Release(void);
+
+#endif
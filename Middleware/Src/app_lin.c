@@ -3,9 +3,17 @@
 #include "app_linkage.h"
 #include "bsp_bldc.h"
 #include "app_adc.h"
+#include "app_storage.h"
+#include "lin_diag.h"
+#include "app_power.h"
+#define LOG_MODULE LOG_MOD_LIN
 #include "log.h"
 #include <string.h>
 #include "bsp_conf.h" // 引入配置
+#include "bsp_time.h"
+#include "bsp_lin_baud.h"
+#include "bsp_flash.h"
+#include "event_bus.h"
 
 // extern UART_HandleTypeDef huart3; // 移除
 
@@ -13,22 +21,161 @@
 static volatile LinState_t lin_state = LIN_STATE_IDLE;
 static volatile uint8_t lin_rx_buffer[9]; // 8 Bytes Data + 1 Checksum
 static volatile uint8_t lin_data_idx = 0;
-static volatile uint8_t lin_current_id = 0;
+static volatile uint8_t lin_current_id = 0;  // 当前帧 PID
 static volatile uint8_t lin_data_len = 0;
+static volatile uint8_t lin_cksum_pid = 0;   // 校验和种子: Enhanced 为 PID, Classic 为 0
+static volatile uint64_t lin_break_us = 0;      // 当前帧 Break 时刻
+static volatile uint64_t lin_last_frame_us = 0; // 最近一帧有效帧的 Break 时刻
 
-// 从 ID 获取数据长度 (简单的固定长度 8 字节，或查表)
-static uint8_t GetLenFromID(uint8_t id) {
-    // 简单起见，假设我们定义的 ID 都是 8 字节数据
-    // 标准 LIN 需根据 ID[5:4] 判断，这里简化
-    return 8;
+// ---------------- 帧描述表 (由 lin_frames.def 编译期生成) ----------------
+#define LIN_DIR_NONE        0 // 不属于本节点
+#define LIN_DIR_SUB         1 // 本节点接收
+#define LIN_DIR_PUB         2 // 本节点应答
+#define LIN_CKSUM_CLASSIC   0
+#define LIN_CKSUM_ENHANCED  1
+#define LIN_ADDR_ALL        0 // 所有节点
+#define LIN_ADDR_NODE       1 // 按 device_id
+#define LIN_ADDR_GROUP      2 // 按组掩码
+#define LIN_ADDR_SEL        3 // 被查询选中的节点
+#define LIN_ADDR_DIAG       4 // 仅在有待发数据时应答, 每份数据只发一次 (诊断应答)
+
+typedef void (*LinFrameHandler_t)(uint8_t *data);
+typedef uint8_t (*LinFrameBuilder_t)(uint8_t *data); // 返回 0 表示无数据可发
+
+typedef struct {
+    uint8_t len;
+    uint8_t dir;
+    uint8_t cksum;
+    uint8_t addr;               // 寻址方式
+    uint8_t slot;               // PUB: 应答缓冲槽
+    LinFrameHandler_t handler;  // SUB: 执行
+    LinFrameBuilder_t builder;  // PUB: 组数据
+} LinFrameDesc_t;
+
+// 处理函数声明
+#define LIN_SUB(id, len, ck, ad, fn) static void fn(uint8_t *data);
+#define LIN_PUB(id, len, ck, ad, fn) static uint8_t fn(uint8_t *data);
+#include "lin_frames.def"
+
+// 应答槽编号
+enum {
+#define LIN_SUB(id, len, ck, ad, fn)
+#define LIN_PUB(id, len, ck, ad, fn) LIN_SLOT_##fn,
+#include "lin_frames.def"
+    LIN_PUB_COUNT
+};
+
+// 按 6 位帧 ID 索引, 中断中 O(1) 查表; 未列出的 ID 为全 0 (LIN_DIR_NONE)
+static const LinFrameDesc_t lin_frame_table[64] = {
+#define LIN_SUB(id, len, ck, ad, fn) [id] = { len, LIN_DIR_SUB, ck, ad, 0, fn, NULL },
+#define LIN_PUB(id, len, ck, ad, fn) [id] = { len, LIN_DIR_PUB, ck, ad, LIN_SLOT_##fn, NULL, fn },
+#include "lin_frames.def"
+};
+
+static const uint8_t lin_pub_ids[LIN_PUB_COUNT] = {
+#define LIN_SUB(id, len, ck, ad, fn)
+#define LIN_PUB(id, len, ck, ad, fn) id,
+#include "lin_frames.def"
+};
+
+// 本节点接收过滤位图 (按帧 ID), 由主循环根据 device_id / 组掩码 / 查询选择刷新
+static volatile uint32_t lin_accept[2];
+static uint8_t lin_resp_selected = 1;   // 本节点是否应答 LIN_ADDR_SEL 帧 (单节点时默认应答)
+static uint32_t lin_accept_key = 0xFFFFFFFF; // 生成位图时的输入, 变化时重建
+
+// 从机应答: 主循环预先组好数据 + 校验和, 每个应答帧一组双缓冲;
+// 中断收到匹配 PID 后立即开始发送 (TXE 中断逐字节), 满足应答间隔要求
+static uint8_t lin_resp_buf[LIN_PUB_COUNT][2][9];
+static volatile uint8_t lin_resp_active[LIN_PUB_COUNT]; // 中断使用的缓冲
+static volatile uint8_t lin_resp_ready[LIN_PUB_COUNT];  // 活动缓冲数据有效 (LIN_ADDR_DIAG 发出后由中断清零)
+static uint8_t lin_resp_motor = 0;             // 反馈的电机 (0-based), 由 LIN_ID_QUERY 选择
+static const uint8_t * volatile lin_tx_ptr = NULL;
+static volatile uint8_t lin_tx_idx = 0;
+static volatile uint8_t lin_tx_len = 0;
+
+// 主机模式: BSP_Time 闹钟按调度表逐时隙发送帧头 (中断上下文), 应答在 USART3 中断中收集
+static volatile uint8_t lin_master_on = 0;
+static uint8_t lin_master_slot = 0;              // 下一个时隙
+static uint64_t lin_master_next_us = 0;          // 下一个时隙的开始时刻
+static uint8_t lin_master_tx[11];                // [0x55, PID, Data..., Checksum]
+static volatile uint8_t lin_master_tx_id = 0xFF; // 正在发送的帧 ID
+static uint8_t lin_master_sync_seq = 0;
+static volatile uint8_t lin_master_hdr = 0;      // 本机刚发出 Break: 回读的 LBD 不中止发送
+static volatile int8_t lin_master_expect = -1;   // 等待应答的时隙 (-1 = 无)
+static volatile uint8_t lin_master_collect = 0;  // 当前帧数据由主机收集
+static volatile uint32_t lin_master_cycles = 0;
+static LinMasterResp_t lin_master_resp[LIN_SCHED_MAX];
+static volatile uint8_t lin_rx_queue = 0;        // 当前帧为本节点接收帧, 校验通过后入队
+static void LIN_Master_Start(void);
+
+// 总线健康统计 (中断写, 主循环读)
+static volatile uint32_t lin_breaks = 0;
+static volatile uint32_t lin_err_cnt[LIN_ERR_COUNT];
+static volatile uint32_t lin_erase_ovr = 0;
+static volatile uint8_t lin_last_err = LIN_ERR_NONE;
+static volatile uint64_t lin_last_err_us = 0;
+static volatile uint64_t lin_last_activity_us = 0;
+static volatile uint16_t lin_id_rx[64];
+static volatile uint16_t lin_id_exec[64];
+
+// 中断上下文: 记录一次错误
+static void LIN_CountError(LinErrType_t type) {
+    lin_err_cnt[type]++;
+    lin_last_err = (uint8_t)type;
+    lin_last_err_us = BSP_Time_GetUs();
+}
+
+// 单生产者 (USART3 中断) / 单消费者 (主循环) 无锁帧队列
+// head 只由中断写, tail 只由主循环写, 下标自由递增, 取模访问
+#if (LIN_RXQ_SIZE & (LIN_RXQ_SIZE - 1)) != 0 || LIN_RXQ_SIZE > 128
+#error "LIN_RXQ_SIZE must be a power of 2 and <= 128"
+#endif
+
+typedef struct {
+    uint8_t id;
+    uint8_t data[8];
+    uint64_t t_us;  // Break 时刻
+} LinFrame_t;
+
+static LinFrame_t lin_rxq[LIN_RXQ_SIZE];
+static volatile uint8_t lin_rxq_head = 0;
+static volatile uint8_t lin_rxq_tail = 0;
+static volatile uint8_t lin_rxq_depth_max = 0;
+static volatile uint32_t lin_rxq_queued = 0;
+static volatile uint32_t lin_rxq_overflows = 0;
+static uint32_t lin_rxq_executed = 0;
+
+// 中断上下文: 入队, 队满丢弃新帧
+static void LIN_Queue_Push(uint8_t id, const volatile uint8_t *data, uint8_t len, uint64_t t_us) {
+    uint8_t head = lin_rxq_head;
+    uint8_t depth = (uint8_t)(head - lin_rxq_tail);
+    if (depth >= LIN_RXQ_SIZE) {
+        lin_rxq_overflows++;
+        return;
+    }
+
+    LinFrame_t *f = &lin_rxq[head & (LIN_RXQ_SIZE - 1)];
+    f->id = id;
+    for (uint8_t i = 0; i < 8; i++) f->data[i] = (i < len) ? data[i] : 0;
+    f->t_us = t_us;
+
+    __DMB(); // 帧内容先于 head 可见
+    lin_rxq_head = (uint8_t)(head + 1);
+    lin_rxq_queued++;
+    if (depth + 1 > lin_rxq_depth_max) lin_rxq_depth_max = (uint8_t)(depth + 1);
+    EventBus_Post(EVT_LIN_CMD); // 主循环不进入 WFI, 下一轮执行
+}
+
+// 计算受保护 ID (PID = P1 P0 ID5..ID0)
+static uint8_t LIN_CalcPID(uint8_t id) {
+    uint8_t p0 = ((id >> 0) ^ (id >> 1) ^ (id >> 2) ^ (id >> 4)) & 1u;
+    uint8_t p1 = (~((id >> 1) ^ (id >> 3) ^ (id >> 4) ^ (id >> 5))) & 1u;
+    return (uint8_t)((id & 0x3F) | (p0 << 6) | (p1 << 7));
 }
 
-// 校验和计算 (Classic or Enhanced)
+// 校验和计算: Enhanced 传入 PID, Classic 传入 0
 static uint8_t CalcChecksum(uint8_t id, const uint8_t *data, uint8_t len) {
     uint16_t sum = 0;
-    // Enhanced Checksum includes PID (ID)
-    // Classic only Data. Let's use Classic for simplicity or Enhanced if standard.
-    // 许多工具默认 Enhanced.
     sum += id; 
     
     for (int i = 0; i < len; i++) {
@@ -38,71 +185,268 @@ static uint8_t CalcChecksum(uint8_t id, const uint8_t *data, uint8_t len) {
     return (uint8_t)(~sum);
 }
 
-// 解析指令
-static void Execute_LIN_Command(uint8_t id, uint8_t *data) {
-    uint8_t motor_id, dir, cmd_type;
-    uint16_t speed, target_adc, tolerance, range_adc;
-    int32_t pulses;
+// ---------------- 帧处理 (主循环上下文) ----------------
+// [CMD(1=Run,2=Stop,3=Time), ID, Dir, SpdH, SpdL, TimeH, TimeL, Res]
+static void LIN_OnCmdRun(uint8_t *data) {
+    uint8_t cmd_type = data[0];
+    uint8_t motor_id = data[1]; // Byte 1 是 MotorID (1-based)
+    if (motor_id < 1 || motor_id > MAX_MOTORS) return;
+    uint8_t dir = data[2];
+    uint16_t speed = (data[3] << 8) | data[4];
+    uint16_t time_ms = (data[5] << 8) | data[6];
 
-    motor_id = data[1]; // 通用格式: Byte 1 是 MotorID (1-based)
+    App_Linkage_ReleaseMotor(motor_id - 1); // 停止占用该电机的联动
 
-    switch (id) {
-        case LIN_ID_CMD_RUN: // [CMD(1=Run,2=Stop,3=Time), ID, Dir, SpdH, SpdL, TimeH, TimeL, Res]
-            cmd_type = data[0];
-            if (motor_id < 1 || motor_id > MAX_MOTORS) return;
-            dir = data[2];
-            speed = (data[3] << 8) | data[4];
-            uint16_t time_ms = (data[5] << 8) | data[6];
+    if (cmd_type == 1) { // Manual Run
+        App_Motor_MoveManual(motor_id - 1, dir, speed);
+    } else if (cmd_type == 2) { // Stop
+        App_Motor_Stop(motor_id - 1);
+    } else if (cmd_type == 3) { // Time
+        App_Motor_MoveTime(motor_id - 1, dir, speed, time_ms);
+    }
+}
 
-            App_Linkage_SetMode(0, 1); // 停止联动
+// [ID, Dir, SpdH, SpdL, P3, P2, P1, P0]
+static void LIN_OnCmdPos(uint8_t *data) {
+    uint8_t motor_id = data[0];
+    if (motor_id < 1 || motor_id > MAX_MOTORS) return;
+    uint8_t dir = data[1];
+    uint16_t speed = (data[2] << 8) | data[3];
+    int32_t pulses = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
 
-            if (cmd_type == 1) { // Manual Run
-                App_Motor_MoveManual(motor_id - 1, dir, speed);
-            } else if (cmd_type == 2) { // Stop
-                App_Motor_Stop(motor_id - 1);
-            } else if (cmd_type == 3) { // Time
-                App_Motor_MoveTime(motor_id - 1, dir, speed, time_ms);
-            }
-            break;
+    App_Linkage_ReleaseMotor(motor_id - 1);
+    // 默认带限位
+    App_Motor_MovePosWithLimit(motor_id - 1, dir, speed, pulses);
+}
 
-        case LIN_ID_CMD_POS: // [CMD(Dummy), ID, Dir, SpdH, SpdL, Pos3, Pos2, Pos1, Pos0]
-            if (motor_id < 1 || motor_id > MAX_MOTORS) return;
-            dir = data[2];
-            speed = (data[3] << 8) | data[4];
-            pulses = (data[5] << 24) | (data[6] << 16) | (data[7] << 8) | data[8]; // Oops, index overflow?
-            // Frame is 8 bytes. data[0]..data[7].
-            // Re-map: [ID, Dir, SpdH, SpdL, P3, P2, P1, P0]
-            motor_id = data[0];
-            if (motor_id < 1 || motor_id > MAX_MOTORS) return;
-            dir = data[1];
-            speed = (data[2] << 8) | data[3];
-            pulses = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
-            
-            App_Linkage_SetMode(0, 1);
-            // 默认带限位
-            App_Motor_MovePosWithLimit(motor_id - 1, dir, speed, pulses);
-            break;
+// [ID, SpdH, SpdL, AdcH, AdcL, Tol, RngH, RngL]
+static void LIN_OnCmdAdc(uint8_t *data) {
+    uint8_t motor_id = data[0];
+    if (motor_id < 1 || motor_id > MAX_MOTORS) return;
+    uint16_t speed = (data[1] << 8) | data[2];
+    uint16_t target_adc = (data[3] << 8) | data[4];
+    uint16_t tolerance = data[5];
+    uint16_t range_adc = (data[6] << 8) | data[7];
+
+    App_Linkage_ReleaseMotor(motor_id - 1);
+    App_Motor_MoveAdcPosWithLimit(motor_id - 1, speed, target_adc, tolerance, range_adc);
+}
+
+// 同步启动: LIN_NCMD_START_AT 预置的总线启动时刻, 由该电机的下一条运动指令使用
+static uint8_t lin_start_armed[MAX_MOTORS];
+static uint64_t lin_start_at_bus[MAX_MOTORS];
+static uint64_t lin_cur_frame_us = 0; // 正在执行的帧的 Break 时刻 (本地时基)
 
-        case LIN_ID_CMD_ADC: // [ID, SpdH, SpdL, AdcH, AdcL, Tol, RngH, RngL]
-            motor_id = data[0];
-            if (motor_id < 1 || motor_id > MAX_MOTORS) return;
-            speed = (data[1] << 8) | data[2];
-            target_adc = (data[3] << 8) | data[4];
-            tolerance = data[5];
-            range_adc = (data[6] << 8) | data[7];
+// 32 位总线时刻 -> 与当前总线时间最接近的 64 位时刻
+static uint64_t LIN_ExpandBusTime(uint32_t t32) {
+    uint64_t now = BSP_Time_GetBusUs();
+    uint64_t t = (now & ~(uint64_t)0xFFFFFFFF) | t32;
+    if (t > now + 0x80000000ull) t -= 0x100000000ull;
+    else if (t + 0x80000000ull < now) t += 0x100000000ull;
+    return t;
+}
+
+// 取出并清除预置的启动时刻 (本地时基), 无预置或已过期返回 0
+static uint64_t LIN_TakeStartTime(uint8_t m) {
+    if (!lin_start_armed[m]) return 0;
+    lin_start_armed[m] = 0;
+    uint64_t at = BSP_Time_BusToLocal(lin_start_at_bus[m]);
+    if (at + LIN_START_AT_STALE_US < BSP_Time_GetUs()) {
+        LOG_WARN("Start time stale, motor %d starts now\r\n", m + 1);
+        return 0;
+    }
+    return at;
+}
+
+// 时间同步 (0x25): [Seq, 0, T5..T0] 主机 Break 时刻, 与本机同一 Break 的时刻配对校准
+static void LIN_OnTimeSync(uint8_t *data) {
+    uint64_t bus = 0;
+    for (int i = 2; i < 8; i++) bus = (bus << 8) | data[i];
+    BSP_Time_SyncSample(lin_cur_frame_us, bus);
+}
+
+// [MotorID, NodeID, ...] 选择后续 LIN_ID_RESP_STATUS 由哪个节点的哪个电机应答
+// NodeID = 0 时所有收到的节点都应答 (仅适用于单节点总线)
+static void LIN_OnQuery(uint8_t *data) {
+    uint8_t motor_id = data[0];
+    uint8_t node_id = data[1];
+    lin_resp_selected = (node_id == 0 || node_id == g_Config.device_id);
+    if (motor_id < 1 || motor_id > MAX_MOTORS) return;
+    lin_resp_motor = motor_id - 1;
+}
 
-            App_Linkage_SetMode(0, 1);
-            App_Motor_MoveAdcPosWithLimit(motor_id - 1, speed, target_adc, tolerance, range_adc);
+// 节点/组播/广播指令: [Cmd<<4 | Motor, ...]
+static void LIN_NodeCmdMotor(uint8_t m, uint8_t cmd, const uint8_t *data) {
+    uint64_t at = 0;
+    if (cmd == LIN_NCMD_TIME || cmd == LIN_NCMD_POS || cmd == LIN_NCMD_ADC) {
+        at = LIN_TakeStartTime(m);
+    }
+    switch (cmd) {
+        case LIN_NCMD_RUN:
+            App_Motor_MoveManual(m, data[1], (data[2] << 8) | data[3]);
+            break;
+        case LIN_NCMD_STOP:
+            App_Motor_Stop(m);
+            break;
+        case LIN_NCMD_TIME:
+            if (at) App_Motor_MoveTimeAt(m, at, data[1], (data[2] << 8) | data[3], (data[4] << 8) | data[5]);
+            else App_Motor_MoveTime(m, data[1], (data[2] << 8) | data[3], (data[4] << 8) | data[5]);
+            break;
+        case LIN_NCMD_POS: {
+            int32_t pulses = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+            if (at) App_Motor_MovePosAt(m, at, data[1], (data[2] << 8) | data[3], pulses, 1);
+            else App_Motor_MovePosWithLimit(m, data[1], (data[2] << 8) | data[3], pulses);
+            break;
+        }
+        case LIN_NCMD_ADC:
+            if (at) App_Motor_MoveAdcPosAt(m, at, (data[1] << 8) | data[2], (data[3] << 8) | data[4],
+                                           data[5], (data[6] << 8) | data[7], 1);
+            else App_Motor_MoveAdcPosWithLimit(m, (data[1] << 8) | data[2], (data[3] << 8) | data[4],
+                                               data[5], (data[6] << 8) | data[7]);
+            break;
+        case LIN_NCMD_START_AT:
+            lin_start_at_bus[m] = LIN_ExpandBusTime(((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) |
+                                                    ((uint32_t)data[3] << 8) | data[4]);
+            lin_start_armed[m] = 1;
+            break;
+        default:
             break;
-            
-        case LIN_ID_QUERY: // [ID, ...]
-             // 这里通常需要作为Slave发送响应。
-             // STM32 HAL LIN Slave 发送比较复杂，需要预先填充数据等到 Master 发送 Header。
-             // 暂不实现 Slave Response，仅实现接收控制。
-             break;
     }
 }
 
+static void LIN_OnNodeCmd(uint8_t *data) {
+    uint8_t cmd = data[0] >> 4;
+    uint8_t motor_id = data[0] & 0x0F;
+
+    if (cmd == LIN_NCMD_LINK) {
+        // 低 4 位: 联动实例 (1-based), 0 = 实例 0 且 Mode 0 时停止所有实例
+        if (motor_id == 0) {
+            App_Linkage_SetMode(data[1], (data[2] << 8) | data[3]);
+        } else if (motor_id <= LINK_INSTANCES) {
+            App_Linkage_Run(motor_id - 1, data[1], (data[2] << 8) | data[3]);
+        }
+        return;
+    }
+    if (motor_id > MAX_MOTORS) return;
+
+    for (uint8_t m = 0; m < MAX_MOTORS; m++) {
+        if (motor_id == 0 || motor_id == m + 1) {
+            App_Linkage_ReleaseMotor(m); // 停止占用该电机的联动
+            LIN_NodeCmdMotor(m, cmd, data);
+        }
+    }
+}
+
+// 重建接收过滤位图 (仅在 device_id / 组掩码 / 查询选择变化时)
+static void LIN_UpdateAcceptance(void) {
+    uint32_t node = g_Config.device_id;
+    uint32_t groups = g_Config.lin_group_mask & ((1u << LIN_GROUP_MAX) - 1);
+    uint32_t key = (node & 0xFF) | (groups << 8) | ((uint32_t)lin_resp_selected << 16);
+    if (key == lin_accept_key) return;
+    lin_accept_key = key;
+
+    uint32_t acc[2] = {0, 0};
+    for (uint8_t id = 0; id < 64; id++) {
+        const LinFrameDesc_t *d = &lin_frame_table[id];
+        uint8_t ok = 0;
+        if (d->dir == LIN_DIR_NONE) continue;
+        switch (d->addr) {
+            case LIN_ADDR_ALL:   ok = 1; break;
+            case LIN_ADDR_NODE:  ok = (node >= 1 && node <= LIN_NODE_MAX &&
+                                       id == LIN_ID_NODE_BASE + node - 1); break;
+            case LIN_ADDR_GROUP: ok = (groups >> (id - LIN_ID_GROUP_BASE)) & 1u; break;
+            case LIN_ADDR_SEL:   ok = lin_resp_selected; break;
+            case LIN_ADDR_DIAG:  ok = 1; break;
+            default: break;
+        }
+        if (ok) acc[id >> 5] |= 1u << (id & 31);
+    }
+    lin_accept[0] = acc[0];
+    lin_accept[1] = acc[1];
+}
+
+// 诊断请求 (0x3C), 传输层与服务见 lin_diag.c
+static void LIN_OnDiagRequest(uint8_t *data) {
+    lin_resp_ready[LIN_SLOT_LIN_BuildDiag] = 0; // 新请求作废尚未取走的应答分段
+    if (data[0] == LIN_DIAG_NAD_SLEEP) {
+        // 休眠指令 (0x3C, 00 FF FF FF FF FF FF FF): 不应答, 由主循环完成刹车与进入 Stop 模式
+        // NAD 0 的其它帧不是合法诊断请求, 丢弃
+        for (uint8_t i = 1; i < 8; i++) {
+            if (data[i] != 0xFF) return;
+        }
+        App_Power_RequestSleep(POWER_SLEEP_LIN_CMD);
+        return;
+    }
+    LIN_Diag_OnRequest(data);
+}
+
+// 诊断应答 (0x3D): 仅在有待发分段时应答
+static uint8_t LIN_BuildDiag(uint8_t *b) {
+    return LIN_Diag_NextResponse(b);
+}
+
+// 状态应答: [Busy<<7|ID, Err, PulseH, PulseL, Duty/4, Cur(0.1A), PosH, PosL]
+static uint8_t LIN_BuildStatus(uint8_t *b) {
+    uint8_t id = lin_resp_motor;
+    int32_t pulses = BSP_BLDC_GetPulse(id);
+    if (pulses > INT16_MAX) pulses = INT16_MAX;
+    if (pulses < INT16_MIN) pulses = INT16_MIN;
+    int32_t cur = (int32_t)(g_adc_data.current_A[id] * 10.0f);
+    if (cur < 0) cur = 0;
+    if (cur > 255) cur = 255;
+    uint16_t pos = g_adc_data.position[id];
+
+    b[0] = (uint8_t)((App_Motor_IsBusy(id) ? 0x80 : 0x00) | ((id + 1) & 0x7F));
+    b[1] = g_adc_data.error_code;
+    b[2] = (uint8_t)((uint16_t)pulses >> 8);
+    b[3] = (uint8_t)pulses;
+    b[4] = (uint8_t)(motors[id].state.current_duty / 4);
+    b[5] = (uint8_t)cur;
+    b[6] = (uint8_t)(pos >> 8);
+    b[7] = (uint8_t)pos;
+    return 1;
+}
+
+static uint8_t LIN_Sat8(uint32_t v) {
+    return (v > 255u) ? 255u : (uint8_t)v;
+}
+
+// 总线健康应答: [CksumErr, ParityErr, FrameErr, Overrun, Noise, SyncErr, IdleH, IdleL]
+static uint8_t LIN_BuildBusStatus(uint8_t *b) {
+    LinBusStat_t st;
+    App_LIN_GetBusStat(&st);
+    uint32_t idle = st.idle_ms / 10u;
+    if (idle > 0xFFFF) idle = 0xFFFF;
+
+    b[0] = LIN_Sat8(st.err[LIN_ERR_CHECKSUM]);
+    b[1] = LIN_Sat8(st.err[LIN_ERR_PARITY]);
+    b[2] = LIN_Sat8(st.err[LIN_ERR_FRAMING]);
+    b[3] = LIN_Sat8(st.err[LIN_ERR_OVERRUN]);
+    b[4] = LIN_Sat8(st.err[LIN_ERR_NOISE]);
+    b[5] = LIN_Sat8(st.err[LIN_ERR_SYNC]);
+    b[6] = (uint8_t)(idle >> 8);
+    b[7] = (uint8_t)idle;
+    return 1;
+}
+
+// 刷新所有应答帧: 组到非活动缓冲再切换
+static void LIN_RefreshResponses(void) {
+    for (uint8_t slot = 0; slot < LIN_PUB_COUNT; slot++) {
+        uint8_t id = lin_pub_ids[slot];
+        const LinFrameDesc_t *d = &lin_frame_table[id];
+        uint8_t next = lin_resp_active[slot] ^ 1u;
+        uint8_t *b = lin_resp_buf[slot][next];
+        // 另一缓冲仍在发送中 (上一帧应答未结束又切换过一次) 时本轮跳过
+        if (lin_tx_idx < lin_tx_len && lin_tx_ptr == b) continue;
+        // 一次性应答: 上一份数据尚未被主机取走
+        if (d->addr == LIN_ADDR_DIAG && lin_resp_ready[slot]) continue;
+
+        if (!d->builder(b)) continue;
+        b[d->len] = CalcChecksum((d->cksum == LIN_CKSUM_ENHANCED) ? LIN_CalcPID(id) : 0, b, d->len);
+        lin_resp_active[slot] = next;
+        lin_resp_ready[slot] = 1;
+    }
+}
 
 void App_LIN_Init(void) {
     // 1. 使能 PHY (TJA1021 SLP_N -> High)
@@ -115,12 +459,308 @@ void App_LIN_Init(void) {
     
     // 开启错误中断 (PE, FE, NE, ORE)
     __HAL_UART_ENABLE_IT(&LIN_UART_HANDLE, UART_IT_ERR);
+
+    // 3. 自动波特率: 每帧按 Sync 字段修正 BRR
+    BSP_LinBaud_Init();
     
+    LIN_Diag_Init();
+    LIN_UpdateAcceptance();
+    LIN_RefreshResponses();
+
+    // 4. 主机模式: 按保存的调度表运行 (需硬件主机端 1k 上拉)
+    if (g_Config.lin_master_en) LIN_Master_Start();
     // LOG("LIN Init OK\r\n");
 }
 
+uint64_t App_LIN_GetLastFrameTime(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint64_t t = lin_last_frame_us;
+    __set_PRIMASK(primask);
+    return t;
+}
+
+// 中断上下文: 收到应答帧 Header, 立即发送已准备好的数据
+static void LIN_StartResponse(const LinFrameDesc_t *d) {
+    if (!lin_resp_ready[d->slot]) return; // 无数据: 保持沉默
+    if (d->addr == LIN_ADDR_DIAG) lin_resp_ready[d->slot] = 0;
+    lin_id_exec[lin_pub_ids[d->slot]]++;
+    lin_tx_ptr = lin_resp_buf[d->slot][lin_resp_active[d->slot]];
+    lin_tx_len = d->len + 1;
+    lin_tx_idx = 1;
+    LIN_UART_HANDLE.Instance->DR = lin_tx_ptr[0];
+    SET_BIT(LIN_UART_HANDLE.Instance->CR1, USART_CR1_TXEIE);
+}
+
+static void LIN_AbortResponse(void) {
+    CLEAR_BIT(LIN_UART_HANDLE.Instance->CR1, USART_CR1_TXEIE);
+    lin_tx_len = 0;
+    lin_tx_idx = 0;
+}
+
+// ---------------- 主机模式 ----------------
+// 诊断帧使用 Classic 校验和, 其余按 LIN 2.x Enhanced
+static uint8_t LIN_MasterCksumSeed(uint8_t id, uint8_t pid) {
+    return (id >= LIN_ID_DIAG_REQ) ? 0 : pid;
+}
+
+static uint8_t LIN_SchedValid(const LinSchedEntry_t *e) {
+    return e->id <= 0x3F && e->len >= 1 && e->len <= 8 && e->dir <= LIN_SCHED_CMD;
+}
+
+// 闹钟回调 (TIM3 中断): 结束上一时隙, 发送下一时隙的帧头 (+ 指令数据)
+static void LIN_Master_OnSlot(uint8_t arg) {
+    (void)arg;
+    if (!lin_master_on) return;
+
+    if (lin_master_expect >= 0) {
+        lin_master_resp[lin_master_expect].no_resp++; // 上一时隙应答未收齐
+        lin_master_expect = -1;
+    }
+
+    // 取下一个有效时隙
+    const LinSchedEntry_t *e = NULL;
+    uint8_t idx = 0;
+    for (uint8_t n = 0; n < LIN_SCHED_MAX; n++) {
+        idx = lin_master_slot;
+        lin_master_slot = (uint8_t)((lin_master_slot + 1) % LIN_SCHED_MAX);
+        if (idx == 0) lin_master_cycles++;
+        if (LIN_SchedValid(&g_Config.lin_sched[idx])) {
+            e = &g_Config.lin_sched[idx];
+            break;
+        }
+    }
+    if (!e) {
+        lin_master_on = 0; // 空表
+        return;
+    }
+
+    uint8_t pid = LIN_CalcPID(e->id);
+    uint8_t n = 2;
+    lin_master_tx_id = e->id;
+    lin_master_tx[0] = 0x55;
+    lin_master_tx[1] = pid;
+    if (e->dir == LIN_SCHED_CMD) {
+        memcpy(&lin_master_tx[2], e->data, e->len);
+        lin_master_tx[2 + e->len] = CalcChecksum(LIN_MasterCksumSeed(e->id, pid), &lin_master_tx[2], e->len);
+        n = (uint8_t)(3 + e->len);
+    } else {
+        lin_master_resp[idx].id = e->id;
+        lin_master_resp[idx].len = e->len;
+        lin_master_expect = (int8_t)idx;
+    }
+
+    // Break 由 SBK 发出, DR 中的 0x55 在 Break 结束后紧接发送, 其余字节由 TXE 中断续发
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (lin_tx_idx < lin_tx_len) LIN_AbortResponse(); // 上一帧超出时隙
+    lin_master_hdr = 1;
+    lin_tx_ptr = lin_master_tx;
+    lin_tx_len = n;
+    lin_tx_idx = 1;
+    SET_BIT(LIN_UART_HANDLE.Instance->CR1, USART_CR1_SBK);
+    LIN_UART_HANDLE.Instance->DR = lin_master_tx[0];
+    SET_BIT(LIN_UART_HANDLE.Instance->CR1, USART_CR1_TXEIE);
+    __set_PRIMASK(primask);
+
+    // 按绝对时刻排下一时隙, 不累积回调延迟; 落后 (如调试暂停) 时重新对齐
+    uint64_t now = BSP_Time_GetUs();
+    lin_master_next_us += (uint64_t)e->delay_ms * 1000u;
+    if (lin_master_next_us <= now) lin_master_next_us = now + (uint64_t)e->delay_ms * 1000u;
+    BSP_Time_SetAlarm(BSP_TIME_ALARM_LIN, lin_master_next_us, LIN_Master_OnSlot, 0);
+}
+
+// USART3 中断 (本机 Break 的 LBD): 时间同步帧填入本帧 Break 时刻, 此时数据尚未发出
+static void LIN_Master_StampSync(uint64_t t_us) {
+    uint8_t *d = &lin_master_tx[2];
+    d[0] = lin_master_sync_seq++;
+    d[1] = 0;
+    for (int i = 0; i < 6; i++) d[2 + i] = (uint8_t)(t_us >> (40 - 8 * i));
+    d[8] = CalcChecksum(lin_master_tx[1], d, 8);
+}
+
+// 中断上下文: 保存一帧有效应答
+static void LIN_Master_Store(const volatile uint8_t *data, uint8_t len) {
+    LinMasterResp_t *r = &lin_master_resp[lin_master_expect];
+    for (uint8_t i = 0; i < len; i++) r->data[i] = data[i];
+    r->rx++;
+    r->last_us = lin_break_us;
+    lin_master_expect = -1;
+}
+
+static void LIN_Master_Start(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    lin_master_slot = 0;
+    lin_master_expect = -1;
+    lin_master_next_us = BSP_Time_GetUs() + 1000u;
+    lin_master_on = 1;
+    __set_PRIMASK(primask);
+    BSP_Time_SetAlarm(BSP_TIME_ALARM_LIN, lin_master_next_us, LIN_Master_OnSlot, 0);
+}
+
+static void LIN_Master_Stop(void) {
+    BSP_Time_CancelAlarm(BSP_TIME_ALARM_LIN);
+    lin_master_on = 0;
+    lin_master_expect = -1;
+}
+
+void App_LIN_MasterEnable(uint8_t enable) {
+    enable = enable ? 1 : 0;
+    if (enable) LIN_Master_Start();
+    else LIN_Master_Stop();
+    if (g_Config.lin_master_en != enable) {
+        g_Config.lin_master_en = enable;
+        App_Storage_Save();
+    }
+}
+
+uint8_t App_LIN_MasterIsEnabled(void) {
+    return lin_master_on;
+}
+
+uint32_t App_LIN_MasterGetCycles(void) {
+    return lin_master_cycles;
+}
+
+uint8_t App_LIN_MasterSetSlot(uint8_t idx, const LinSchedEntry_t *entry) {
+    if (idx >= LIN_SCHED_MAX) return 0;
+    LinSchedEntry_t e;
+    memset(&e, 0, sizeof(e));
+    e.id = LIN_SCHED_EMPTY;
+    if (entry) {
+        e = *entry;
+        if (e.id == LIN_ID_TIME_SYNC) {
+            e.dir = LIN_SCHED_CMD; // 数据在发送时填充
+            e.len = 8;
+        }
+        if (!LIN_SchedValid(&e) || e.delay_ms < LIN_SCHED_MIN_MS(e.len)) return 0;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    g_Config.lin_sched[idx] = e;
+    memset(&lin_master_resp[idx], 0, sizeof(LinMasterResp_t));
+    if (lin_master_expect == (int8_t)idx) lin_master_expect = -1;
+    __set_PRIMASK(primask);
+
+    App_Storage_Save();
+    // 调度表曾为空而自动停止时重新启动
+    if (g_Config.lin_master_en && !lin_master_on) LIN_Master_Start();
+    return 1;
+}
+
+uint8_t App_LIN_MasterSetData(uint8_t idx, const uint8_t *data, uint8_t len) {
+    if (idx >= LIN_SCHED_MAX || !data) return 0;
+    LinSchedEntry_t *e = &g_Config.lin_sched[idx];
+    if (!LIN_SchedValid(e) || e->dir != LIN_SCHED_CMD || len != e->len) return 0;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(e->data, data, len);
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+uint8_t App_LIN_MasterGetResp(uint8_t idx, LinMasterResp_t *resp) {
+    if (idx >= LIN_SCHED_MAX || !resp) return 0;
+    if (!LIN_SchedValid(&g_Config.lin_sched[idx]) || g_Config.lin_sched[idx].dir != LIN_SCHED_RESP) return 0;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *resp = lin_master_resp[idx];
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+// 进入休眠: 放弃进行中的帧与应答, 收发器进入 Sleep (SLP_N -> Low)
+void App_LIN_Sleep(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (lin_tx_idx < lin_tx_len) LIN_AbortResponse();
+    lin_state = LIN_STATE_IDLE;
+    __set_PRIMASK(primask);
+    HAL_GPIO_WritePin(LIN_SLEEP_GPIO_Port, LIN_SLEEP_Pin, GPIO_PIN_RESET);
+}
+
+// 唤醒: 收发器回到 Normal 模式; 唤醒脉冲本身产生的 Break/错误字节不影响下一帧
+void App_LIN_Wake(void) {
+    HAL_GPIO_WritePin(LIN_SLEEP_GPIO_Port, LIN_SLEEP_Pin, GPIO_PIN_SET);
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    __IO uint32_t tmpreg;
+    tmpreg = LIN_UART_HANDLE.Instance->SR;
+    tmpreg = LIN_UART_HANDLE.Instance->DR;
+    (void)tmpreg;
+    __HAL_UART_CLEAR_FLAG(&LIN_UART_HANDLE, UART_FLAG_LBD);
+    lin_state = LIN_STATE_IDLE;
+    lin_last_activity_us = BSP_Time_GetUs(); // 空闲超时从唤醒时刻重新计时
+    __set_PRIMASK(primask);
+}
+
+void App_LIN_GetBusStat(LinBusStat_t *stat) {
+    if (!stat) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stat->breaks = lin_breaks;
+    for (int i = 0; i < LIN_ERR_COUNT; i++) stat->err[i] = lin_err_cnt[i];
+    stat->erase_overruns = lin_erase_ovr;
+    stat->last_err = lin_last_err;
+    stat->last_err_us = lin_last_err_us;
+    uint64_t last = lin_last_activity_us;
+    __set_PRIMASK(primask);
+    stat->idle_ms = (uint32_t)((BSP_Time_GetUs() - last) / 1000u);
+}
+
+void App_LIN_GetIdStat(uint8_t id, uint16_t *rx, uint16_t *exec) {
+    if (id >= 64) return;
+    if (rx) *rx = lin_id_rx[id];
+    if (exec) *exec = lin_id_exec[id];
+}
+
+void App_LIN_ClearStats(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    lin_breaks = 0;
+    for (int i = 0; i < LIN_ERR_COUNT; i++) lin_err_cnt[i] = 0;
+    for (int i = 0; i < 64; i++) {
+        lin_id_rx[i] = 0;
+        lin_id_exec[i] = 0;
+    }
+    lin_last_err = LIN_ERR_NONE;
+    lin_last_err_us = 0;
+    lin_rxq_queued = 0;
+    lin_rxq_executed = 0;
+    lin_rxq_overflows = 0;
+    lin_rxq_depth_max = 0;
+    __set_PRIMASK(primask);
+}
+
+void App_LIN_GetQueueStat(LinQueueStat_t *stat) {
+    if (!stat) return;
+    uint8_t head = lin_rxq_head;
+    stat->queued = lin_rxq_queued;
+    stat->executed = lin_rxq_executed;
+    stat->overflows = lin_rxq_overflows;
+    stat->depth = (uint8_t)(head - lin_rxq_tail);
+    stat->depth_max = lin_rxq_depth_max;
+}
+
+// 主循环中调用 (电机状态机之前): 中断只负责收帧校验, 命令在此统一执行
 void App_LIN_Process(void) {
-    // 轮询或处理复杂逻辑，当前逻辑全在中断中完成解析，这里留空即可
+    while (lin_rxq_tail != lin_rxq_head) {
+        __DMB(); // 先读 head 再读帧内容
+        LinFrame_t *f = &lin_rxq[lin_rxq_tail & (LIN_RXQ_SIZE - 1)];
+        lin_cur_frame_us = f->t_us;
+        lin_frame_table[f->id].handler(f->data);
+        lin_id_exec[f->id]++;
+        lin_rxq_executed++;
+        lin_rxq_tail = (uint8_t)(lin_rxq_tail + 1);
+    }
+
+    // 刷新过滤位图与应答缓冲
+    LIN_Diag_Process();
+    LIN_UpdateAcceptance();
+    LIN_RefreshResponses();
 }
 
 // 供 HAL_UART_ErrorCallback 调用
@@ -153,30 +793,102 @@ void App_LIN_IRQHandler(void) {
     // 1. 检测到 Break (LBD)
     if ((isrflags & USART_SR_LBD) && (cr2its & USART_CR2_LBDIE)) {
         __HAL_UART_CLEAR_FLAG(&LIN_UART_HANDLE, UART_FLAG_LBD);
+        lin_break_us = BSP_Time_GetUs();
+        lin_last_activity_us = lin_break_us;
+        lin_breaks++;
+        BSP_LinBaud_Arm();
+        if (lin_master_hdr) {
+            lin_master_hdr = 0; // 本机发出的 Break, 帧头继续发送
+            if (lin_master_tx_id == LIN_ID_TIME_SYNC) LIN_Master_StampSync(lin_break_us);
+        } else if (lin_tx_idx < lin_tx_len) {
+            LIN_AbortResponse(); // 应答中收到 Break: 放弃本帧
+        }
         lin_state = LIN_STATE_BREAK;
         // 等待 Sync Field (0x55)
     }
     
-    // 2. 接收数据 (RXNE)
+    // 2. 应答发送 (TXE)
+    if ((isrflags & USART_SR_TXE) && (cr1its & USART_CR1_TXEIE)) {
+        if (lin_tx_idx < lin_tx_len) {
+            LIN_UART_HANDLE.Instance->DR = lin_tx_ptr[lin_tx_idx++];
+        }
+        if (lin_tx_idx >= lin_tx_len) {
+            CLEAR_BIT(LIN_UART_HANDLE.Instance->CR1, USART_CR1_TXEIE);
+        }
+    }
+
+    // 3. 接收数据 (RXNE)
     if ((isrflags & USART_SR_RXNE) && (cr1its & USART_CR1_RXNEIE)) {
         uint8_t data = (uint8_t)(LIN_UART_HANDLE.Instance->DR & 0xFF);
-        
+        lin_last_activity_us = BSP_Time_GetUs();
+
+        // 错误标志随 RXNE 一起到达 (读 SR 后读 DR 已清除)
+        if (isrflags & USART_SR_ORE) {
+            if (BSP_Flash_EraseBacklog()) lin_erase_ovr++; // 擦除期间中断暂停, 总线照常收发
+            else LIN_CountError(LIN_ERR_OVERRUN);
+        }
+        if (isrflags & USART_SR_NE)  LIN_CountError(LIN_ERR_NOISE);
+        if (isrflags & USART_SR_PE)  LIN_CountError(LIN_ERR_PARITY);
+        if (isrflags & USART_SR_FE) {
+            // Break 本身表现为带 FE 的 0x00, 仅统计帧内字节的 FE
+            if (data != 0x00 && lin_state != LIN_STATE_IDLE && lin_state != LIN_STATE_BREAK) {
+                LIN_CountError(LIN_ERR_FRAMING);
+            }
+        }
+        if (isrflags & (USART_SR_ORE | USART_SR_NE | USART_SR_FE)) {
+            if (lin_state == LIN_STATE_DATA || lin_state == LIN_STATE_CHECKSUM) {
+                lin_state = LIN_STATE_IDLE; // 帧内字节损坏: 放弃本帧
+            }
+        }
+
         switch (lin_state) {
             case LIN_STATE_BREAK:
-                if (data == 0x55) {
+                // 已按 Sync 字段重设 BRR 时, 该字节在改速前后采样, 读数不可信
+                if (data == 0x55 || BSP_LinBaud_Synced()) {
                     lin_state = LIN_STATE_SYNC;
                 } else {
                     lin_state = LIN_STATE_IDLE; // Sync Error
+                    LIN_CountError(LIN_ERR_SYNC);
                 }
                 break;
                 
-            case LIN_STATE_SYNC:
-                lin_current_id = data; // PID (Frame ID + Parity)
-                // 这里应该校验 PID Parity，简化跳过
-                lin_data_len = GetLenFromID(lin_current_id & 0x3F);
+            case LIN_STATE_SYNC: {
+                // PID (Frame ID + Parity): 校验奇偶并查表
+                uint8_t id = data & 0x3F;
+                const LinFrameDesc_t *d = &lin_frame_table[id];
+                lin_state = LIN_STATE_IDLE;
+                if (LIN_CalcPID(id) != data) {
+                    LIN_CountError(LIN_ERR_PARITY);
+                    break; // 奇偶错误, 丢弃整帧
+                }
+                uint8_t accepted = (lin_accept[id >> 5] & (1u << (id & 31))) != 0;
+                // 主机模式: 本时隙等待的应答 (其他节点或本节点发出) 由主机收集
+                lin_master_collect = (lin_master_expect >= 0 && g_Config.lin_sched[lin_master_expect].id == id);
+                lin_rx_queue = 0;
+                if (accepted) {
+                    lin_id_rx[id]++;
+                    if (d->dir == LIN_DIR_PUB) {
+                        // 从机应答帧: 发送预备数据, 回读的自身数据在 IDLE 状态下被忽略
+                        LIN_StartResponse(d);
+                    } else {
+                        lin_rx_queue = 1;
+                    }
+                }
+                if (!lin_rx_queue && !lin_master_collect) {
+                    break; // 其他节点的帧: 保持 IDLE, 后续数据直接忽略
+                }
+                lin_current_id = data;
+                if (accepted) {
+                    lin_data_len = d->len;
+                    lin_cksum_pid = (d->cksum == LIN_CKSUM_ENHANCED) ? data : 0;
+                } else {
+                    lin_data_len = g_Config.lin_sched[lin_master_expect].len;
+                    lin_cksum_pid = LIN_MasterCksumSeed(id, data);
+                }
                 lin_data_idx = 0;
                 lin_state = LIN_STATE_DATA;
                 break;
+            }
                 
             case LIN_STATE_DATA:
                 lin_rx_buffer[lin_data_idx++] = data;
@@ -187,10 +899,22 @@ void App_LIN_IRQHandler(void) {
                 
             case LIN_STATE_CHECKSUM:
                 // 校验 Checksum
-                 uint8_t expected = CalcChecksum(lin_current_id, (uint8_t*)lin_rx_buffer, lin_data_len);
+                 uint8_t expected = CalcChecksum(lin_cksum_pid, (uint8_t*)lin_rx_buffer, lin_data_len);
                  if (data == expected) {
-                    // 校验过，执行命令
-                    Execute_LIN_Command(lin_current_id & 0x3F, (uint8_t*)lin_rx_buffer);
+                    // 校验过，入队由主循环执行 (电机/联动接口非中断安全)
+                    lin_last_frame_us = lin_break_us;
+                    if (lin_rx_queue) {
+                        LIN_Queue_Push(lin_current_id & 0x3F, lin_rx_buffer, lin_data_len, lin_break_us);
+                    }
+                    if (lin_master_collect && lin_master_expect >= 0) {
+                        LIN_Master_Store(lin_rx_buffer, lin_data_len);
+                    }
+                 } else {
+                    LIN_CountError(LIN_ERR_CHECKSUM);
+                    if (lin_master_collect && lin_master_expect >= 0) {
+                        lin_master_resp[lin_master_expect].errors++;
+                        lin_master_expect = -1;
+                    }
                  }
                 lin_state = LIN_STATE_IDLE;
                 break;
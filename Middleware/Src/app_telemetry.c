@@ -0,0 +1,164 @@
+#include "app_telemetry.h"
+#include "app_adc.h"
+#include "app_linkage.h"
+#include "bsp_bldc.h"
+#include "uart_tx.h"
+
+// 订阅状态 (主循环写, TIM3 中断读)
+static UART_HandleTypeDef *telem_uart = NULL;
+static volatile uint8_t  telem_mask = 0;
+static volatile uint8_t  telem_fmt = TELEM_FMT_CSV;
+static volatile uint16_t telem_period = 0; // 单位: TIM3 节拍 (100us)
+static uint16_t telem_countdown = 0;
+static uint8_t  telem_seq = 0;
+
+// 双缓冲: 一块由 DMA 发送, 另一块用于组下一帧
+#define TELEM_BUF_SIZE  (48 + 36 * MAX_MOTORS) // 按 CSV 最坏长度估算
+static uint8_t telem_buf[2][TELEM_BUF_SIZE];
+static uint8_t telem_buf_idx = 0;
+
+static TelemStats_t telem_stats;
+
+void App_Telemetry_Init(UART_HandleTypeDef *huart) {
+    telem_uart = huart;
+    telem_mask = 0;
+    telem_period = 0;
+    telem_stats.frames_sent = 0;
+    telem_stats.frames_dropped = 0;
+}
+
+int8_t App_Telemetry_Subscribe(uint8_t mask, uint16_t rate_hz, TelemFormat_t fmt) {
+    if (mask == 0) {
+        telem_mask = 0;
+        return 0;
+    }
+    if (rate_hz == 0 || rate_hz > TELEM_RATE_MAX) return -1;
+    if (fmt != TELEM_FMT_CSV && fmt != TELEM_FMT_BIN) return -1;
+
+    // 先关闭再更新参数, 避免中断读到一半的配置
+    telem_mask = 0;
+    telem_fmt = (uint8_t)fmt;
+    telem_period = (uint16_t)(TELEM_TICK_HZ / rate_hz);
+    telem_countdown = telem_period;
+    telem_mask = mask;
+    return 0;
+}
+
+void App_Telemetry_GetStats(TelemStats_t *stats) {
+    if (stats) *stats = telem_stats;
+}
+
+// --- 二进制编码 (小端) ---
+static uint8_t *Put_U16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *Put_U32(uint8_t *p, uint32_t v) {
+    p = Put_U16(p, (uint16_t)v);
+    return Put_U16(p, (uint16_t)(v >> 16));
+}
+
+// --- CSV 编码: 中断内使用, 不依赖 printf ---
+static uint8_t *Put_Dec(uint8_t *p, int32_t v) {
+    char tmp[11];
+    uint8_t n = 0;
+    uint32_t u = (v < 0) ? (0u - (uint32_t)v) : (uint32_t)v;
+
+    if (v < 0) *p++ = '-';
+    do {
+        tmp[n++] = (char)('0' + (u % 10));
+        u /= 10;
+    } while (u != 0);
+    while (n > 0) *p++ = (uint8_t)tmp[--n];
+    *p++ = ',';
+    return p;
+}
+
+// 按字段顺序采样一份快照并编码; 多电机时逐个电机输出电机相关字段
+static uint16_t Build_Frame(uint8_t *buf, uint8_t mask, uint8_t fmt) {
+    uint8_t *p = buf;
+    uint8_t *payload;
+
+    if (fmt == TELEM_FMT_BIN) {
+        *p++ = TELEM_BIN_SYNC0;
+        *p++ = TELEM_BIN_SYNC1;
+        *p++ = telem_seq++;
+        *p++ = mask;
+        p++; // Len 占位
+        payload = p;
+
+        for (int i = 0; i < MAX_MOTORS; i++) {
+            if (mask & TELEM_F_PULSES)   p = Put_U32(p, (uint32_t)motors[i].state.pulse_count);
+            if (mask & TELEM_F_SPEED)    p = Put_U16(p, motors[i].state.current_duty);
+            if (mask & TELEM_F_CURRENT)  p = Put_U16(p, (uint16_t)(int16_t)(g_adc_data.current_A[i] * 1000.0f));
+            if (mask & TELEM_F_POSITION) p = Put_U16(p, g_adc_data.position[i]);
+        }
+        if (mask & TELEM_F_VOLTAGE) p = Put_U16(p, (uint16_t)(g_adc_data.voltage_V * 100.0f));
+        if (mask & TELEM_F_TEMP)    p = Put_U16(p, (uint16_t)(int16_t)(g_adc_data.temperature_C * 10.0f));
+        if (mask & TELEM_F_ERROR)   *p++ = g_adc_data.error_code;
+        if (mask & TELEM_F_LINK) {
+            *p++ = App_Linkage_GetMode();
+            *p++ = App_Linkage_GetStep();
+        }
+
+        payload[-1] = (uint8_t)(p - payload);
+
+        // 累加和 (Seq 起到 Payload 结束)
+        uint8_t sum = 0;
+        for (uint8_t *q = buf + 2; q < p; q++) sum += *q;
+        *p++ = sum;
+    } else {
+        static const uint8_t prefix[] = "+TLM:";
+        for (uint8_t k = 0; k < sizeof(prefix) - 1; k++) *p++ = prefix[k];
+
+        for (int i = 0; i < MAX_MOTORS; i++) {
+            if (mask & TELEM_F_PULSES)   p = Put_Dec(p, motors[i].state.pulse_count);
+            if (mask & TELEM_F_SPEED)    p = Put_Dec(p, motors[i].state.current_duty);
+            if (mask & TELEM_F_CURRENT)  p = Put_Dec(p, (int32_t)(g_adc_data.current_A[i] * 1000.0f));
+            if (mask & TELEM_F_POSITION) p = Put_Dec(p, g_adc_data.position[i]);
+        }
+        if (mask & TELEM_F_VOLTAGE) p = Put_Dec(p, (int32_t)(g_adc_data.voltage_V * 100.0f));
+        if (mask & TELEM_F_TEMP)    p = Put_Dec(p, (int32_t)(g_adc_data.temperature_C * 10.0f));
+        if (mask & TELEM_F_ERROR)   p = Put_Dec(p, g_adc_data.error_code);
+        if (mask & TELEM_F_LINK) {
+            p = Put_Dec(p, App_Linkage_GetMode());
+            p = Put_Dec(p, App_Linkage_GetStep());
+        }
+
+        p[-1] = '\r'; // 覆盖最后一个逗号
+        *p++ = '\n';
+    }
+
+    return (uint16_t)(p - buf);
+}
+
+// TIM3 中断上下文 (10kHz)
+void App_Telemetry_OnTick(void) {
+    uint8_t mask = telem_mask;
+    if (mask == 0 || telem_uart == NULL) return;
+
+    if (telem_countdown > 1) {
+        telem_countdown--;
+        return;
+    }
+    telem_countdown = telem_period;
+
+    // 上一帧 DMA 未完成或 AT/Log 正在发送 (含被本中断打断的阻塞发送): 丢弃本帧, 不等待
+    if (!UartTx_TryAcquire(telem_uart)) {
+        telem_stats.frames_dropped++;
+        return;
+    }
+
+    uint8_t *buf = telem_buf[telem_buf_idx];
+    uint16_t len = Build_Frame(buf, mask, telem_fmt);
+
+    if (HAL_UART_Transmit_DMA(telem_uart, buf, len) == HAL_OK) {
+        telem_buf_idx ^= 1;
+        telem_stats.frames_sent++;
+    } else {
+        telem_stats.frames_dropped++;
+    }
+    UartTx_Release();
+}
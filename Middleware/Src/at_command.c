@@ -1,11 +1,13 @@
 #include "at_command.h"
 //#include "cmd_motor.h"
 //#include "cmd_parser.h"
+#define LOG_MODULE LOG_MOD_AT
 #include "log.h"
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h> // for abs if needed
+#include <strings.h>
 
 #include "app_motor.h"    // 引用业务层接口
 #include "app_linkage.h"  // 引用联动接口
@@ -13,9 +15,23 @@
 #include "bsp_bldc.h"     // 引用底层获取状态
 
 #include "app_lin.h"
+#include "app_telemetry.h"
 #include "app_main.h"     // 引用主应用配置(DeviceID/Ver)
 #include "app_storage.h"
+#include "flash_kv.h"
+#include "flash_job.h"
+#include "event_bus.h"
+#include "uart_tx.h"
+#include "app_param.h"
+#include "app_power.h"
+#include "app_snapshot.h"
+#include "app_fault.h"
+#include "app_integrity.h"
+#include "app_linkprog.h"
 #include "bsp_conf.h"     // 引用硬件配置(LIN_UART_HANDLE)
+#include "bsp_lin_baud.h"
+#include "bsp_time.h"
+#include "bsp_crc.h"
 
 
 // 接收缓冲区
@@ -28,6 +44,14 @@ static uint16_t at_cmd_len = 0;
 // 用于通信的 UART 句柄
 static UART_HandleTypeDef *at_uart;
 
+// 波特率协商状态: 切换后需在超时前收到 AT+BAUDOK, 否则回退
+static const uint32_t at_baud_table[] = {
+    9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000, 2000000
+};
+static bool at_baud_pending = false;
+static uint32_t at_baud_prev = 0;
+static uint32_t at_baud_deadline = 0;
+
 
 // --- 内部函数声明 ---
 static AtCmdStatus_t Process_Run(char *params);
@@ -36,6 +60,7 @@ static AtCmdStatus_t Process_Pos(char *params);
 static AtCmdStatus_t Process_Stop(char *params);
 static AtCmdStatus_t Process_Query(char *params);
 static AtCmdStatus_t Process_Link(char *params);
+static AtCmdStatus_t Process_LinkList(void);
 // 新增指令声明
 static AtCmdStatus_t Process_AdcMove(char *params);
 static AtCmdStatus_t Process_AdcMoveLim(char *params);
@@ -43,6 +68,39 @@ static AtCmdStatus_t Process_CfgDecel(char *params);
 static AtCmdStatus_t Process_GetAdc(char *params);
 static AtCmdStatus_t Process_SetID(char *params);
 static AtCmdStatus_t Process_Info(void);
+static AtCmdStatus_t Process_Sub(char *params);
+static AtCmdStatus_t Process_SubStat(void);
+static AtCmdStatus_t Process_Baud(char *params);
+static AtCmdStatus_t Process_BaudOk(void);
+static AtCmdStatus_t Process_LogLvl(char *params);
+static AtCmdStatus_t Process_LogRate(char *params);
+static AtCmdStatus_t Process_LogStat(void);
+static AtCmdStatus_t Process_LinStat(void);
+static AtCmdStatus_t Process_LinStatClear(char *params);
+static AtCmdStatus_t Process_LinSleep(char *params);
+static AtCmdStatus_t Process_LinSleepQuery(void);
+static AtCmdStatus_t Process_Sleep(void);
+static AtCmdStatus_t Process_LinMaster(char *params);
+static AtCmdStatus_t Process_LinMasterQuery(void);
+static AtCmdStatus_t Process_LinSched(char *params);
+static AtCmdStatus_t Process_LinSchedQuery(void);
+static AtCmdStatus_t Process_LinResp(void);
+static AtCmdStatus_t Process_TSync(void);
+static AtCmdStatus_t Process_CfgStat(void);
+static AtCmdStatus_t Process_Param(char *params);
+static AtCmdStatus_t Process_ParamList(void);
+static AtCmdStatus_t Process_ParamSave(void);
+static AtCmdStatus_t Process_ParamReset(void);
+static AtCmdStatus_t Process_LinGrp(char *params);
+static AtCmdStatus_t Process_Snap(void);
+static AtCmdStatus_t Process_Fault(char *params);
+static AtCmdStatus_t Process_FaultList(void);
+static AtCmdStatus_t Process_SetPos(char *params);
+static AtCmdStatus_t Process_Crc(char *params);
+static AtCmdStatus_t Process_CrcCheck(void);
+static AtCmdStatus_t Process_Prog(char *params);
+static AtCmdStatus_t Process_ProgList(void);
+static AtCmdStatus_t Process_EventStat(void);
 
 // 初始化 AT 命令处理器
 void AT_Init(UART_HandleTypeDef *huart) {
@@ -75,6 +133,14 @@ void AT_MainLoopHandler(void) {
         at_cmd_ready = false;
         AT_ProcessCommand(at_cmd_buffer);
     }
+
+    // 波特率切换未被确认: 回退到原波特率
+    if (at_baud_pending && (int32_t)(HAL_GetTick() - at_baud_deadline) >= 0) {
+        if (AT_ApplyBaudRate(at_baud_prev) != HAL_BUSY) { // 串口忙时下一轮重试
+            at_baud_pending = false;
+            LOG_WARN("Baud switch not confirmed, fallback to %lu\r\n", at_baud_prev);
+        }
+    }
     
     // 执行其他周期性任务
     //MotorCmd_PeriodicHandler();
@@ -93,8 +159,8 @@ void AT_UART_IdleCallback(UART_HandleTypeDef *huart) {
         uint16_t dma_counter = __HAL_DMA_GET_COUNTER(huart->hdmarx);
         at_cmd_len = AT_RX_BUFFER_SIZE - dma_counter;
         
-        // 暂停DMA接收
-        HAL_StatusTypeDef status = HAL_UART_DMAStop(huart);
+        // 暂停DMA接收 (仅中止接收, 不影响正在进行的遥测 TX DMA)
+        HAL_StatusTypeDef status = HAL_UART_AbortReceive(huart);
         if (status != HAL_OK) {
             LOG_WARN("Failed to stop DMA, status: %d\r\n", status);
         }
@@ -113,19 +179,22 @@ void AT_UART_IdleCallback(UART_HandleTypeDef *huart) {
             
             at_cmd_buffer[at_cmd_len] = '\0';
             
-            LOG_DEBUG("Command received: %s\r\n", at_cmd_buffer);
+            // 只记录长度: 延迟日志模式下 RAM 中的字符串无法还原 (log.h)
+            LOG_DEBUG("Command received: len=%d\r\n", at_cmd_len);
             
             // 设置命令就绪标志
             at_cmd_ready = true;
             
-            // 优先处理关键命令
-            if (strstr(at_cmd_buffer, "AT+STOP") != NULL ) {
-                
-                // 立即处理停止类命令
-                AT_ProcessCommand(at_cmd_buffer);
-                at_cmd_ready = false;
-                
-                LOG_INFO("Priority command processed immediately\r\n");
+            // 停止命令在中断中先刹车 (App_Motor_Stop 可在中断中调用);
+            // 联动停止与应答仍由主循环执行, 避免与联动解释器争用状态
+            const char *stop = strstr(at_cmd_buffer, "AT+STOP=");
+            int id;
+            if (stop != NULL && sscanf(stop + 8, "%d", &id) == 1) {
+                if (id == 0) {
+                    for (int i = 0; i < MAX_MOTORS; i++) App_Motor_Stop(i);
+                } else if (id > 0 && id <= MAX_MOTORS) {
+                    App_Motor_Stop(id - 1);
+                }
             }
         }
         
@@ -174,7 +243,7 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 
         // 2. 必须重新开启接收中断，否则后续无法接收数据
 		 // 暂停DMA接收 (并在HAL内部清除相关状态)
-        HAL_UART_DMAStop(huart);
+        HAL_UART_AbortReceive(huart);
         
         // 清空缓冲区 (可选)
         memset(at_rx_buffer, 0, AT_RX_BUFFER_SIZE);
@@ -208,11 +277,54 @@ void AT_SendResponse(const char *format, ...) {
         buffer[len++] = '\r';
         buffer[len++] = '\n';
         
+        // 遥测 / 日志 DMA 可能正在发送: 主循环中短暂等待并占用串口 (中断内不等待)
+        if (!UartTx_Acquire(at_uart, UART_TX_WAIT_MS)) return;
+
         // 通过 UART 发送
         HAL_UART_Transmit(at_uart, (uint8_t*)buffer, len, 100);
+        UartTx_Release();
     }
 } 
 
+void AT_SendBinary(const uint8_t *data, uint16_t len) {
+    if (!UartTx_Acquire(at_uart, UART_TX_WAIT_MS)) return;
+    HAL_UART_Transmit(at_uart, (uint8_t *)data, len, 100 + len / 8u);
+    UartTx_Release();
+}
+
+bool AT_IsValidBaudRate(uint32_t baud) {
+    for (uint32_t i = 0; i < sizeof(at_baud_table) / sizeof(at_baud_table[0]); i++) {
+        if (at_baud_table[i] == baud) return true;
+    }
+    return false;
+}
+
+/**
+  * @brief  以新波特率重新初始化 AT 串口并重启 DMA 接收
+  * @note   会等待当前发送 (含遥测 DMA) 完成后再切换; 等待超时返回 HAL_BUSY, 串口保持原波特率
+  */
+HAL_StatusTypeDef AT_ApplyBaudRate(uint32_t baud) {
+    if (!at_uart || !AT_IsValidBaudRate(baud)) return HAL_ERROR;
+    if (at_uart->Init.BaudRate == baud) return HAL_OK;
+
+    // 占用串口 (切换期间遥测 / 日志不会启动发送), 再等待发送移位寄存器清空, 保证旧波特率下的应答完整发出;
+    // 占用失败说明 DMA 发送仍在进行, 此时重新初始化会打断它并留下错乱的占用状态, 不切换
+    if (!UartTx_Acquire(at_uart, 50)) return HAL_BUSY;
+    uint32_t t0 = HAL_GetTick();
+    while (!__HAL_UART_GET_FLAG(at_uart, UART_FLAG_TC) && (HAL_GetTick() - t0) < 50) {
+    }
+
+    HAL_UART_AbortReceive(at_uart);
+    at_uart->Init.BaudRate = baud;
+    HAL_StatusTypeDef status = HAL_UART_Init(at_uart);
+    UartTx_Release();
+
+    memset(at_rx_buffer, 0, AT_RX_BUFFER_SIZE);
+    __HAL_UART_ENABLE_IT(at_uart, UART_IT_IDLE);
+    HAL_UART_Receive_DMA(at_uart, at_rx_buffer, AT_RX_BUFFER_SIZE);
+    return status;
+}
+
 /**
   * @brief  处理完整的AT命令
   * @param  cmd 命令字符串
@@ -252,6 +364,20 @@ AtCmdStatus_t AT_ProcessCommand(char *cmd) {
     if (strcmp(cmd_name, "CFGDECEL") == 0)   return Process_CfgDecel(param_start);
     if (strcmp(cmd_name, "GETADC") == 0)     return Process_GetAdc(param_start);
     if (strcmp(cmd_name, "SETID") == 0)      return Process_SetID(param_start);
+    if (strcmp(cmd_name, "SUB") == 0)        return Process_Sub(param_start);
+    if (strcmp(cmd_name, "BAUD") == 0)       return Process_Baud(param_start);
+    if (strcmp(cmd_name, "LOGLVL") == 0)     return Process_LogLvl(param_start);
+    if (strcmp(cmd_name, "LOGRATE") == 0)    return Process_LogRate(param_start);
+    if (strcmp(cmd_name, "LINGRP") == 0)     return Process_LinGrp(param_start);
+    if (strcmp(cmd_name, "LINSTAT") == 0)    return Process_LinStatClear(param_start);
+    if (strcmp(cmd_name, "LINSLEEP") == 0)   return Process_LinSleep(param_start);
+    if (strcmp(cmd_name, "LINMASTER") == 0)  return Process_LinMaster(param_start);
+    if (strcmp(cmd_name, "LINSCHED") == 0)   return Process_LinSched(param_start);
+    if (strcmp(cmd_name, "PARAM") == 0)      return Process_Param(param_start);
+    if (strcmp(cmd_name, "SETPOS") == 0)     return Process_SetPos(param_start);
+    if (strcmp(cmd_name, "FAULT") == 0)      return Process_Fault(param_start);
+    if (strcmp(cmd_name, "CRC") == 0)        return Process_Crc(param_start);
+    if (strcmp(cmd_name, "PROG") == 0)       return Process_Prog(param_start);
 
         // 处理各种命令...
 //        if (strcmp(cmd_name, "MotorRun") == 0) {
@@ -267,11 +393,71 @@ AtCmdStatus_t AT_ProcessCommand(char *cmd) {
         if (strcmp(cmd_name, "INFO") == 0) {
            return Process_Info();
         }
+        if (strcmp(cmd_name, "SUBSTAT") == 0) {
+           return Process_SubStat();
+        }
+        if (strcmp(cmd_name, "BAUDOK") == 0) {
+           return Process_BaudOk();
+        }
+        if (strcmp(cmd_name, "LOGSTAT") == 0) {
+           return Process_LogStat();
+        }
+        if (strcmp(cmd_name, "LINSTAT") == 0) {
+           return Process_LinStat();
+        }
+        if (strcmp(cmd_name, "LINSLEEP") == 0) {
+           return Process_LinSleepQuery();
+        }
+        if (strcmp(cmd_name, "SLEEP") == 0) {
+           return Process_Sleep();
+        }
+        if (strcmp(cmd_name, "LINMASTER") == 0) {
+           return Process_LinMasterQuery();
+        }
+        if (strcmp(cmd_name, "LINSCHED") == 0) {
+           return Process_LinSchedQuery();
+        }
+        if (strcmp(cmd_name, "LINRESP") == 0) {
+           return Process_LinResp();
+        }
+        if (strcmp(cmd_name, "TSYNC") == 0) {
+           return Process_TSync();
+        }
+        if (strcmp(cmd_name, "CFGSTAT") == 0) {
+           return Process_CfgStat();
+        }
+        if (strcmp(cmd_name, "PARAM") == 0) {
+           return Process_ParamList();
+        }
+        if (strcmp(cmd_name, "PARAMSAVE") == 0) {
+           return Process_ParamSave();
+        }
+        if (strcmp(cmd_name, "PARAMRST") == 0) {
+           return Process_ParamReset();
+        }
+        if (strcmp(cmd_name, "SNAP") == 0) {
+           return Process_Snap();
+        }
+        if (strcmp(cmd_name, "FAULT") == 0) {
+           return Process_FaultList();
+        }
+        if (strcmp(cmd_name, "CRC") == 0) {
+           return Process_CrcCheck();
+        }
+        if (strcmp(cmd_name, "PROG") == 0) {
+           return Process_ProgList();
+        }
+        if (strcmp(cmd_name, "LINK") == 0) {
+           return Process_LinkList();
+        }
+        if (strcmp(cmd_name, "EVT") == 0) {
+           return Process_EventStat();
+        }
 //		
 
     }
     
-    LOG_WARN("Unknown AT command: %s\r\n", cmd_name);
+    LOG_WARN("Unknown AT command: len=%d\r\n", (int)strlen(cmd_name));
     return AT_UNKNOWN_CMD;
 }
 
@@ -317,7 +503,7 @@ static AtCmdStatus_t Process_Run(char *params) {
         if (speed < 0 || speed > 1000) return AT_PARAM_ERROR;
         
         // 调用业务层
-        App_Linkage_SetMode(0,1); // 确保退出联动模式
+        App_Linkage_ReleaseMotor(id - 1); // 退出占用该电机的联动
         App_Motor_MoveManual(id - 1, dir, speed); // ID-1 转为索引
         
         AT_SendResponse("+RUN:OK ID=%d,Dir=%d,Spd=%d", id, dir, speed);
@@ -334,7 +520,7 @@ static AtCmdStatus_t Process_Time(char *params) {
     if (sscanf(params, "%d,%d,%d,%d", &id, &dir, &speed, &time) == 4) {
         if (id < 1 || id > MAX_MOTORS) return AT_PARAM_ERROR;
         
-        App_Linkage_SetMode(0,1);
+        App_Linkage_ReleaseMotor(id - 1);
         App_Motor_MoveTime(id - 1, dir, speed, time);
         
         AT_SendResponse("+TIME:OK ID=%d,Time=%dms", id, time);
@@ -351,7 +537,7 @@ static AtCmdStatus_t Process_Pos(char *params) {
     if (sscanf(params, "%d,%d,%d,%d", &id, &dir, &speed, &pulses) == 4) {
         if (id < 1 || id > MAX_MOTORS) return AT_PARAM_ERROR;
         
-        App_Linkage_SetMode(0,1);
+        App_Linkage_ReleaseMotor(id - 1);
         App_Motor_MovePos(id - 1, dir, speed, pulses);
         
         AT_SendResponse("+POS:OK ID=%d,Target=%d", id, pulses);
@@ -366,13 +552,13 @@ static AtCmdStatus_t Process_Stop(char *params) {
     int id;
     
     if (sscanf(params, "%d", &id) == 1) {
-        App_Linkage_SetMode(0,1); // 停止联动
-        
         if (id == 0) {
+            App_Linkage_SetMode(0,1); // 停止所有联动
             for(int i=0; i<MAX_MOTORS; i++) App_Motor_Stop(i);
             AT_SendResponse("+STOP:OK ALL");
         } else {
             if (id > MAX_MOTORS) return AT_PARAM_ERROR;
+            App_Linkage_ReleaseMotor(id - 1); // 停止占用该电机的联动
             App_Motor_Stop(id - 1);
             AT_SendResponse("+STOP:OK ID=%d", id);
         }
@@ -393,39 +579,63 @@ static AtCmdStatus_t Process_Query(char *params) {
         int32_t pulses = BSP_BLDC_GetPulse(id - 1);
         uint8_t is_busy = App_Motor_IsBusy(id - 1);
         
-        // 格式: +STATUS:ID=<id>,Busy=<0/1>,Pulses=<val>
-        AT_SendResponse("+STATUS:ID=%d,Busy=%d,Pulses=%ld", id, is_busy, pulses);
+        // 格式: +STATUS:ID=<id>,Busy=<0/1>,Pulses=<val>,Abs=<绝对位置>
+        AT_SendResponse("+STATUS:ID=%d,Busy=%d,Pulses=%ld,Abs=%ld", id, is_busy, pulses,
+                        (long)BSP_BLDC_GetPosition(id - 1));
         return AT_OK;
     }
     return AT_PARAM_ERROR;
 }
 
-// AT+LINK=<Mode>
+// AT+LINK=<Mode>,[Loop],[Inst]  (Inst 默认 0; Mode=0 且未指定 Inst 时停止所有实例)
 static AtCmdStatus_t Process_Link(char *params) {
     if (!params) return AT_PARAM_ERROR;
     int mode;
 	int loop_count = 0; // 默认为0 (无限循环或单次，取决于你的定义，这里建议0表示无限)
+    int inst = 0;
     
-    // 尝试解析两个参数
-    int args_parsed = sscanf(params, "%d,%d", &mode, &loop_count);
+    // 尝试解析三个参数
+    int args_parsed = sscanf(params, "%d,%d,%d", &mode, &loop_count, &inst);
     
     if (args_parsed >= 1) {
         // 如果只输入了 AT+LINK=1，则 args_parsed=1，loop_count 保持默认 0 (无限)
         // 或者你可以定义默认值为 1 (只跑一次)
         if (args_parsed == 1) loop_count = 1; 
+        if (mode < 0 || mode > 0xFF || loop_count < 0 || inst < 0 || inst >= LINK_INSTANCES) return AT_PARAM_ERROR;
         
-        App_Linkage_SetMode(mode, loop_count);
+        if (mode == 0 && args_parsed < 3) {
+            App_Linkage_SetMode(0, 0);
+        } else {
+            LinkResult_t res = App_Linkage_Run((uint8_t)inst, (uint8_t)mode, (uint32_t)loop_count);
+            if (res != LINK_OK) {
+                AT_SendResponse("+LINK:ERR=%s", res == LINK_ERR_BUSY ? "BUSY" : "MODE");
+                return AT_EXECUTION_ERROR;
+            }
+        }
         
         if (loop_count == 0) {
-            AT_SendResponse("+LINK:OK Mode=%d,Loop=Infinite", mode);
+            AT_SendResponse("+LINK:OK Mode=%d,Loop=Infinite,Inst=%d", mode, inst);
         } else {
-            AT_SendResponse("+LINK:OK Mode=%d,Loop=%d", mode, loop_count);
+            AT_SendResponse("+LINK:OK Mode=%d,Loop=%d,Inst=%d", mode, loop_count, inst);
         }
         return AT_OK;
     }
     return AT_PARAM_ERROR;
 }
 
+// AT+LINK  查询各联动实例
+static AtCmdStatus_t Process_LinkList(void) {
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        LinkInstStat_t st;
+        App_Linkage_GetStat(i, &st);
+        AT_SendResponse("+LINK:Inst=%d,Mode=%d,Last=%d,State=%d,Err=%d,PC=%u,Loop=%lu/%lu,Motors=0x%lx,Steps=%lu,"
+                        "Block=%d,Wake=%lu",
+                        i, st.mode, st.last_mode, st.state, st.err, st.pc, st.loops_done, st.loops_target,
+                        st.motors, st.steps, st.blocked, st.wakeups);
+    }
+    return AT_OK;
+}
+
 // AT+ADCMOVE=<ID>,<Speed>,<TargetADC>,<Tolerance>,<Range>
 static AtCmdStatus_t Process_AdcMove(char *params) {
     if (!params) return AT_PARAM_ERROR;
@@ -434,7 +644,7 @@ static AtCmdStatus_t Process_AdcMove(char *params) {
     if (sscanf(params, "%d,%d,%d,%d,%d", &id, &speed, &target, &tol, &range) == 5) {
         if (id < 1 || id > MAX_MOTORS) return AT_PARAM_ERROR;
         
-        App_Linkage_SetMode(0,1);
+        App_Linkage_ReleaseMotor(id - 1);
         App_Motor_MoveAdcPos(id - 1, speed, (uint16_t)target, (uint16_t)tol, (uint16_t)range);
         
         AT_SendResponse("+ADCMOVE:OK ID=%d,Tgt=%d", id, target);
@@ -451,7 +661,7 @@ static AtCmdStatus_t Process_AdcMoveLim(char *params) {
     if (sscanf(params, "%d,%d,%d,%d,%d", &id, &speed, &target, &tol, &range) == 5) {
         if (id < 1 || id > MAX_MOTORS) return AT_PARAM_ERROR;
         
-        App_Linkage_SetMode(0,1);
+        App_Linkage_ReleaseMotor(id - 1);
         App_Motor_MoveAdcPosWithLimit(id - 1, speed, (uint16_t)target, (uint16_t)tol, (uint16_t)range);
         
         AT_SendResponse("+ADCMOVELIM:OK ID=%d,Tgt=%d", id, target);
@@ -488,10 +698,12 @@ static AtCmdStatus_t Process_GetAdc(char *params) {
              int v_int = (int)(g_adc_data.voltage_V * 10);
              int t_int = (int)(g_adc_data.temperature_C * 10);
              
-             AT_SendResponse("+GETADC:Global V=%d.%01dV,T=%d.%01dC,Err=%d", 
+             // ErrT: 最近一次故障时刻 (ms, 微秒时基)
+             AT_SendResponse("+GETADC:Global V=%d.%01dV,T=%d.%01dC,Err=%d,ErrT=%lu", 
                              v_int/10, abs(v_int%10), 
                              t_int/10, abs(t_int%10), 
-                             g_adc_data.error_code);
+                             g_adc_data.error_code,
+                             (unsigned long)(g_adc_data.error_time_us / 1000u));
         } else {
              if (id > MAX_MOTORS) return AT_PARAM_ERROR;
              int motor_idx = id - 1;
@@ -532,3 +744,618 @@ static AtCmdStatus_t Process_Info(void) {
     AT_SendResponse("+INFO:Ver=%s,DevID=%d", SW_VERSION, g_Config.device_id);
     return AT_OK;
 }
+
+// AT+SUB=<Mask>[,<RateHz>,<Fmt>]  (Mask=0 取消订阅; Fmt: 0=CSV, 1=BIN)
+static AtCmdStatus_t Process_Sub(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int mask, rate = 0, fmt = TELEM_FMT_CSV;
+
+    int args_parsed = sscanf(params, "%i,%d,%d", &mask, &rate, &fmt);
+    if (args_parsed < 1 || mask < 0 || mask > (int)TELEM_F_ALL) return AT_PARAM_ERROR;
+
+    if (mask == 0) {
+        App_Telemetry_Subscribe(0, 0, TELEM_FMT_CSV);
+        AT_SendResponse("+SUB:OK Off");
+        return AT_OK;
+    }
+    if (args_parsed < 2 || rate < 1 || rate > (int)TELEM_RATE_MAX) return AT_PARAM_ERROR;
+    if (fmt != TELEM_FMT_CSV && fmt != TELEM_FMT_BIN) return AT_PARAM_ERROR;
+
+    // 先回复再开启, 避免首帧与应答交错
+    AT_SendResponse("+SUB:OK Mask=0x%02X,Rate=%dHz,Fmt=%s", mask, rate, fmt == TELEM_FMT_BIN ? "BIN" : "CSV");
+    App_Telemetry_Subscribe((uint8_t)mask, (uint16_t)rate, (TelemFormat_t)fmt);
+    return AT_OK;
+}
+
+// AT+SUBSTAT
+static AtCmdStatus_t Process_SubStat(void) {
+    TelemStats_t st;
+    App_Telemetry_GetStats(&st);
+    AT_SendResponse("+SUBSTAT:Sent=%lu,Dropped=%lu", st.frames_sent, st.frames_dropped);
+    return AT_OK;
+}
+
+// AT+BAUD=<Rate>  以旧波特率应答后切换, 需在 AT_BAUD_CONFIRM_MS 内以新波特率发送 AT+BAUDOK
+static AtCmdStatus_t Process_Baud(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    unsigned long baud;
+
+    if (sscanf(params, "%lu", &baud) != 1) return AT_PARAM_ERROR;
+    if (!AT_IsValidBaudRate(baud)) return AT_PARAM_ERROR;
+
+    AT_SendResponse("+BAUD:OK Rate=%lu,Confirm=%dms", baud, AT_BAUD_CONFIRM_MS);
+
+    // 已在协商中则以最初的波特率作为回退点
+    if (!at_baud_pending) at_baud_prev = at_uart->Init.BaudRate;
+    if (AT_ApplyBaudRate(baud) != HAL_OK) {
+        AT_ApplyBaudRate(at_baud_prev);
+        return AT_EXECUTION_ERROR;
+    }
+    at_baud_pending = true;
+    at_baud_deadline = HAL_GetTick() + AT_BAUD_CONFIRM_MS;
+    return AT_OK;
+}
+
+// AT+BAUDOK  主机在新波特率下确认, 保存到 Flash (开机自动应用)
+static AtCmdStatus_t Process_BaudOk(void) {
+    if (!at_baud_pending) return AT_EXECUTION_ERROR;
+    at_baud_pending = false;
+
+    g_Config.baud_rate = at_uart->Init.BaudRate;
+    App_Storage_Save();
+
+    AT_SendResponse("+BAUDOK:Saved Rate=%lu", g_Config.baud_rate);
+    return AT_OK;
+}
+
+// 解析模块名: 名称 (ADC/MOTOR/LIN/AT/LINK/STORAGE/SYS) 或 ALL
+// 返回 LOG_MOD_COUNT 表示 ALL, -1 表示无效
+static int Parse_LogModule(const char *name) {
+    if (strcasecmp(name, "ALL") == 0) return LOG_MOD_COUNT;
+    LogModule_t m = Log_FindModule(name);
+    return (m == LOG_MOD_COUNT) ? -1 : (int)m;
+}
+
+// AT+LOGLVL=<Module|ALL>,<Level>  (Level: 0=DEBUG,1=INFO,2=WARN,3=ERROR,4=OFF)
+static AtCmdStatus_t Process_LogLvl(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    char name[16];
+    int level;
+
+    if (sscanf(params, "%15[^,],%d", name, &level) != 2) return AT_PARAM_ERROR;
+    int mod = Parse_LogModule(name);
+    if (mod < 0 || level < LOG_LEVEL_DEBUG || level > LOG_LEVEL_NONE) return AT_PARAM_ERROR;
+
+    for (int m = 0; m < LOG_MOD_COUNT; m++) {
+        if (mod == LOG_MOD_COUNT || mod == m) Log_SetLevel((LogModule_t)m, (LogLevel_t)level);
+    }
+    AT_SendResponse("+LOGLVL:OK %s=%d", name, level);
+    return AT_OK;
+}
+
+// AT+LOGRATE=<Module|ALL>,<PerSec>,<Burst>  (PerSec=0 不限速)
+static AtCmdStatus_t Process_LogRate(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    char name[16];
+    int rate, burst;
+
+    if (sscanf(params, "%15[^,],%d,%d", name, &rate, &burst) != 3) return AT_PARAM_ERROR;
+    int mod = Parse_LogModule(name);
+    if (mod < 0 || rate < 0 || rate > 1000 || burst < 1 || burst > 1000) return AT_PARAM_ERROR;
+
+    for (int m = 0; m < LOG_MOD_COUNT; m++) {
+        if (mod == LOG_MOD_COUNT || mod == m) Log_SetRate((LogModule_t)m, (uint16_t)rate, (uint16_t)burst);
+    }
+    AT_SendResponse("+LOGRATE:OK %s=%d/s,Burst=%d", name, rate, burst);
+    return AT_OK;
+}
+
+// AT+LOGSTAT  每个模块一行: 级别/限速/已输出/被抑制条数
+static AtCmdStatus_t Process_LogStat(void) {
+    LogModuleStat_t st;
+    for (int m = 0; m < LOG_MOD_COUNT; m++) {
+        Log_GetModuleStat((LogModule_t)m, &st);
+        AT_SendResponse("+LOGSTAT:%s Lvl=%d,Rate=%d/s,Burst=%d,Out=%lu,Sup=%lu",
+                        Log_GetModuleName((LogModule_t)m), st.level, st.rate, st.burst,
+                        st.emitted, st.suppressed);
+    }
+    AT_SendResponse("+LOGSTAT:RingDropped=%lu", Log_GetDropped());
+    return AT_OK;
+}
+
+// AT+LINSTAT  LIN 接收帧队列统计
+static AtCmdStatus_t Process_LinStat(void) {
+    LinQueueStat_t st;
+    LinBaudStat_t bs;
+    App_LIN_GetQueueStat(&st);
+    BSP_LinBaud_GetStat(&bs);
+    AT_SendResponse("+LINSTAT:Queued=%lu,Exec=%lu,Overflow=%lu,Depth=%d,MaxDepth=%d/%d",
+                    st.queued, st.executed, st.overflows, st.depth, st.depth_max, LIN_RXQ_SIZE);
+    // 自动波特率: 当前波特率与相对标称值偏差 (ppm)
+    AT_SendResponse("+LINSTAT:Baud=%lu,Dev=%ldppm,DevMin=%ld,DevMax=%ld,Sync=%lu,Reject=%lu",
+                    bs.baud, bs.dev_ppm, bs.dev_min_ppm, bs.dev_max_ppm, bs.syncs, bs.rejects);
+
+    // 总线健康: 各类错误计数, 最近错误时刻 (距今 ms), 总线空闲时长
+    LinBusStat_t bus;
+    App_LIN_GetBusStat(&bus);
+    uint32_t err_age = bus.last_err ? (uint32_t)((BSP_Time_GetUs() - bus.last_err_us) / 1000u) : 0;
+    AT_SendResponse("+LINSTAT:Break=%lu,Cksum=%lu,Parity=%lu,Frame=%lu,Overrun=%lu,Noise=%lu,SyncErr=%lu",
+                    bus.breaks, bus.err[LIN_ERR_CHECKSUM], bus.err[LIN_ERR_PARITY], bus.err[LIN_ERR_FRAMING],
+                    bus.err[LIN_ERR_OVERRUN], bus.err[LIN_ERR_NOISE], bus.err[LIN_ERR_SYNC]);
+    AT_SendResponse("+LINSTAT:LastErr=%d,ErrAge=%lums,Idle=%lums,EraseOvr=%lu", bus.last_err, err_age, bus.idle_ms,
+                    bus.erase_overruns);
+
+    // 按帧 ID: 只列出有收发记录的 ID
+    for (uint8_t id = 0; id < 64; id++) {
+        uint16_t rx = 0, exec = 0;
+        App_LIN_GetIdStat(id, &rx, &exec);
+        if (rx == 0 && exec == 0) continue;
+        AT_SendResponse("+LINSTAT:ID=0x%02X,Rx=%u,Exec=%u", id, rx, exec);
+    }
+    return AT_OK;
+}
+
+// AT+LINSTAT=0  清零 LIN 统计
+static AtCmdStatus_t Process_LinStatClear(char *params) {
+    if (!params || strcmp(params, "0") != 0) return AT_PARAM_ERROR;
+    App_LIN_ClearStats();
+    AT_SendResponse("+LINSTAT:CLEARED");
+    return AT_OK;
+}
+
+// AT+LINSLEEP=<Sec>  设置 LIN 总线空闲休眠超时 (0 = 禁用, Flash保存)
+static AtCmdStatus_t Process_LinSleep(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int sec;
+    if (sscanf(params, "%i", &sec) != 1 || sec < 0 || sec > STORAGE_SLEEP_TIMEOUT_MAX) return AT_PARAM_ERROR;
+
+    App_Storage_SetLinSleepTimeout((uint32_t)sec);
+    AT_SendResponse("+LINSLEEP:OK Timeout=%lus", g_Config.lin_sleep_timeout_s);
+    return AT_OK;
+}
+
+// AT+LINSLEEP  查询休眠超时与休眠统计
+static AtCmdStatus_t Process_LinSleepQuery(void) {
+    PowerStat_t ps;
+    LinBusStat_t bus;
+    App_Power_GetStat(&ps);
+    App_LIN_GetBusStat(&bus);
+    AT_SendResponse("+LINSLEEP:Timeout=%lus,Idle=%lums,Sleeps=%lu,LastReason=%d,LastWake=%d",
+                    g_Config.lin_sleep_timeout_s, bus.idle_ms, ps.sleeps, ps.last_reason, ps.last_wake);
+    return AT_OK;
+}
+
+// AT+SLEEP  立即休眠 (应答发出后进入, LIN 总线或本串口唤醒)
+static AtCmdStatus_t Process_Sleep(void) {
+    App_Power_RequestSleep(POWER_SLEEP_AT);
+    return AT_OK;
+}
+
+// AT+LINMASTER=<0|1>  启停 LIN 主机调度表 (Flash保存, 上电自动运行)
+static AtCmdStatus_t Process_LinMaster(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int en;
+    if (sscanf(params, "%d", &en) != 1 || en < 0 || en > 1) return AT_PARAM_ERROR;
+
+    App_LIN_MasterEnable((uint8_t)en);
+    return Process_LinMasterQuery();
+}
+
+// AT+LINMASTER  查询主机状态
+static AtCmdStatus_t Process_LinMasterQuery(void) {
+    int slots = 0;
+    for (int i = 0; i < LIN_SCHED_MAX; i++) {
+        if (g_Config.lin_sched[i].id != LIN_SCHED_EMPTY) slots++;
+    }
+    AT_SendResponse("+LINMASTER:En=%lu,Run=%d,Slots=%d,Cycles=%lu",
+                    g_Config.lin_master_en, App_LIN_MasterIsEnabled(), slots, App_LIN_MasterGetCycles());
+    return AT_OK;
+}
+
+// 十六进制字符串 -> 字节, 返回字节数 (格式错误返回 0)
+static uint8_t AT_ParseHex(const char *s, uint8_t *out, uint8_t max) {
+    uint8_t n = 0;
+    while (s[0] && s[1]) {
+        if (n >= max) return 0;
+        uint8_t b = 0;
+        for (int k = 0; k < 2; k++) {
+            char c = s[k];
+            b <<= 4;
+            if (c >= '0' && c <= '9') b |= (uint8_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') b |= (uint8_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') b |= (uint8_t)(c - 'A' + 10);
+            else return 0;
+        }
+        out[n++] = b;
+        s += 2;
+    }
+    return (s[0] == '\0') ? n : 0; // 奇数个字符视为错误
+}
+
+// AT+LINSCHED=<Idx>,<ID>,<Ms>[,<Hex>]  设置调度表时隙 (Flash保存)
+//   带 Hex: 指令帧, 主机发送该数据; 不带: 应答帧 (8 字节), 主机只发帧头并收集
+//   ID = -1: 删除该时隙
+static AtCmdStatus_t Process_LinSched(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int idx, id, ms = 0;
+    char hex[20] = {0};
+    int n = sscanf(params, "%d,%i,%d,%19s", &idx, &id, &ms, hex);
+    if (n < 2 || idx < 0 || idx >= LIN_SCHED_MAX) return AT_PARAM_ERROR;
+
+    if (id == -1) {
+        App_LIN_MasterSetSlot((uint8_t)idx, NULL);
+        AT_SendResponse("+LINSCHED:%d,DEL", idx);
+        return AT_OK;
+    }
+    if (n < 3 || id < 0 || id > 0x3F || ms <= 0 || ms > 0xFFFF) return AT_PARAM_ERROR;
+
+    LinSchedEntry_t e;
+    memset(&e, 0, sizeof(e));
+    e.id = (uint8_t)id;
+    e.delay_ms = (uint16_t)ms;
+    if (n == 4) {
+        e.dir = LIN_SCHED_CMD;
+        e.len = AT_ParseHex(hex, e.data, sizeof(e.data));
+        if (e.len == 0) return AT_PARAM_ERROR;
+    } else {
+        e.dir = LIN_SCHED_RESP;
+        e.len = 8;
+    }
+    if (!App_LIN_MasterSetSlot((uint8_t)idx, &e)) {
+        AT_SendResponse("+LINSCHED:ERR MinMs=%u", LIN_SCHED_MIN_MS(e.len));
+        return AT_PARAM_ERROR;
+    }
+    AT_SendResponse("+LINSCHED:%d,OK", idx);
+    return AT_OK;
+}
+
+// AT+LINSCHED  列出调度表
+static AtCmdStatus_t Process_LinSchedQuery(void) {
+    for (int i = 0; i < LIN_SCHED_MAX; i++) {
+        const LinSchedEntry_t *e = &g_Config.lin_sched[i];
+        if (e->id == LIN_SCHED_EMPTY) continue;
+        if (e->dir == LIN_SCHED_CMD) {
+            char hex[17];
+            for (int k = 0; k < e->len; k++) sprintf(&hex[k * 2], "%02X", e->data[k]);
+            AT_SendResponse("+LINSCHED:%d,ID=0x%02X,Ms=%u,CMD,Data=%s", i, e->id, e->delay_ms, hex);
+        } else {
+            AT_SendResponse("+LINSCHED:%d,ID=0x%02X,Ms=%u,RESP,Len=%d", i, e->id, e->delay_ms, e->len);
+        }
+    }
+    return AT_OK;
+}
+
+// AT+LINRESP  主机收集的应答表
+static AtCmdStatus_t Process_LinResp(void) {
+    uint64_t now = BSP_Time_GetUs();
+    for (uint8_t i = 0; i < LIN_SCHED_MAX; i++) {
+        LinMasterResp_t r;
+        if (!App_LIN_MasterGetResp(i, &r)) continue;
+        char hex[17] = "-";
+        if (r.rx) {
+            for (int k = 0; k < r.len && k < 8; k++) sprintf(&hex[k * 2], "%02X", r.data[k]);
+        }
+        uint32_t age = r.rx ? (uint32_t)((now - r.last_us) / 1000u) : 0;
+        AT_SendResponse("+LINRESP:%d,ID=0x%02X,Data=%s,Rx=%lu,NoResp=%lu,Err=%lu,Age=%lums",
+                        i, g_Config.lin_sched[i].id, hex, r.rx, r.no_resp, r.errors, age);
+    }
+    return AT_OK;
+}
+
+// AT+TSYNC  总线时间同步状态
+static AtCmdStatus_t Process_TSync(void) {
+    BSP_TimeSyncStat_t st;
+    BSP_Time_GetSyncStat(&st);
+    uint64_t bus = BSP_Time_GetBusUs();
+    uint32_t age = st.valid ? (uint32_t)((BSP_Time_GetUs() - st.last_sync_us) / 1000u) : 0;
+    AT_SendResponse("+TSYNC:Valid=%d,Syncs=%lu,Steps=%lu,Age=%lums", st.valid, st.syncs, st.steps, age);
+    AT_SendResponse("+TSYNC:Offset=%ldms,Drift=%ldppm,Err=%ldus,MaxErr=%ldus,Bus=%lu.%06lu",
+                    (long)(st.offset_us / 1000), (long)st.drift_ppm, (long)st.last_err_us, (long)st.max_err_us,
+                    (unsigned long)(bus / 1000000u), (unsigned long)(bus % 1000000u));
+    return AT_OK;
+}
+
+// AT+CFGSTAT  配置存储状态
+static AtCmdStatus_t Process_CfgStat(void) {
+    FlashKvStat_t st;
+    FlashKV_GetStat(&st);
+    AT_SendResponse("+CFGSTAT:Page=%d,Gen=%lu,Used=%u/%u,Keys=%d,Writes=%lu,Compacts=%lu,Bad=%lu",
+                    st.page, st.gen, st.used, st.size, st.keys, st.writes, st.compacts, st.crc_errs);
+    FlashJobStat_t js;
+    FlashJob_GetStat(&js);
+    AT_SendResponse("+FLASHJOB:Pending=%d/%d,Done=%lu,Failed=%lu,Erases=%lu,Halfwords=%lu,Deferred=%lu,Trips=%lu,EraseMax=%luus",
+                    js.pending, js.pending_max, js.done, js.failed, js.erases, js.halfwords,
+                    js.deferred, js.trips, js.erase_max_us);
+    return AT_OK;
+}
+
+// AT+SNAP  掉电快照状态与最近一次快照内容
+static AtCmdStatus_t Process_Snap(void) {
+    SnapStat_t st;
+    App_Snapshot_GetStat(&st);
+    AT_SendResponse("+SNAP:Armed=%d,Restored=%d,Resumed=%d,Src=%d,Vbus=%d.%dV,Slots=%d/%d,Saves=%lu,Fail=%lu",
+                    st.armed, st.restored, st.resumed, st.last_src, st.last_vbus_dv / 10, st.last_vbus_dv % 10,
+                    st.slot_used, st.slot_total, st.saves, st.failures);
+    for (uint8_t i = 0; i < MAX_MOTORS; i++) {
+        AT_SendResponse("+SNAP:ID=%d,Pos=%ld,Mode=%d,Abs=%ld", i + 1, (long)st.pos[i], st.motor_mode[i],
+                        (long)BSP_BLDC_GetPosition(i));
+    }
+    for (uint8_t i = 0; i < LINK_INSTANCES; i++) {
+        AT_SendResponse("+SNAP:Link%d=%d,PC=%u,Loop=%lu/%lu", i, st.link[i].mode, st.link[i].pc,
+                        st.link[i].loops_done, st.link[i].loops_target);
+    }
+    return AT_OK;
+}
+
+// AT+SETPOS=<ID>,<Pos>  校准绝对位置 (如回零后置 0)
+static AtCmdStatus_t Process_SetPos(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int id;
+    long pos;
+    if (sscanf(params, "%d,%ld", &id, &pos) != 2 || id < 1 || id > MAX_MOTORS) return AT_PARAM_ERROR;
+    BSP_BLDC_SetPosition(id - 1, (int32_t)pos);
+    AT_SendResponse("+SETPOS:ID=%d,Abs=%ld", id, pos);
+    return AT_OK;
+}
+
+// AT+FAULT  故障历史 (最新在前)
+static AtCmdStatus_t Process_FaultList(void) {
+    FaultStat_t st;
+    App_Fault_GetStat(&st);
+    AT_SendResponse("+FAULT:Count=%d/%d,Boot=%u,Seq=%lu,Reported=%lu,Written=%lu,Suppressed=%lu,Dropped=%lu",
+                    st.count, st.capacity, st.boot, st.next_seq, st.reported, st.written, st.suppressed, st.dropped);
+    const FaultRecord_t *r;
+    for (uint8_t i = 0; (r = App_Fault_Get(i)) != NULL; i++) {
+        AT_SendResponse("+FAULT:%lu,Boot=%u,Ms=%lu,%s,M=%d,Det=%d,Rep=%u,Mode=%d,Link=%d/%d,"
+                        "V=%d.%d,Temp=%d,I=%u,Adc=%u,Abs=%ld,Duty=%u",
+                        r->seq, r->boot, r->time_ms, App_Fault_Name(r->code), r->motor + 1, r->detail, r->repeat,
+                        r->motor_mode, r->link_mode, r->link_step, r->vbus_dv / 10, r->vbus_dv % 10,
+                        r->temp_dc, r->cur_ma, r->adc_pos, (long)r->position, r->duty);
+    }
+    return AT_OK;
+}
+
+// AT+FAULT=BIN  整块二进制导出 (格式见 app_fault.h); AT+FAULT=CLR  清空
+static AtCmdStatus_t Process_Fault(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    if (strcasecmp(params, "CLR") == 0) {
+        App_Fault_Clear();
+        AT_SendResponse("+FAULT:CLR");
+        return AT_OK;
+    }
+    if (strcasecmp(params, "BIN") != 0) return AT_PARAM_ERROR;
+
+    FaultStat_t st;
+    App_Fault_GetStat(&st);
+    uint16_t len = (uint16_t)(st.count * sizeof(FaultRecord_t));
+    uint8_t hdr[6] = { FAULT_BIN_SYNC0, FAULT_BIN_SYNC1, FAULT_BIN_TYPE, st.count, (uint8_t)len, (uint8_t)(len >> 8) };
+    uint8_t sum = 0;
+
+    // 文本行给出块长度, 随后紧跟二进制块
+    AT_SendResponse("+FAULTBIN:%u", (unsigned)(sizeof(hdr) + len + 1u));
+    for (uint8_t k = 0; k < sizeof(hdr); k++) sum += hdr[k];
+    AT_SendBinary(hdr, sizeof(hdr));
+    const FaultRecord_t *r;
+    for (uint8_t i = 0; i < st.count && (r = App_Fault_Get(i)) != NULL; i++) {
+        const uint8_t *b = (const uint8_t *)r;
+        for (uint8_t k = 0; k < sizeof(*r); k++) sum += b[k];
+        AT_SendBinary(b, sizeof(*r));
+    }
+    AT_SendBinary(&sum, 1);
+    return AT_OK;
+}
+
+// AT+CRC  立即校验固件镜像与配置存储
+static AtCmdStatus_t Process_CrcCheck(void) {
+    static const char *const image_state[] = { "OK", "UNSIGNED", "BAD" };
+    IntegReport_t r;
+    BSP_CrcStat_t cs;
+
+    App_Integrity_Check(&r);
+    BSP_Crc_GetStat(&cs);
+    AT_SendResponse("+CRC:Image=%s,Len=%lu,Crc=%08lX,Expect=%08lX,Time=%luus",
+                    image_state[r.image], r.image_len, r.image_crc, r.image_expect, r.image_us);
+    AT_SendResponse("+CRC:Cfg=%s,Records=%u,Legacy=%u,Bad=%u,Prog=%u,ProgBad=%u,Failures=%lu",
+                    r.cfg_busy ? "BUSY" : (r.cfg_bad ? "BAD" : "OK"), r.cfg_records, r.cfg_legacy, r.cfg_bad,
+                    r.prog_slots, r.prog_bad, r.failures);
+    AT_SendResponse("+CRC:Hw=%d,Dma=%lu,Cpu=%lu,Sw=%lu,Busy=%lu,DmaErr=%lu",
+                    BSP_CRC_HW, cs.dma_calls, cs.cpu_calls, cs.sw_calls, cs.busy_fallbacks, cs.dma_errors);
+    return AT_OK;
+}
+
+// 吞吐率 (MB/s, 1MB = 10^6 字节 = 每微秒 1 字节), 两位小数
+static void AT_SendCrcRate(const char *path, uint32_t bytes, uint32_t us) {
+    uint32_t rate = us ? (bytes * 100u) / us : 0;
+    AT_SendResponse("+CRCBENCH:%s=%lu.%02luMB/s,Time=%luus", path, rate / 100u, rate % 100u, us);
+}
+
+// AT+CRC=BENCH  三种计算途径对同一数据测速
+static AtCmdStatus_t Process_Crc(char *params) {
+    if (!params || strcasecmp(params, "BENCH") != 0) return AT_PARAM_ERROR;
+
+    IntegBench_t b;
+    App_Integrity_Bench(&b);
+    AT_SendResponse("+CRCBENCH:Bytes=%lu,Match=%d", b.bytes, b.match);
+    AT_SendCrcRate("DMA", b.bytes, b.us_dma);
+    AT_SendCrcRate("CPU", b.bytes, b.us_cpu);
+    AT_SendCrcRate("SW", b.bytes, b.us_sw);
+    return AT_OK;
+}
+
+static const char *const prog_result_names[] = {
+    "OK", "ARG", "STATE", "OFFSET", "LENGTH", "CRC", "VERIFY", "FLASH"
+};
+
+static AtCmdStatus_t AT_ProgResult(LinkProgResult_t res) {
+    if (res == LINKPROG_OK) return AT_OK;
+    AT_SendResponse("+PROG:ERR=%s", prog_result_names[res]);
+    return AT_EXECUTION_ERROR;
+}
+
+// AT+PROG=BEGIN,<Slot>,<Len>[,<Name>]  开始上传联动程序
+// AT+PROG=DATA,<Off>,<Hex>             数据块 (按偏移顺序, 每块最多 128 字节)
+// AT+PROG=END,<Crc>                    校验 CRC 与字节码后写入程序槽
+// AT+PROG=ABORT / DEL,<Slot> / RUN,<Slot>[,<Loop>[,<Inst>]]
+static AtCmdStatus_t Process_Prog(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    char op[8] = {0};
+    char rest[260] = {0}; // DATA: 128 字节 = 256 个十六进制字符
+    long a = -1;
+    int n = sscanf(params, "%7[^,],%li,%259s", op, &a, rest);
+
+    if (strcasecmp(op, "BEGIN") == 0) {
+        long len;
+        if (n < 3 || a < 0 || sscanf(rest, "%li", &len) != 1 || len < 0) return AT_PARAM_ERROR;
+        char *name = strchr(rest, ',');
+        LinkProgResult_t res = App_LinkProg_Begin((uint8_t)a, (uint16_t)len, name ? name + 1 : NULL);
+        if (res == LINKPROG_OK) AT_SendResponse("+PROG:BEGIN Slot=%ld,Len=%ld", a, len);
+        return AT_ProgResult(res);
+    }
+    if (strcasecmp(op, "DATA") == 0) {
+        uint8_t buf[128];
+        if (n < 3 || a < 0) return AT_PARAM_ERROR;
+        uint8_t len = AT_ParseHex(rest, buf, sizeof(buf));
+        if (len == 0) return AT_PARAM_ERROR;
+        LinkProgResult_t res = App_LinkProg_Write((uint16_t)a, buf, len);
+        if (res == LINKPROG_OK) AT_SendResponse("+PROG:DATA %ld", a + len);
+        return AT_ProgResult(res);
+    }
+    if (strcasecmp(op, "END") == 0) {
+        unsigned long crc;
+        if (sscanf(params, "%*[^,],%lx", &crc) != 1) return AT_PARAM_ERROR;
+        LinkProgResult_t res = App_LinkProg_End((uint32_t)crc);
+        if (res == LINKPROG_ERR_VERIFY) {
+            LinkProgUpload_t up;
+            App_LinkProg_GetUpload(&up);
+            AT_SendResponse("+PROG:VmErr=%d,Pc=%u", up.vm_err, up.vm_err_pc);
+        }
+        if (res == LINKPROG_OK) AT_SendResponse("+PROG:END Crc=%08lX", crc);
+        return AT_ProgResult(res);
+    }
+    if (strcasecmp(op, "ABORT") == 0) {
+        App_LinkProg_Abort();
+        AT_SendResponse("+PROG:ABORT");
+        return AT_OK;
+    }
+    if (strcasecmp(op, "DEL") == 0) {
+        if (n < 2 || a < 0) return AT_PARAM_ERROR;
+        LinkProgResult_t res = App_LinkProg_Delete((uint8_t)a);
+        if (res == LINKPROG_OK) AT_SendResponse("+PROG:DEL Slot=%ld", a);
+        return AT_ProgResult(res);
+    }
+    if (strcasecmp(op, "RUN") == 0) {
+        // 与 AT+LINK 相同: 省略 Loop 时只跑一次, 省略 Inst 时在实例 0 运行
+        long loops = 1, inst = 0;
+        if (n == 3 && sscanf(rest, "%li,%li", &loops, &inst) < 1) return AT_PARAM_ERROR;
+        if (n < 2 || a < 0 || a >= LINKPROG_SLOTS || loops < 0 || inst < 0 || inst >= LINK_INSTANCES) return AT_PARAM_ERROR;
+        LinkResult_t res = App_Linkage_Run((uint8_t)inst, (uint8_t)LINK_MODE_SLOT(a), (uint32_t)loops);
+        if (res != LINK_OK) {
+            AT_SendResponse("+PROG:ERR=%s", res == LINK_ERR_BUSY ? "BUSY" : "EMPTY"); // 电机被占用 / 空槽或 CRC 不符
+            return AT_EXECUTION_ERROR;
+        }
+        AT_SendResponse("+PROG:RUN Slot=%ld,Mode=%ld,Loop=%ld,Inst=%ld", a, (long)LINK_MODE_SLOT(a), loops, inst);
+        return AT_OK;
+    }
+    return AT_PARAM_ERROR;
+}
+
+// AT+PROG  列出程序槽与上传状态
+static AtCmdStatus_t Process_ProgList(void) {
+    static const char *const up_state[] = { "IDLE", "RECEIVING", "WRITING" };
+    LinkProgUpload_t up;
+    LinkProgInfo_t info;
+
+    for (uint8_t i = 0; i < LINKPROG_SLOTS; i++) {
+        App_LinkProg_GetInfo(i, &info);
+        if (info.len == 0) {
+            AT_SendResponse("+PROG:Slot=%d,Mode=%d,Empty", i, LINK_MODE_SLOT(i));
+            continue;
+        }
+        AT_SendResponse("+PROG:Slot=%d,Mode=%d,Valid=%d,Len=%u,Crc=%08lX,Name=%s",
+                        i, LINK_MODE_SLOT(i), info.valid, info.len, info.crc, info.name);
+    }
+    App_LinkProg_GetUpload(&up);
+    AT_SendResponse("+PROG:Upload=%s,Slot=%d,Recv=%u/%u,Last=%s,Uploads=%lu,Max=%u",
+                    up_state[up.state], up.slot, up.received, up.len,
+                    prog_result_names[up.last_result], up.uploads, (unsigned)LINKPROG_MAX_LEN);
+    return AT_OK;
+}
+
+static void AT_SendParam(const ParamRef_t *r) {
+    const ParamDesc_t *d = r->desc;
+    char name[16];
+    if (d->count > 1) snprintf(name, sizeof(name), "%s%d", d->name, r->idx);
+    else snprintf(name, sizeof(name), "%s", d->name);
+    AT_SendResponse("+PARAM:%s,Num=0x%02X,Val=%ld,Def=%ld,Range=%ld~%ld%s%s",
+                    name, App_Param_Num(r), (long)App_Param_Get(r), (long)d->def,
+                    (long)d->min, (long)d->max, d->unit[0] ? ",Unit=" : "", d->unit);
+}
+
+// AT+PARAM=<Name|Num>[,<Value>]  读 / 写运行参数 (写入立即生效, AT+PARAMSAVE 保存)
+static AtCmdStatus_t Process_Param(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    char key[16];
+    long value;
+    ParamRef_t r;
+
+    int n = sscanf(params, "%15[^,],%li", key, &value);
+    if (n < 1) return AT_PARAM_ERROR;
+    if (key[0] >= '0' && key[0] <= '9') {
+        if (!App_Param_Find((uint8_t)strtol(key, NULL, 0), &r)) return AT_PARAM_ERROR;
+    } else if (!App_Param_FindByName(key, &r)) {
+        return AT_PARAM_ERROR;
+    }
+
+    if (n == 2 && App_Param_Set(&r, (int32_t)value) != PARAM_OK) return AT_PARAM_ERROR;
+    AT_SendParam(&r);
+    return AT_OK;
+}
+
+// AT+PARAM  列出全部运行参数
+static AtCmdStatus_t Process_ParamList(void) {
+    ParamRef_t r;
+    for (uint16_t pos = 0; App_Param_At(pos, &r); pos++) AT_SendParam(&r);
+    return AT_OK;
+}
+
+// AT+PARAMSAVE  运行参数写入 Flash
+static AtCmdStatus_t Process_ParamSave(void) {
+    if (App_Param_Save() != PARAM_OK) return AT_ERROR;
+    AT_SendResponse("+PARAMSAVE:OK");
+    return AT_OK;
+}
+
+// AT+PARAMRST  运行参数恢复默认值 (不写 Flash)
+static AtCmdStatus_t Process_ParamReset(void) {
+    App_Param_ResetDefaults();
+    AT_SendResponse("+PARAMRST:OK");
+    return AT_OK;
+}
+
+// AT+LINGRP=<Mask>  设置 LIN 组播成员掩码 (bit0~3 对应组 0~3, Flash保存)
+static AtCmdStatus_t Process_LinGrp(char *params) {
+    if (!params) return AT_PARAM_ERROR;
+    int mask;
+    if (sscanf(params, "%i", &mask) != 1 || mask < 0 || mask > 0x0F) return AT_PARAM_ERROR;
+
+    App_Storage_SetLinGroups((uint8_t)mask);
+    AT_SendResponse("+LINGRP:OK Node=0x%02X,Groups=0x%lX", 
+                    (g_Config.device_id >= 1 && g_Config.device_id <= LIN_NODE_MAX) ?
+                        (unsigned)(LIN_ID_NODE_BASE + g_Config.device_id - 1) : 0xFFu,
+                    g_Config.lin_group_mask);
+    return AT_OK;
+}
+
+// AT+EVT  事件总线统计与主循环空闲次数
+static AtCmdStatus_t Process_EventStat(void) {
+    EventBusStat_t st;
+    PowerStat_t pw;
+    EventBus_GetStat(&st);
+    App_Power_GetStat(&pw);
+    AT_SendResponse("+EVT:Pending=0x%02lX,Dispatch=%lu,Subs=%d,Timers=%d,Idle=%lu",
+                    st.pending, st.dispatches, st.subscribers, st.timers_active, pw.idles);
+    AT_SendResponse("+EVT:MotorDone=%lu,Limit=%lu,Fault=%lu,Timer=%lu,Adc=%lu,Lin=%lu",
+                    st.posted[EVT_MOTOR_DONE], st.posted[EVT_LIMIT], st.posted[EVT_FAULT],
+                    st.posted[EVT_TIMER], st.posted[EVT_ADC], st.posted[EVT_LIN_CMD]);
+    return AT_OK;
+}
@@ -0,0 +1,114 @@
+#include "event_bus.h"
+#include "bsp_time.h"
+
+typedef struct {
+    uint32_t mask;
+    EventHandler_t handler;
+    void *ctx;
+} EventSub_t;
+
+static EventSub_t evt_subs[EVENT_SUB_MAX];
+static uint8_t evt_sub_count = 0;
+static volatile uint32_t evt_pending = 0;
+static EventBusStat_t evt_stat;
+
+// 定时器到期时刻 (BSP_Time_GetUs 时基), 0 = 未运行; 主循环与 TIM3 中断共用, 访问时关中断
+static uint64_t evt_timer_due[EVENT_TIMER_MAX];
+
+void EventBus_Post(EventId_t evt) {
+    if (evt >= EVT_COUNT) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    evt_pending |= EVT_BIT(evt);
+    evt_stat.posted[evt]++;
+    __set_PRIMASK(primask);
+}
+
+uint8_t EventBus_Subscribe(uint32_t mask, EventHandler_t handler, void *ctx) {
+    if (!handler || evt_sub_count >= EVENT_SUB_MAX) return 0;
+    evt_subs[evt_sub_count].mask = mask;
+    evt_subs[evt_sub_count].handler = handler;
+    evt_subs[evt_sub_count].ctx = ctx;
+    evt_sub_count++;
+    return 1;
+}
+
+void EventBus_Process(void) {
+    if (evt_pending == 0) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t events = evt_pending;
+    evt_pending = 0;
+    __set_PRIMASK(primask);
+
+    evt_stat.dispatches++;
+    for (uint8_t i = 0; i < evt_sub_count; i++) {
+        uint32_t hit = events & evt_subs[i].mask;
+        if (hit) evt_subs[i].handler(hit, evt_subs[i].ctx);
+    }
+}
+
+uint8_t EventBus_Idle(void) {
+    return evt_pending == 0;
+}
+
+// 把最早到期的定时器装入闹钟 (关中断下调用)
+static void Evt_OnAlarm(uint8_t arg);
+static void Evt_ArmAlarm(void) {
+    uint64_t next = 0;
+    for (uint8_t t = 0; t < EVENT_TIMER_MAX; t++) {
+        if (evt_timer_due[t] && (next == 0 || evt_timer_due[t] < next)) next = evt_timer_due[t];
+    }
+    if (next) {
+        BSP_Time_SetAlarm(BSP_TIME_ALARM_EVENT, next, Evt_OnAlarm, 0);
+    } else {
+        BSP_Time_CancelAlarm(BSP_TIME_ALARM_EVENT);
+    }
+}
+
+// TIM3 比较中断上下文
+static void Evt_OnAlarm(uint8_t arg) {
+    (void)arg;
+    uint64_t now = BSP_Time_GetUs();
+    uint8_t fired = 0;
+    for (uint8_t t = 0; t < EVENT_TIMER_MAX; t++) {
+        if (evt_timer_due[t] && evt_timer_due[t] <= now) {
+            evt_timer_due[t] = 0;
+            fired = 1;
+        }
+    }
+    if (fired) EventBus_Post(EVT_TIMER);
+    Evt_ArmAlarm();
+}
+
+void EventBus_StartTimer(uint8_t t, uint32_t ms) {
+    if (t >= EVENT_TIMER_MAX) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    evt_timer_due[t] = BSP_Time_GetUs() + (uint64_t)ms * 1000u + 1u; // +1: 保证非 0
+    Evt_ArmAlarm();
+    __set_PRIMASK(primask);
+}
+
+void EventBus_StopTimer(uint8_t t) {
+    if (t >= EVENT_TIMER_MAX) return;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    evt_timer_due[t] = 0;
+    Evt_ArmAlarm();
+    __set_PRIMASK(primask);
+}
+
+void EventBus_GetStat(EventBusStat_t *stat) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stat = evt_stat;
+    stat->subscribers = evt_sub_count;
+    stat->timers_active = 0;
+    for (uint8_t t = 0; t < EVENT_TIMER_MAX; t++) {
+        if (evt_timer_due[t]) stat->timers_active++;
+    }
+    stat->pending = evt_pending;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,152 @@
+#include "flash_job.h"
+#include "bsp_time.h"
+#define LOG_MODULE LOG_MOD_STORAGE
+#include "log.h"
+#include <string.h>
+
+static FlashJob_t job_queue[FLASH_JOB_QUEUE_SIZE];
+static uint8_t job_head = 0;
+static uint8_t job_count = 0;
+static uint16_t job_off = 0;        // 当前编程作业已完成字节数
+static uint8_t job_abort_chain = 0; // 失败链, 其后续作业取消
+static uint8_t job_deferring = 0;
+static uint32_t job_defer_tick = 0;
+
+static FlashGuardPrepare_t guard_prepare = NULL;
+static FlashGuardFinish_t guard_finish = NULL;
+static FlashJobStat_t job_stat;
+
+uint8_t FlashJob_Submit(const FlashJob_t *job) {
+    if (!job || job_count >= FLASH_JOB_QUEUE_SIZE) return 0;
+    if (job->op == FLASH_JOB_PROGRAM && ((job->len & 1u) || (job->addr & 1u))) return 0;
+
+    job_queue[(job_head + job_count) % FLASH_JOB_QUEUE_SIZE] = *job;
+    job_count++;
+    if (job_count > job_stat.pending_max) job_stat.pending_max = job_count;
+    return 1;
+}
+
+uint8_t FlashJob_Free(void) {
+    return (uint8_t)(FLASH_JOB_QUEUE_SIZE - job_count);
+}
+
+uint8_t FlashJob_Idle(void) {
+    return job_count == 0;
+}
+
+void FlashJob_SetGuard(FlashGuardPrepare_t prepare, FlashGuardFinish_t finish) {
+    guard_prepare = prepare;
+    guard_finish = finish;
+}
+
+void FlashJob_GetStat(FlashJobStat_t *stat) {
+    if (!stat) return;
+    *stat = job_stat;
+    stat->pending = job_count;
+}
+
+// 出队并回调 (回调中可以提交新作业)
+static void Job_Finish(uint8_t ok) {
+    FlashJob_t job = job_queue[job_head];
+    job_head = (uint8_t)((job_head + 1u) % FLASH_JOB_QUEUE_SIZE);
+    job_count--;
+    job_off = 0;
+    job_deferring = 0;
+
+    if (ok) {
+        job_stat.done++;
+    } else {
+        job_stat.failed++;
+        if (job.chain) job_abort_chain = job.chain;
+        LOG_ERROR("Flash job failed: op=%d addr=0x%08lx\r\n", job.op, job.addr);
+    }
+    if (job.cb) job.cb(job.ctx, ok);
+}
+
+static void Job_Erase(const FlashJob_t *job, uint8_t force) {
+    BSP_FlashGuard_t guard[FLASH_JOB_GUARD_MAX];
+    uint8_t n = 0, defer = 0;
+
+    memset(guard, 0, sizeof(guard));
+    if (guard_prepare) n = guard_prepare(guard, FLASH_JOB_GUARD_MAX, &defer);
+    if (n > FLASH_JOB_GUARD_MAX) n = FLASH_JOB_GUARD_MAX;
+
+    // 运动中 (守护无法覆盖的控制, 如脉冲计数) 先推迟, 超时后带守护执行
+    if (defer && !force) {
+        if (!job_deferring) {
+            job_deferring = 1;
+            job_defer_tick = HAL_GetTick();
+            job_stat.deferred++;
+        }
+        if (HAL_GetTick() - job_defer_tick < FLASH_JOB_DEFER_MAX_MS) return;
+    }
+
+    HAL_FLASH_Unlock();
+    uint64_t t0 = BSP_Time_GetUs();
+    uint8_t ok = BSP_Flash_ErasePage(job->addr, guard, n);
+    uint32_t dt = (uint32_t)(BSP_Time_GetUs() - t0);
+    HAL_FLASH_Lock();
+
+    job_stat.erases++;
+    if (dt > job_stat.erase_max_us) job_stat.erase_max_us = dt;
+
+    uint8_t tripped = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (guard[i].tripped) tripped++;
+    }
+    job_stat.trips += tripped;
+    if (n && guard_finish) guard_finish(guard, n);
+    Job_Finish(ok);
+}
+
+static void Job_Program(const FlashJob_t *job) {
+    uint8_t ok = 1;
+
+    HAL_FLASH_Unlock();
+    for (uint8_t i = 0; i < FLASH_JOB_HALF_PER_CALL && job_off < job->len; i++) {
+        uint16_t half;
+        if (job->read) {
+            half = job->read(job->ctx, job_off);
+        } else {
+            memcpy(&half, (const uint8_t *)job->src + job_off, sizeof(half));
+        }
+        uint32_t addr = job->addr + job_off;
+        // 擦除值无需编程
+        if (half != 0xFFFFu || *(const volatile uint16_t *)addr != 0xFFFFu) {
+            if (!BSP_Flash_ProgramHalf(addr, half)) {
+                ok = 0;
+                break;
+            }
+            job_stat.halfwords++;
+        }
+        job_off += 2;
+    }
+    HAL_FLASH_Lock();
+
+    if (!ok || job_off >= job->len) Job_Finish(ok);
+}
+
+static void Job_Step(uint8_t force) {
+    if (job_count == 0) return;
+    const FlashJob_t *job = &job_queue[job_head];
+
+    if (job->chain != job_abort_chain) job_abort_chain = 0;
+    if (job_abort_chain) {
+        Job_Finish(0); // 所在链前面的作业已失败
+        return;
+    }
+
+    if (job->op == FLASH_JOB_ERASE) {
+        Job_Erase(job, force);
+    } else {
+        Job_Program(job);
+    }
+}
+
+void FlashJob_Process(void) {
+    Job_Step(0);
+}
+
+void FlashJob_Flush(void) {
+    while (job_count) Job_Step(1);
+}
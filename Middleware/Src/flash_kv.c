@@ -0,0 +1,418 @@
+#include "flash_kv.h"
+#include "flash_job.h"
+#include "bsp_conf.h"
+#include "bsp_crc.h"
+#define LOG_MODULE LOG_MOD_STORAGE
+#include "log.h"
+#include <string.h>
+
+#define KV_PAGE_MAGIC     0x3156534Bu // "KSV1"
+#define KV_HDR_BYTES      8           // 页头: 魔数 + 代号
+#define KV_REC_OVERHEAD   12          // 记录头 (Key|Len, Seq) + CRC
+#define KV_ALIGN4(n)      (((uint32_t)(n) + 3u) & ~3u)
+#define KV_REC_BYTES(len) (KV_REC_OVERHEAD + KV_ALIGN4(len))
+#define KV_REC_WORDS_MAX  (KV_REC_BYTES(FLASH_KV_MAX_LEN) / 4)
+#define KV_PENDING_MAX    4           // 排队中的新记录缓冲数
+#define KV_JOB_CHAIN      1           // 整理作业链
+#define KV_COMPACT_JOBS   5           // 整理最多提交的作业数
+
+typedef struct {
+    uint16_t key;
+    uint16_t off;   // 最新记录在活动页内的偏移
+} KvIndex_t;
+
+// 整理映射: 新页中第 i 条记录来自旧页 src_off[i]
+typedef struct {
+    uint32_t src_base;
+    uint16_t src_off[FLASH_KV_MAX_KEYS];
+    uint16_t dst_off[FLASH_KV_MAX_KEYS];
+    uint16_t rec_len[FLASH_KV_MAX_KEYS];
+    uint8_t  count;
+    uint8_t  cursor;
+} KvCompactMap_t;
+
+static const uint32_t kv_page_addr[2] = { FLASH_KV_PAGE0_ADDR, FLASH_KV_PAGE1_ADDR };
+
+static KvIndex_t kv_index[FLASH_KV_MAX_KEYS];
+static uint8_t  kv_keys = 0;
+static uint8_t  kv_page = 0;
+static uint32_t kv_gen = 0;
+static uint32_t kv_seq = 0;     // 下一条记录的序号
+static uint16_t kv_free = FLASH_KV_PAGE_SIZE; // 活动页空闲区起点, = 页大小表示需整理后才能写
+static uint32_t kv_writes = 0;
+static uint32_t kv_compacts = 0;
+static uint32_t kv_crc_errs = 0;
+
+// 异步写入: RAM 状态 (索引/空闲区/活动页) 在提交时即更新, Flash 由作业队列随后追上
+static uint32_t kv_rec_buf[KV_PENDING_MAX][KV_REC_WORDS_MAX];
+static uint8_t  kv_rec_busy[KV_PENDING_MAX];
+static uint32_t kv_rec_addr[KV_PENDING_MAX]; // 缓冲中记录的目标地址
+static uint32_t kv_hdr[2];
+static KvCompactMap_t kv_cmap;
+static uint8_t  kv_compacting = 0;
+static volatile uint8_t kv_reload = 0; // 作业失败: RAM 状态与 Flash 可能不一致, 需重新扫描
+
+static inline uint32_t KV_Word(uint32_t addr) {
+    return *(const volatile uint32_t *)addr;
+}
+
+// 记录 CRC 使用 CRC 服务 (bsp_crc.h). 旧版固件写入的记录使用按字节反射的 CRC-32 (IEEE 802.3),
+// 扫描时仍然接受; 该键下次写入即换成新算法 (整理只搬移记录, 不改写其 CRC)
+#define KV_CRC_BAD     0
+#define KV_CRC_OK      1
+#define KV_CRC_LEGACY  2
+
+typedef struct {
+    uint16_t records;   // 有效记录数 (含被同键新记录覆盖的)
+    uint16_t legacy;    // 其中旧版 CRC 的记录数
+    uint16_t bad;       // 损坏记录数
+} KvScan_t;
+
+static uint32_t KV_Crc32Legacy(const uint8_t *p, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static uint8_t KV_RecordCheck(uint32_t addr, uint32_t rec) {
+    uint32_t stored = KV_Word(addr + rec - 4u);
+    if (BSP_Crc_Calc((const void *)addr, rec - 4u) == stored) return KV_CRC_OK;
+    if (KV_Crc32Legacy((const uint8_t *)addr, rec - 4u) == stored) return KV_CRC_LEGACY;
+    return KV_CRC_BAD;
+}
+
+static int KV_IndexFind(uint16_t key) {
+    for (int i = 0; i < kv_keys; i++) {
+        if (kv_index[i].key == key) return i;
+    }
+    return -1;
+}
+
+static uint8_t KV_IndexSet(uint16_t key, uint16_t off) {
+    int i = KV_IndexFind(key);
+    if (i < 0) {
+        if (kv_keys >= FLASH_KV_MAX_KEYS) return 0;
+        i = kv_keys++;
+        kv_index[i].key = key;
+    }
+    kv_index[i].off = off;
+    return 1;
+}
+
+// 记录当前内容的位置: 尚在队列中的记录取 RAM 缓冲, 整理未完成时取旧页中的原记录
+static const uint8_t *KV_RecordPtr(uint16_t off) {
+    uint32_t addr = kv_page_addr[kv_page] + off;
+    if (kv_compacting) {
+        for (uint8_t j = 0; j < kv_cmap.count; j++) {
+            if (kv_cmap.dst_off[j] == off) {
+                addr = kv_cmap.src_base + kv_cmap.src_off[j];
+                break;
+            }
+        }
+    }
+    for (int k = 0; k < KV_PENDING_MAX; k++) {
+        if (kv_rec_busy[k] && kv_rec_addr[k] == addr) return (const uint8_t *)kv_rec_buf[k];
+    }
+    return (const uint8_t *)addr;
+}
+
+static uint16_t KV_RecordLen(const uint8_t *rec) {
+    uint32_t w0;
+    memcpy(&w0, rec, sizeof(w0));
+    return (uint16_t)(w0 >> 16);
+}
+
+static uint8_t KV_PageErased(uint8_t page) {
+    uint32_t base = kv_page_addr[page];
+    for (uint32_t off = 0; off < FLASH_KV_PAGE_SIZE; off += 4) {
+        if (KV_Word(base + off) != 0xFFFFFFFFu) return 0;
+    }
+    return 1;
+}
+
+static void KV_OnJobDone(void *ctx, uint8_t ok) {
+    (void)ctx;
+    if (!ok) kv_reload = 1;
+}
+
+static void KV_OnRecordDone(void *ctx, uint8_t ok) {
+    *(uint8_t *)ctx = 0; // 释放记录缓冲
+    if (!ok) kv_reload = 1;
+}
+
+static void KV_OnCompactDone(void *ctx, uint8_t ok) {
+    (void)ctx;
+    kv_compacting = 0;
+    if (!ok) kv_reload = 1;
+}
+
+static uint8_t KV_SubmitErase(uint8_t page, uint8_t chain, FlashJobCb_t cb) {
+    FlashJob_t job = { .op = FLASH_JOB_ERASE, .chain = chain, .addr = kv_page_addr[page], .cb = cb };
+    return FlashJob_Submit(&job);
+}
+
+static uint8_t KV_SubmitProgram(uint32_t addr, const void *src, uint16_t len, uint8_t chain,
+                                FlashJobCb_t cb, void *ctx) {
+    FlashJob_t job = { .op = FLASH_JOB_PROGRAM, .chain = chain, .addr = addr, .len = len,
+                       .src = src, .cb = cb, .ctx = ctx };
+    return FlashJob_Submit(&job);
+}
+
+// 遍历活动页校验每条记录; build = 1 时同时建立索引, 确定序号与空闲区起点
+static void KV_Walk(uint8_t build, KvScan_t *scan) {
+    uint32_t base = kv_page_addr[kv_page];
+    uint32_t off = KV_HDR_BYTES;
+
+    memset(scan, 0, sizeof(*scan));
+    if (build) kv_keys = 0;
+    while (off + KV_REC_OVERHEAD <= FLASH_KV_PAGE_SIZE) {
+        uint32_t w0 = KV_Word(base + off);
+        if (w0 == 0xFFFFFFFFu) break; // 空闲区
+
+        uint16_t key = (uint16_t)(w0 & 0xFFFFu);
+        uint16_t len = (uint16_t)(w0 >> 16);
+        uint32_t rec = KV_REC_BYTES(len);
+        if (key == FLASH_KV_KEY_ERASED || len > FLASH_KV_MAX_LEN || off + rec > FLASH_KV_PAGE_SIZE) {
+            // 记录头只写了一半: 后续位置不可知, 视为写满, 下次写入时整理
+            scan->bad++;
+            off = FLASH_KV_PAGE_SIZE;
+            break;
+        }
+
+        uint32_t seq = KV_Word(base + off + 4);
+        uint8_t res = KV_RecordCheck(base + off, rec);
+        if (res == KV_CRC_BAD) {
+            scan->bad++; // 写入中掉电 / 内容损坏, 保留该键上一条记录
+        } else {
+            scan->records++;
+            if (res == KV_CRC_LEGACY) scan->legacy++;
+            // 同页内记录按追加顺序排列, 后出现的即为最新
+            if (build) {
+                if (!KV_IndexSet(key, (uint16_t)off)) scan->bad++;
+                if ((int32_t)(seq - kv_seq) >= 0) kv_seq = seq + 1;
+            }
+        }
+        off += rec;
+    }
+    if (build) kv_free = (uint16_t)off;
+}
+
+static void KV_Scan(void) {
+    KvScan_t scan;
+    KV_Walk(1, &scan);
+    kv_crc_errs += scan.bad;
+    if (scan.legacy) LOG_INFO("KV %u records with legacy CRC\r\n", scan.legacy);
+}
+
+// 整理作业的数据源: 按新页偏移取旧页中对应记录的半字 (作业顺序执行, 游标只增不减)
+static uint16_t KV_CompactRead(void *ctx, uint32_t off) {
+    KvCompactMap_t *m = (KvCompactMap_t *)ctx;
+    uint32_t dst = KV_HDR_BYTES + off;
+    if (dst < m->dst_off[m->cursor]) m->cursor = 0;
+    while (m->cursor + 1u < m->count && dst >= (uint32_t)m->dst_off[m->cursor] + m->rec_len[m->cursor]) m->cursor++;
+    uint32_t src = m->src_base + m->src_off[m->cursor] + (dst - m->dst_off[m->cursor]);
+    return *(const volatile uint16_t *)src;
+}
+
+// 把每个键的最新记录搬到另一页, 最后写页头提交; 完成前掉电旧页仍然有效
+// 作业链: [擦除新页] -> 搬移记录 -> 代号 -> 魔数 (提交点) -> 擦除旧页, 任一步失败后续取消
+// 调用前确认上一次整理已完成且队列有 KV_COMPACT_JOBS 个空位
+static uint8_t KV_Compact(void) {
+    uint8_t dst = kv_page ^ 1u;
+    uint32_t dst_base = kv_page_addr[dst];
+
+    kv_cmap.src_base = kv_page_addr[kv_page];
+    kv_cmap.count = kv_keys;
+    kv_cmap.cursor = 0;
+    uint32_t off = KV_HDR_BYTES;
+    for (int i = 0; i < kv_keys; i++) {
+        uint16_t rec = (uint16_t)KV_REC_BYTES(KV_RecordLen(KV_RecordPtr(kv_index[i].off))); // 记录可能仍在队列中
+        kv_cmap.src_off[i] = kv_index[i].off;
+        kv_cmap.dst_off[i] = (uint16_t)off;
+        kv_cmap.rec_len[i] = rec;
+        off += rec;
+    }
+    if (off > FLASH_KV_PAGE_SIZE) return 0;
+
+    kv_hdr[0] = KV_PAGE_MAGIC;
+    kv_hdr[1] = kv_gen + 1u;
+
+    uint8_t ok = 1;
+    if (!KV_PageErased(dst)) ok &= KV_SubmitErase(dst, KV_JOB_CHAIN, NULL);
+    if (off > KV_HDR_BYTES) {
+        FlashJob_t copy = { .op = FLASH_JOB_PROGRAM, .chain = KV_JOB_CHAIN, .addr = dst_base + KV_HDR_BYTES,
+                            .len = (uint16_t)(off - KV_HDR_BYTES), .read = KV_CompactRead, .ctx = &kv_cmap };
+        ok &= FlashJob_Submit(&copy);
+    }
+    ok &= KV_SubmitProgram(dst_base + 4u, &kv_hdr[1], 4, KV_JOB_CHAIN, NULL, NULL);
+    ok &= KV_SubmitProgram(dst_base, &kv_hdr[0], 4, KV_JOB_CHAIN, NULL, NULL); // 提交点
+    // 旧页随后擦除, 下次整理时可直接使用 (擦除中掉电无妨: 新页代号更大)
+    ok &= KV_SubmitErase(kv_page, KV_JOB_CHAIN, KV_OnCompactDone);
+    if (!ok) {
+        kv_reload = 1;
+        return 0;
+    }
+
+    for (int i = 0; i < kv_keys; i++) kv_index[i].off = kv_cmap.dst_off[i];
+    kv_page = dst;
+    kv_gen++;
+    kv_free = (uint16_t)off;
+    kv_compacts++;
+    kv_compacting = 1;
+    LOG_INFO("KV compacting to page %d, gen=%lu, used=%u\r\n", kv_page, kv_gen, kv_free);
+    return 1;
+}
+
+// 从 Flash 建立 RAM 状态: 选代号最大的有效页并扫描
+static uint8_t KV_Load(void) {
+    uint8_t valid[2];
+    for (int p = 0; p < 2; p++) valid[p] = (KV_Word(kv_page_addr[p]) == KV_PAGE_MAGIC);
+
+    kv_keys = 0;
+    kv_seq = 0;
+    kv_compacting = 0;
+    kv_reload = 0;
+    if (!valid[0] && !valid[1]) return 0;
+
+    if (valid[0] && valid[1]) {
+        // 整理后擦除旧页前掉电: 取代号较新的一页
+        uint32_t g0 = KV_Word(kv_page_addr[0] + 4), g1 = KV_Word(kv_page_addr[1] + 4);
+        kv_page = ((int32_t)(g1 - g0) > 0) ? 1 : 0;
+    } else {
+        kv_page = valid[0] ? 0 : 1;
+    }
+    kv_gen = KV_Word(kv_page_addr[kv_page] + 4);
+    KV_Scan();
+    return 1;
+}
+
+uint8_t FlashKV_Init(void) {
+    kv_crc_errs = 0;
+    if (KV_Load()) {
+        LOG_INFO("KV page %d gen=%lu keys=%d used=%u bad=%lu\r\n", kv_page, kv_gen, kv_keys, kv_free, kv_crc_errs);
+        return 1;
+    }
+
+    // 空白存储: 只格式化页 0, 页 1 可能仍保存旧版整页配置, 待首次整理时才擦除
+    kv_page = 0;
+    kv_gen = 1;
+    kv_free = FLASH_KV_PAGE_SIZE;
+    kv_hdr[0] = KV_PAGE_MAGIC;
+    kv_hdr[1] = kv_gen;
+    if (!KV_PageErased(0)) KV_SubmitErase(0, KV_JOB_CHAIN, NULL);
+    KV_SubmitProgram(kv_page_addr[0] + 4u, &kv_hdr[1], 4, KV_JOB_CHAIN, NULL, NULL);
+    KV_SubmitProgram(kv_page_addr[0], &kv_hdr[0], 4, KV_JOB_CHAIN, KV_OnJobDone, NULL);
+    FlashJob_Flush();
+    if (!kv_reload) kv_free = KV_HDR_BYTES;
+    kv_reload = 0;
+    LOG_INFO("KV formatted\r\n");
+    return 0;
+}
+
+int FlashKV_Read(uint16_t key, void *buf, uint16_t size) {
+    int i = KV_IndexFind(key);
+    if (i < 0) return -1;
+
+    // 索引可能指向尚在队列中的记录, 此时从 RAM 缓冲读取, 不等待队列
+    const uint8_t *rec = KV_RecordPtr(kv_index[i].off);
+    uint16_t len = KV_RecordLen(rec);
+    if (buf) memcpy(buf, rec + 8u, (len < size) ? len : size);
+    return len;
+}
+
+static int KV_FreeSlot(void) {
+    for (int k = 0; k < KV_PENDING_MAX; k++) {
+        if (!kv_rec_busy[k]) return k;
+    }
+    return -1;
+}
+
+uint8_t FlashKV_Busy(void) {
+    if (kv_reload && !FlashJob_Idle()) return 1;
+    return KV_FreeSlot() < 0 || FlashJob_Free() == 0;
+}
+
+FlashKvResult_t FlashKV_Write(uint16_t key, const void *data, uint16_t len) {
+    if (key == FLASH_KV_KEY_ERASED || len > FLASH_KV_MAX_LEN || (len && !data)) return FLASH_KV_ERR;
+
+    // 之前的作业失败: 等队列清空后按 Flash 实际内容重建状态
+    if (kv_reload) {
+        if (!FlashJob_Idle()) return FLASH_KV_BUSY;
+        KV_Load();
+        LOG_WARN("KV reloaded after flash error\r\n");
+    }
+
+    int i = KV_IndexFind(key);
+    if (i >= 0) {
+        // 内容未变则不写 (与队列中尚未写入的最新记录比较)
+        const uint8_t *cur = KV_RecordPtr(kv_index[i].off);
+        if (KV_RecordLen(cur) == len && memcmp(cur + 8u, data, len) == 0) return FLASH_KV_OK;
+    } else if (kv_keys >= FLASH_KV_MAX_KEYS) {
+        LOG_ERROR("KV index full, key=0x%04x\r\n", key);
+        return FLASH_KV_ERR;
+    }
+
+    // 记录缓冲或作业队列已满: 不在此等待 (擦除可能正因运动而推迟), 由调用方稍后重试
+    int slot = KV_FreeSlot();
+    if (slot < 0 || FlashJob_Free() == 0) return FLASH_KV_BUSY;
+
+    // 在 RAM 中组好整条记录, CRC 与 Flash 中内容一致
+    uint32_t *rec_buf = kv_rec_buf[slot];
+    uint32_t rec = KV_REC_BYTES(len);
+    memset(rec_buf, 0xFF, KV_REC_WORDS_MAX * 4u);
+    rec_buf[0] = (uint32_t)key | ((uint32_t)len << 16);
+    rec_buf[1] = kv_seq;
+    if (len) memcpy(&rec_buf[2], data, len);
+    rec_buf[rec / 4u - 1u] = BSP_Crc_Calc(rec_buf, rec - 4u);
+
+    if (kv_free + rec > FLASH_KV_PAGE_SIZE) {
+        // 整理 + 本条记录需要 KV_COMPACT_JOBS + 1 个队列空位, 上一次整理须已完成
+        if (kv_compacting || FlashJob_Free() < KV_COMPACT_JOBS + 1u) return FLASH_KV_BUSY;
+        KV_Compact();
+    }
+    if (kv_free + rec > FLASH_KV_PAGE_SIZE) {
+        LOG_ERROR("KV full, key=0x%04x len=%u\r\n", key, len);
+        return FLASH_KV_ERR;
+    }
+
+    uint32_t off = kv_free;
+    kv_rec_busy[slot] = 1;
+    kv_rec_addr[slot] = kv_page_addr[kv_page] + off;
+    if (!KV_SubmitProgram(kv_rec_addr[slot], rec_buf, (uint16_t)rec, 0, KV_OnRecordDone, &kv_rec_busy[slot])) {
+        kv_rec_busy[slot] = 0;
+        return FLASH_KV_ERR;
+    }
+    KV_IndexSet(key, (uint16_t)off);
+    kv_free = (uint16_t)(off + rec);
+    kv_seq++;
+    kv_writes++;
+    return FLASH_KV_OK;
+}
+
+int FlashKV_Verify(FlashKvCheck_t *chk) {
+    KvScan_t scan;
+
+    if (!FlashJob_Idle()) return -1; // 队列中的记录尚未完整写入
+    KV_Walk(0, &scan);
+    if (chk) {
+        chk->records = scan.records;
+        chk->legacy = scan.legacy;
+        chk->bad = scan.bad;
+    }
+    return scan.bad;
+}
+
+void FlashKV_GetStat(FlashKvStat_t *stat) {
+    if (!stat) return;
+    stat->page = kv_page;
+    stat->gen = kv_gen;
+    stat->used = kv_free;
+    stat->size = FLASH_KV_PAGE_SIZE;
+    stat->keys = kv_keys;
+    stat->writes = kv_writes;
+    stat->compacts = kv_compacts;
+    stat->crc_errs = kv_crc_errs;
+}
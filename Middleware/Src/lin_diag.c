@@ -0,0 +1,391 @@
+#include "lin_diag.h"
+#include "app_main.h"
+#include "app_storage.h"
+#include "app_motor.h"
+#include "app_adc.h"
+#include "app_param.h"
+#include "app_linkprog.h"
+#include "bsp_bldc.h"
+#define LOG_MODULE LOG_MOD_LIN
+#include "log.h"
+#include <string.h>
+
+// 接收 (请求重组)
+static uint8_t diag_rx_buf[LIN_DIAG_BUF_SIZE];
+static uint16_t diag_rx_len = 0;    // 总长度
+static uint16_t diag_rx_pos = 0;    // 已收字节
+static uint8_t diag_rx_sn = 0;      // 期望的 CF 序号
+static uint8_t diag_rx_active = 0;
+static uint32_t diag_rx_tick = 0;
+
+// 发送 (应答分段)
+static uint8_t diag_tx_buf[LIN_DIAG_BUF_SIZE];
+static uint16_t diag_tx_len = 0;    // 0 = 无待发应答
+static uint16_t diag_tx_pos = 0;
+static uint8_t diag_tx_sn = 0;
+static uint8_t diag_tx_nad = 0;
+static uint32_t diag_tx_tick = 0;
+
+static uint8_t Diag_MyNad(void) {
+    return (uint8_t)g_Config.device_id;
+}
+
+void LIN_Diag_Init(void) {
+    diag_rx_active = 0;
+    diag_tx_len = 0;
+}
+
+// ---------------- 应答组装 ----------------
+static void Diag_Respond(const uint8_t *data, uint16_t len) {
+    if (len > LIN_DIAG_BUF_SIZE) len = LIN_DIAG_BUF_SIZE;
+    memcpy(diag_tx_buf, data, len);
+    diag_tx_len = len;
+    diag_tx_pos = 0;
+    diag_tx_sn = 0;
+    diag_tx_nad = Diag_MyNad();
+    diag_tx_tick = HAL_GetTick();
+}
+
+static void Diag_Negative(uint8_t sid, uint8_t nrc) {
+    uint8_t r[3] = { LIN_SID_NEGATIVE, sid, nrc };
+    Diag_Respond(r, 3);
+}
+
+static void Put_U16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static uint16_t Get_U16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// 运行参数按类型宽度大端收发
+static void Put_Param(uint8_t *p, uint32_t v, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) p[i] = (uint8_t)(v >> (8u * (size - 1u - i)));
+}
+
+// 1/2 字节为无符号数, 4 字节按补码解释
+static int32_t Get_Param(const uint8_t *p, uint8_t size) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < size; i++) v = (v << 8) | p[i];
+    return (int32_t)v;
+}
+
+static uint32_t Get_U32(const uint8_t *p) {
+    return ((uint32_t)Get_U16(p) << 16) | Get_U16(p + 2);
+}
+
+// 联动程序上传结果 -> 否定应答码 (具体原因可读 LIN_DID_PROG_CTRL)
+static uint8_t Diag_ProgNrc(LinkProgResult_t res) {
+    switch (res) {
+        case LINKPROG_OK:         return 0;
+        case LINKPROG_ERR_STATE:  return LIN_NRC_CONDITIONS;
+        case LINKPROG_ERR_OFFSET: return LIN_NRC_SEQUENCE;
+        case LINKPROG_ERR_LENGTH: return LIN_NRC_SEQUENCE;
+        case LINKPROG_ERR_FLASH:  return LIN_NRC_PROG_FAILURE;
+        default:                  return LIN_NRC_OUT_OF_RANGE;
+    }
+}
+
+static uint8_t Diag_ProgCtrl(const uint8_t *in, uint16_t len) {
+    switch (in[0]) {
+        case 1: { // [1 Slot LenH LenL Name..]
+            char name[LINKPROG_NAME_LEN + 1] = {0};
+            if (len < 4 || len > 4 + LINKPROG_NAME_LEN) return LIN_NRC_BAD_LENGTH;
+            memcpy(name, in + 4, len - 4u);
+            return Diag_ProgNrc(App_LinkProg_Begin(in[1], Get_U16(in + 2), name));
+        }
+        case 2:
+            if (len != 5) return LIN_NRC_BAD_LENGTH;
+            return Diag_ProgNrc(App_LinkProg_End(Get_U32(in + 1)));
+        case 3:
+            App_LinkProg_Abort();
+            return 0;
+        case 4:
+            if (len != 2) return LIN_NRC_BAD_LENGTH;
+            return Diag_ProgNrc(App_LinkProg_Delete(in[1]));
+        default:
+            return LIN_NRC_OUT_OF_RANGE;
+    }
+}
+
+// ---------------- 数据标识 ----------------
+// 读 DID, 返回数据长度, 不支持返回 -1
+static int Diag_ReadDid(uint16_t did, uint8_t *out) {
+    AdcProtectionConfig_t prot;
+    ParamRef_t param;
+
+    if (did == LIN_DID_DEVICE_ID) {
+        out[0] = (uint8_t)g_Config.device_id;
+        return 1;
+    }
+    if (did == LIN_DID_LIN_GROUPS) {
+        out[0] = (uint8_t)g_Config.lin_group_mask;
+        return 1;
+    }
+    if (did == LIN_DID_SW_VERSION) {
+        int n = (int)strlen(SW_VERSION);
+        memcpy(out, SW_VERSION, (size_t)n);
+        return n;
+    }
+    if (did >= LIN_DID_DECEL(0) && did < LIN_DID_DECEL(MAX_MOTORS)) {
+        uint32_t pulses = 0;
+        uint16_t min_speed = 0;
+        App_Motor_GetDecel((uint8_t)(did - LIN_DID_DECEL(0)), &pulses, &min_speed);
+        Put_U16(out, (uint16_t)(pulses >> 16));
+        Put_U16(out + 2, (uint16_t)pulses);
+        Put_U16(out + 4, min_speed);
+        return 6;
+    }
+    if (did >= LIN_DID_CURR_LIMIT(0) && did < LIN_DID_CURR_LIMIT(MAX_MOTORS)) {
+        App_Adc_GetProtectConfig(&prot);
+        Put_U16(out, (uint16_t)(prot.curr_limit_max[did - LIN_DID_CURR_LIMIT(0)] * 1000.0f));
+        return 2;
+    }
+    if (did == LIN_DID_PROTECT) {
+        App_Adc_GetProtectConfig(&prot);
+        out[0] = prot.protection_enable;
+        Put_U16(out + 1, (uint16_t)(prot.volt_limit_min * 10.0f));
+        Put_U16(out + 3, (uint16_t)(prot.volt_limit_max * 10.0f));
+        Put_U16(out + 5, (uint16_t)(prot.temp_limit_max * 10.0f));
+        return 7;
+    }
+    if (did >= LIN_DID_PARAM(0) && did <= LIN_DID_PARAM(0xFF) && App_Param_Find((uint8_t)(did - LIN_DID_PARAM(0)), &param)) {
+        uint8_t size = App_Param_Size(&param);
+        Put_Param(out, (uint32_t)App_Param_Get(&param), size);
+        return size;
+    }
+    if (did == LIN_DID_PROG_CTRL) {
+        LinkProgUpload_t up;
+        App_LinkProg_GetUpload(&up);
+        out[0] = up.state;
+        out[1] = up.slot;
+        Put_U16(out + 2, up.len);
+        Put_U16(out + 4, up.received);
+        out[6] = up.last_result;
+        out[7] = up.vm_err;
+        Put_U16(out + 8, up.vm_err_pc);
+        return 10;
+    }
+    if (did >= LIN_DID_PROG_SLOT(0) && did < LIN_DID_PROG_SLOT(LINKPROG_SLOTS)) {
+        LinkProgInfo_t info;
+        App_LinkProg_GetInfo((uint8_t)(did - LIN_DID_PROG_SLOT(0)), &info);
+        out[0] = info.valid;
+        Put_U16(out + 1, info.len);
+        Put_U16(out + 3, (uint16_t)(info.crc >> 16));
+        Put_U16(out + 5, (uint16_t)info.crc);
+        memcpy(out + 7, info.name, LINKPROG_NAME_LEN);
+        return 7 + LINKPROG_NAME_LEN;
+    }
+    return -1;
+}
+
+// 写 DID, 返回 0 成功, 否则为否定应答码
+static uint8_t Diag_WriteDid(uint16_t did, const uint8_t *in, uint16_t len) {
+    if (did == LIN_DID_DEVICE_ID) {
+        if (len != 1) return LIN_NRC_BAD_LENGTH;
+        if (in[0] < 1 || in[0] >= LIN_DIAG_NAD_WILDCARD) return LIN_NRC_OUT_OF_RANGE;
+        App_Storage_SetDeviceID(in[0]);
+        return 0;
+    }
+    if (did == LIN_DID_LIN_GROUPS) {
+        if (len != 1) return LIN_NRC_BAD_LENGTH;
+        if (in[0] > 0x0F) return LIN_NRC_OUT_OF_RANGE;
+        App_Storage_SetLinGroups(in[0]);
+        return 0;
+    }
+    if (did >= LIN_DID_DECEL(0) && did < LIN_DID_DECEL(MAX_MOTORS)) {
+        if (len != 6) return LIN_NRC_BAD_LENGTH;
+        uint32_t pulses = ((uint32_t)Get_U16(in) << 16) | Get_U16(in + 2);
+        App_Motor_ConfigDecel((uint8_t)(did - LIN_DID_DECEL(0)), pulses, Get_U16(in + 4));
+        return 0;
+    }
+    if (did >= LIN_DID_CURR_LIMIT(0) && did < LIN_DID_CURR_LIMIT(MAX_MOTORS)) {
+        if (len != 2) return LIN_NRC_BAD_LENGTH;
+        App_Adc_ConfigProtect_Motor((uint8_t)(did - LIN_DID_CURR_LIMIT(0)), Get_U16(in) / 1000.0f);
+        return 0;
+    }
+    if (did == LIN_DID_PROTECT) {
+        if (len != 7) return LIN_NRC_BAD_LENGTH;
+        float v_min = Get_U16(in + 1) / 10.0f;
+        float v_max = Get_U16(in + 3) / 10.0f;
+        if (v_min >= v_max) return LIN_NRC_OUT_OF_RANGE;
+        App_Adc_ConfigProtect_Global(v_min, v_max, Get_U16(in + 5) / 10.0f);
+        App_Adc_SetProtectEnable(in[0]);
+        return 0;
+    }
+    if (did == LIN_DID_PARAM_CMD) {
+        if (len != 1) return LIN_NRC_BAD_LENGTH;
+        if (in[0] == 1) return (App_Param_Save() == PARAM_OK) ? 0 : LIN_NRC_PROG_FAILURE;
+        if (in[0] == 2) { App_Param_ResetDefaults(); return 0; }
+        return LIN_NRC_OUT_OF_RANGE;
+    }
+    if (did >= LIN_DID_PARAM(0) && did <= LIN_DID_PARAM(0xFF)) {
+        ParamRef_t param;
+        if (!App_Param_Find((uint8_t)(did - LIN_DID_PARAM(0)), &param)) return LIN_NRC_OUT_OF_RANGE;
+        uint8_t size = App_Param_Size(&param);
+        if (len != size) return LIN_NRC_BAD_LENGTH;
+        return (App_Param_Set(&param, Get_Param(in, size)) == PARAM_OK) ? 0 : LIN_NRC_OUT_OF_RANGE;
+    }
+    if (did == LIN_DID_PROG_CTRL) return Diag_ProgCtrl(in, len);
+    if (did == LIN_DID_PROG_DATA) {
+        if (len < 3) return LIN_NRC_BAD_LENGTH;
+        return Diag_ProgNrc(App_LinkProg_Write(Get_U16(in), in + 2, (uint16_t)(len - 2)));
+    }
+    return LIN_NRC_OUT_OF_RANGE;
+}
+
+// ---------------- 服务分发 ----------------
+static void Diag_Dispatch(const uint8_t *req, uint16_t len, uint8_t respond) {
+    uint8_t rsp[LIN_DIAG_BUF_SIZE];
+    uint8_t sid = req[0];
+    uint8_t nrc = 0;
+    uint16_t rlen = 0;
+
+    switch (sid) {
+        case LIN_SID_READ_DID: {
+            if (len != 3) { nrc = LIN_NRC_BAD_LENGTH; break; }
+            int n = Diag_ReadDid(Get_U16(req + 1), rsp + 3);
+            if (n < 0) { nrc = LIN_NRC_OUT_OF_RANGE; break; }
+            rsp[0] = sid + 0x40;
+            rsp[1] = req[1];
+            rsp[2] = req[2];
+            rlen = (uint16_t)(3 + n);
+            break;
+        }
+        case LIN_SID_WRITE_DID:
+            if (len < 4) { nrc = LIN_NRC_BAD_LENGTH; break; }
+            nrc = Diag_WriteDid(Get_U16(req + 1), req + 3, (uint16_t)(len - 3));
+            if (nrc) break;
+            if (Get_U16(req + 1) != LIN_DID_PROG_DATA) LOG_INFO("LIN diag write DID 0x%04X\r\n", Get_U16(req + 1));
+            rsp[0] = sid + 0x40;
+            rsp[1] = req[1];
+            rsp[2] = req[2];
+            rlen = 3;
+            break;
+
+        case LIN_SID_READ_BY_ID: // [B2, Id, SupL, SupH, FuncL, FuncH]
+            if (len != 6) { nrc = LIN_NRC_BAD_LENGTH; break; }
+            if (req[1] != 0) { nrc = LIN_NRC_OUT_OF_RANGE; break; }
+            rsp[0] = sid + 0x40;
+            rsp[1] = (uint8_t)LIN_DIAG_SUPPLIER_ID;
+            rsp[2] = (uint8_t)(LIN_DIAG_SUPPLIER_ID >> 8);
+            rsp[3] = (uint8_t)LIN_DIAG_FUNCTION_ID;
+            rsp[4] = (uint8_t)(LIN_DIAG_FUNCTION_ID >> 8);
+            rsp[5] = LIN_DIAG_VARIANT;
+            rlen = 6;
+            break;
+
+        default:
+            nrc = LIN_NRC_NOT_SUPPORTED;
+            break;
+    }
+
+    if (!respond) return; // 通配 NAD: 只执行不应答, 避免多节点冲突
+    if (nrc) {
+        Diag_Negative(sid, nrc);
+    } else {
+        Diag_Respond(rsp, rlen);
+    }
+}
+
+// ---------------- 传输层 ----------------
+void LIN_Diag_OnRequest(const uint8_t *frame) {
+    uint8_t nad = frame[0];
+    uint8_t pci = frame[1];
+    uint8_t respond = (nad == Diag_MyNad());
+
+    if (!respond && nad != LIN_DIAG_NAD_WILDCARD) {
+        return; // 发给其他节点
+    }
+
+    switch (pci >> 4) {
+        case 0x0: { // SF
+            uint8_t len = pci & 0x0F;
+            if (len < 1 || len > 6) return;
+            diag_rx_active = 0;
+            diag_tx_len = 0; // 新请求丢弃未取走的应答
+            Diag_Dispatch(frame + 2, len, respond);
+            break;
+        }
+        case 0x1: { // FF
+            uint16_t len = (uint16_t)(((pci & 0x0F) << 8) | frame[2]);
+            diag_tx_len = 0;
+            if (len <= 6 || len > LIN_DIAG_BUF_SIZE) {
+                diag_rx_active = 0;
+                if (respond && len > LIN_DIAG_BUF_SIZE) Diag_Negative(frame[3], LIN_NRC_BAD_LENGTH);
+                return;
+            }
+            memcpy(diag_rx_buf, frame + 3, 5);
+            diag_rx_len = len;
+            diag_rx_pos = 5;
+            diag_rx_sn = 1;
+            diag_rx_active = 1;
+            diag_rx_tick = HAL_GetTick();
+            break;
+        }
+        case 0x2: { // CF
+            if (!diag_rx_active) return;
+            if ((pci & 0x0F) != diag_rx_sn) {
+                diag_rx_active = 0; // 序号错误, 放弃整条消息
+                return;
+            }
+            uint16_t n = diag_rx_len - diag_rx_pos;
+            if (n > 6) n = 6;
+            memcpy(diag_rx_buf + diag_rx_pos, frame + 2, n);
+            diag_rx_pos += n;
+            diag_rx_sn = (diag_rx_sn + 1) & 0x0F;
+            diag_rx_tick = HAL_GetTick();
+            if (diag_rx_pos >= diag_rx_len) {
+                diag_rx_active = 0;
+                Diag_Dispatch(diag_rx_buf, diag_rx_len, respond);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+uint8_t LIN_Diag_NextResponse(uint8_t *frame) {
+    if (diag_tx_len == 0 || diag_tx_pos >= diag_tx_len) return 0;
+
+    uint16_t remain = diag_tx_len - diag_tx_pos;
+    uint8_t n;
+    memset(frame, 0xFF, 8);
+    frame[0] = diag_tx_nad;
+
+    if (diag_tx_pos == 0 && diag_tx_len <= 6) {
+        frame[1] = (uint8_t)diag_tx_len; // SF
+        n = (uint8_t)diag_tx_len;
+        memcpy(frame + 2, diag_tx_buf, n);
+    } else if (diag_tx_pos == 0) {
+        frame[1] = (uint8_t)(0x10 | (diag_tx_len >> 8)); // FF
+        frame[2] = (uint8_t)diag_tx_len;
+        n = 5;
+        memcpy(frame + 3, diag_tx_buf, n);
+        diag_tx_sn = 1;
+    } else {
+        frame[1] = (uint8_t)(0x20 | diag_tx_sn); // CF
+        n = (remain > 6) ? 6 : (uint8_t)remain;
+        memcpy(frame + 2, diag_tx_buf + diag_tx_pos, n);
+        diag_tx_sn = (diag_tx_sn + 1) & 0x0F;
+    }
+
+    diag_tx_pos += n;
+    diag_tx_tick = HAL_GetTick();
+    if (diag_tx_pos >= diag_tx_len) diag_tx_len = 0;
+    return 1;
+}
+
+void LIN_Diag_Process(void) {
+    uint32_t now = HAL_GetTick();
+    if (diag_rx_active && now - diag_rx_tick > LIN_DIAG_TIMEOUT_MS) {
+        diag_rx_active = 0;
+        LOG_WARN("LIN diag rx timeout\r\n");
+    }
+    if (diag_tx_len && now - diag_tx_tick > LIN_DIAG_TIMEOUT_MS) {
+        diag_tx_len = 0; // 主机未来取应答
+    }
+}
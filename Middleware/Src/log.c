@@ -1,28 +1,231 @@
 #include "log.h"
+#include "bsp_time.h"
+#include "uart_tx.h"
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 
 static UART_HandleTypeDef* log_huart = NULL;
-static LogLevel_t current_log_level = MIN_LOG_LEVEL;
+
+// 每模块运行时状态: 级别 + 令牌桶 (令牌单位 1/1000 条, 按 ms 补充)
+typedef struct {
+  uint8_t  level;
+  uint16_t rate;
+  uint16_t burst;
+  uint32_t tokens;
+  uint32_t last_tick;
+  uint32_t emitted;
+  uint32_t suppressed;
+} LogModuleCtx_t;
+
+static LogModuleCtx_t log_mod[LOG_MOD_COUNT];
+
+static const char* const log_mod_names[LOG_MOD_COUNT] = {
+  "SYS", "ADC", "MOTOR", "LIN", "AT", "LINK", "STORAGE"
+};
 
 void Log_Init(UART_HandleTypeDef* huart)
 {
   log_huart = huart;
+  for (int m = 0; m < LOG_MOD_COUNT; m++) {
+    log_mod[m].level = MIN_LOG_LEVEL;
+    log_mod[m].rate = LOG_RATE_DEFAULT;
+    log_mod[m].burst = LOG_BURST_DEFAULT;
+    log_mod[m].tokens = (uint32_t)LOG_BURST_DEFAULT * 1000u;
+    log_mod[m].last_tick = HAL_GetTick();
+    log_mod[m].emitted = 0;
+    log_mod[m].suppressed = 0;
+  }
+}
+
+// 级别过滤 + 令牌桶限速, 中断安全
+static int Log_Allow(LogModule_t module, LogLevel_t level)
+{
+  if ((unsigned)module >= LOG_MOD_COUNT)
+    module = LOG_MOD_SYS;
+  LogModuleCtx_t *ctx = &log_mod[module];
+  if (level < ctx->level)
+    return 0;
+
+  int allow = 1;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (ctx->rate != 0) {
+    uint32_t now = HAL_GetTick();
+    uint32_t cap = (uint32_t)ctx->burst * 1000u;
+    uint32_t elapsed = now - ctx->last_tick;
+    if (elapsed > 60000u) elapsed = 60000u; // 防止乘法溢出, 桶早已补满
+    uint32_t refill = elapsed * ctx->rate;
+    ctx->last_tick = now;
+    ctx->tokens = (refill >= cap - ctx->tokens) ? cap : ctx->tokens + refill;
+
+    if (ctx->tokens >= 1000u) {
+      ctx->tokens -= 1000u;
+    } else {
+      allow = 0;
+    }
+  }
+  if (allow) ctx->emitted++;
+  else ctx->suppressed++;
+  __set_PRIMASK(primask);
+  return allow;
+}
+
+void Log_SetLevel(LogModule_t module, LogLevel_t level)
+{
+  if ((unsigned)module < LOG_MOD_COUNT && level <= LOG_LEVEL_NONE)
+    log_mod[module].level = (uint8_t)level;
+}
+
+void Log_SetRate(LogModule_t module, uint16_t rate, uint16_t burst)
+{
+  if ((unsigned)module >= LOG_MOD_COUNT)
+    return;
+  if (burst == 0)
+    burst = 1;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  log_mod[module].rate = rate;
+  log_mod[module].burst = burst;
+  log_mod[module].tokens = (uint32_t)burst * 1000u;
+  __set_PRIMASK(primask);
+}
+
+void Log_GetModuleStat(LogModule_t module, LogModuleStat_t *stat)
+{
+  if ((unsigned)module >= LOG_MOD_COUNT || !stat)
+    return;
+  stat->level = log_mod[module].level;
+  stat->rate = log_mod[module].rate;
+  stat->burst = log_mod[module].burst;
+  stat->emitted = log_mod[module].emitted;
+  stat->suppressed = log_mod[module].suppressed;
+}
+
+const char* Log_GetModuleName(LogModule_t module)
+{
+  return ((unsigned)module < LOG_MOD_COUNT) ? log_mod_names[module] : "?";
+}
+
+LogModule_t Log_FindModule(const char *name)
+{
+  for (int m = 0; m < LOG_MOD_COUNT; m++) {
+    if (strcasecmp(name, log_mod_names[m]) == 0)
+      return (LogModule_t)m;
+  }
+  return LOG_MOD_COUNT;
 }
 
-void Log_Print(LogLevel_t level, const char* fmt, ...)
+void Log_Print(LogModule_t module, LogLevel_t level, const char* fmt, ...)
 {
-  if (!log_huart || level < current_log_level)
+  if (!log_huart || !Log_Allow(module, level))
     return;
     
   char buf[512];
+  // 时间戳前缀 [秒.微秒]
+  uint64_t us = BSP_Time_GetUs();
+  int n = snprintf(buf, sizeof(buf), "[%lu.%06lu] ",
+                   (unsigned long)(us / 1000000u), (unsigned long)(us % 1000000u));
   va_list ap;
   va_start(ap, fmt);
-  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  n += vsnprintf(buf + n, sizeof(buf) - (size_t)n, fmt, ap);
   va_end(ap);
   
   if (n > 0) {
+    // 串口可能正被遥测 DMA 占用: 主循环中短暂等待并占用 (中断内不等待)
+    if (!UartTx_Acquire(log_huart, UART_TX_WAIT_MS))
+      return;
     HAL_UART_Transmit(log_huart, (uint8_t*)buf, 
                      (uint16_t)((n < (int)sizeof(buf)) ? n : (int)sizeof(buf)), 100);
+    UartTx_Release();
   }
-}
\ No newline at end of file
+}
+// ---------------- 延迟(二进制)日志 ----------------
+// 环形缓冲区: 生产者为任意上下文 (关中断写入), 消费者为主循环 Log_Process
+static uint8_t log_ring[LOG_RING_SIZE];
+static volatile uint16_t log_head = 0; // 写位置
+static volatile uint16_t log_tail = 0; // 读位置
+static volatile uint32_t log_dropped = 0;
+
+// DMA 发送缓冲 (DMA 期间不可改写, 仅在串口空闲时重新填充)
+#define LOG_TX_CHUNK 128
+static uint8_t log_tx_buf[LOG_TX_CHUNK];
+
+void Log_Deferred(LogModule_t module, LogLevel_t level, const char* fmt_id, uint8_t nargs, ...)
+{
+  if (!Log_Allow(module, level))
+    return;
+  if (nargs > LOG_MAX_ARGS)
+    nargs = LOG_MAX_ARGS;
+
+  // 组记录
+  uint8_t rec[3 + 2 + 4 + LOG_MAX_ARGS * 4 + 1];
+  uint8_t len = (uint8_t)(2 + 4 + nargs * 4);
+  uint32_t id = (uint32_t)(uintptr_t)fmt_id;
+  uint32_t ts = BSP_Time_GetUs32(); // 微秒, 主机端负责回绕展开
+  uint8_t *p = rec;
+
+  *p++ = LOG_BIN_SYNC0;
+  *p++ = LOG_BIN_SYNC1;
+  *p++ = len;
+  *p++ = (uint8_t)id;
+  *p++ = (uint8_t)(id >> 8);
+  for (int i = 0; i < 4; i++) *p++ = (uint8_t)(ts >> (8 * i));
+
+  va_list ap;
+  va_start(ap, nargs);
+  for (uint8_t a = 0; a < nargs; a++) {
+    uint32_t v = va_arg(ap, uint32_t);
+    for (int i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i));
+  }
+  va_end(ap);
+
+  uint8_t sum = 0;
+  for (uint8_t *q = rec + 2; q < p; q++) sum += *q;
+  *p++ = sum;
+
+  uint16_t total = (uint16_t)(p - rec);
+
+  // 写入环形缓冲区 (整条写入或整条丢弃)
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint16_t head = log_head;
+  uint16_t used = (uint16_t)((head + LOG_RING_SIZE - log_tail) % LOG_RING_SIZE);
+  if (used + total >= LOG_RING_SIZE) {
+    log_dropped++;
+  } else {
+    for (uint16_t i = 0; i < total; i++) {
+      log_ring[head] = rec[i];
+      head = (uint16_t)((head + 1) % LOG_RING_SIZE);
+    }
+    log_head = head;
+  }
+  __set_PRIMASK(primask);
+}
+
+void Log_Process(void)
+{
+  if (!log_huart || log_head == log_tail)
+    return;
+  // 串口被 AT 应答或遥测占用时下次再发
+  if (!UartTx_TryAcquire(log_huart))
+    return;
+
+  uint16_t tail = log_tail;
+  uint16_t head = log_head;
+  uint16_t n = 0;
+  while (tail != head && n < LOG_TX_CHUNK) {
+    log_tx_buf[n++] = log_ring[tail];
+    tail = (uint16_t)((tail + 1) % LOG_RING_SIZE);
+  }
+
+  if (HAL_UART_Transmit_DMA(log_huart, log_tx_buf, n) == HAL_OK) {
+    log_tail = tail;
+  }
+  UartTx_Release(); // DMA 已启动, 之后由 gState 表示忙
+}
+
+uint32_t Log_GetDropped(void)
+{
+  return log_dropped;
+}
@@ -0,0 +1,30 @@
+#include "uart_tx.h"
+
+static volatile uint8_t uart_tx_owned = 0;
+
+uint8_t UartTx_TryAcquire(UART_HandleTypeDef *huart) {
+    uint8_t ok = 0;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!uart_tx_owned && huart->gState == HAL_UART_STATE_READY) {
+        uart_tx_owned = 1;
+        ok = 1;
+    }
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+uint8_t UartTx_Acquire(UART_HandleTypeDef *huart, uint32_t timeout_ms) {
+    if (UartTx_TryAcquire(huart)) return 1;
+    if (__get_IPSR() != 0) return 0; // 中断内不等待
+
+    uint32_t t0 = HAL_GetTick();
+    while (HAL_GetTick() - t0 < timeout_ms) {
+        if (UartTx_TryAcquire(huart)) return 1;
+    }
+    return 0;
+}
+
+void UartTx_Release(void) {
+    uart_tx_owned = 0;
+}
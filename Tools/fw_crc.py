@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""固件镜像 CRC 签名工具 (构建后由 CMake 调用).
+
+在 Bin 中找到 .fw_info 块 (魔数 "FWI1", 位于向量表之后), 把 Bin 以 0xFF 补齐到 4 字节,
+填入镜像长度, 计算 [0, length) 的 CRC 并追加在末尾. 固件上电与 AT+CRC 时用同一算法校验
+(App/Inc/app_integrity.h, BSP/Inc/bsp_crc.h).
+
+CRC 与 STM32F1 CRC 外设一致 (CRC-32/MPEG-2, 按 32 位小端字从最高位处理).
+
+用法:
+    python3 Tools/fw_crc.py build/Debug/MotorControl_LIN_Hanghai.bin --hex build/Debug/MotorControl_LIN_Hanghai.hex
+    python3 Tools/fw_crc.py app.bin --check        只校验, 不修改
+    python3 Tools/fw_crc.py --selftest
+"""
+import argparse
+import struct
+import sys
+
+FW_INFO_MAGIC = 0x31495746  # "FWI1"
+FW_INFO_UNSIGNED = 0xFFFFFFFF
+INFO_SEARCH = 0x400          # 只在镜像开头查找 (向量表之后)
+FLASH_BASE = 0x08000000
+
+
+def crc32_stm32(data, crc=0xFFFFFFFF):
+    """CRC-32/MPEG-2, 按 32 位小端字处理; 末尾不足一字以 0xFF 补齐."""
+    if len(data) % 4:
+        data = bytes(data) + b"\xFF" * (4 - len(data) % 4)
+    for (word,) in struct.iter_unpack("<I", data):
+        crc ^= word
+        for _ in range(32):
+            crc = ((crc << 1) ^ 0x04C11DB7) if crc & 0x80000000 else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def find_info(image):
+    for off in range(0, min(len(image), INFO_SEARCH) - 7, 4):
+        if struct.unpack_from("<I", image, off)[0] == FW_INFO_MAGIC:
+            return off
+    return None
+
+
+def sign(image, limit=None):
+    """返回 (签名后的镜像, 长度, CRC). 重复签名时去掉之前追加的 CRC."""
+    image = bytearray(image)
+    off = find_info(image)
+    if off is None:
+        raise ValueError("fw_info block not found (magic FWI1)")
+    (old_len,) = struct.unpack_from("<I", image, off + 4)
+    if old_len != FW_INFO_UNSIGNED:
+        del image[old_len:]
+    while len(image) % 4:
+        image.append(0xFF)
+    length = len(image)
+    if limit is not None and length + 4 > limit:
+        raise ValueError("image %d bytes + CRC exceeds limit %d" % (length, limit))
+    struct.pack_into("<I", image, off + 4, length)
+    crc = crc32_stm32(image)
+    image += struct.pack("<I", crc)
+    return bytes(image), length, crc
+
+
+def check(image):
+    """返回 (状态, 长度, 计算值, 保存值), 状态: ok / unsigned / bad."""
+    off = find_info(image)
+    if off is None:
+        return "bad", 0, 0, 0
+    (length,) = struct.unpack_from("<I", image, off + 4)
+    if length == FW_INFO_UNSIGNED:
+        return "unsigned", length, 0, 0
+    if length % 4 or length + 4 > len(image):
+        return "bad", length, 0, 0
+    crc = crc32_stm32(image[:length])
+    (stored,) = struct.unpack_from("<I", image, length)
+    return ("ok" if crc == stored else "bad"), length, crc, stored
+
+
+def to_ihex(image, base=FLASH_BASE):
+    """Bin -> Intel HEX (扩展线性地址记录 + 16 字节数据记录)."""
+    def record(addr, typ, payload):
+        raw = bytes([len(payload), (addr >> 8) & 0xFF, addr & 0xFF, typ]) + payload
+        return ":%s%02X" % (raw.hex().upper(), (-sum(raw)) & 0xFF)
+
+    lines = []
+    upper = None
+    for pos in range(0, len(image), 16):
+        addr = base + pos
+        if addr >> 16 != upper:
+            upper = addr >> 16
+            lines.append(record(0, 4, struct.pack(">H", upper)))
+        lines.append(record(addr & 0xFFFF, 0, image[pos:pos + 16]))
+    if len(image) >= 8:
+        lines.append(record(0, 5, image[4:8][::-1]))  # 入口 = 复位向量, 与 objcopy 输出一致
+    lines.append(record(0, 1, b""))
+    return "\n".join(lines) + "\n"
+
+
+def selftest():
+    # STM32 CRC 外设参考值: 单字 0x12345678 -> 0xDF8A8A2B
+    assert crc32_stm32(struct.pack("<I", 0x12345678)) == 0xDF8A8A2B
+    # 尾部补 0xFF
+    assert crc32_stm32(b"\x01\x02") == crc32_stm32(b"\x01\x02\xFF\xFF")
+
+    vec = bytes(range(16)) + struct.pack("<II", FW_INFO_MAGIC, FW_INFO_UNSIGNED) + b"\x11" * 13
+    assert check(vec)[0] == "unsigned"
+    signed, length, crc = sign(vec)
+    assert length == 40 and len(signed) == 44
+    assert check(signed) == ("ok", 40, crc, crc)
+    assert sign(signed) == (signed, length, crc)  # 重复签名结果不变
+    broken = bytearray(signed)
+    broken[30] ^= 1
+    assert check(bytes(broken))[0] == "bad"
+
+    hexout = to_ihex(signed).splitlines()
+    assert hexout[0] == ":020000040800F2" and hexout[-1] == ":00000001FF"
+    for line in hexout:
+        raw = bytes.fromhex(line[1:])
+        assert sum(raw) & 0xFF == 0
+    print("selftest OK")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Append image CRC for App_Integrity")
+    ap.add_argument("bin", nargs="?", help="objcopy -O binary 输出")
+    ap.add_argument("--hex", help="同时写出 Intel HEX")
+    ap.add_argument("--limit", type=lambda s: int(s, 0), help="镜像 + CRC 的最大字节数")
+    ap.add_argument("--check", action="store_true", help="只校验, 不修改")
+    ap.add_argument("--selftest", action="store_true")
+    args = ap.parse_args()
+
+    if args.selftest:
+        selftest()
+        return 0
+    if not args.bin:
+        ap.error("bin file required")
+
+    with open(args.bin, "rb") as f:
+        image = f.read()
+    if args.check:
+        state, length, crc, stored = check(image)
+        print("%s: %s len=%d crc=%08X stored=%08X" % (args.bin, state, length, crc, stored))
+        return 0 if state == "ok" else 1
+
+    try:
+        signed, length, crc = sign(image, args.limit)
+    except ValueError as e:
+        print("fw_crc: %s" % e, file=sys.stderr)
+        return 1
+    with open(args.bin, "wb") as f:
+        f.write(signed)
+    if args.hex:
+        with open(args.hex, "w") as f:
+            f.write(to_ihex(signed))
+    print("fw_crc: len=%d crc=%08X" % (length, crc))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
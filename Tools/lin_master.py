@@ -0,0 +1,616 @@
+#!/usr/bin/env python3
+"""LIN 诊断参考主机 (0x3C/0x3D, ISO 17987 传输层).
+
+通过 LIN 读写节点配置 (DID), 无需连接调试串口.
+物理层假定为 UART + LIN 收发器 (单线回读自身发送的数据), Break 由串口 send_break 产生.
+
+用法:
+    python3 Tools/lin_master.py /dev/ttyUSB0 --nad 1 read 0x0130
+    python3 Tools/lin_master.py /dev/ttyUSB0 --nad 1 write 0x0120 0x0F 0xA0
+    python3 Tools/lin_master.py /dev/ttyUSB0 --nad 1 ident
+    python3 Tools/lin_master.py /dev/ttyUSB0 --nad 1 write 0x0210 0x00 0x00 0x0B 0xB8   # DECEL0 = 3000
+    python3 Tools/lin_master.py /dev/ttyUSB0 --nad 1 save
+    python3 Tools/lin_master.py --selftest      (pty 回环 + 模拟从机, 无需硬件)
+
+自测同时按固件的帧描述表 (Middleware/Inc/lin_frames.def) 与 AT+LINSCHED 调度表编码
+运行一个主机调度表 (ScheduleMaster, 与 app_lin.c 主机模式一致), 检验指令帧 / 时间同步 / 从机应答收集.
+
+常用 DID (详见 Middleware/Inc/lin_diag.h):
+    0x0100 设备ID   0x0101 组播掩码   0x0102 软件版本
+    0x0110+m 减速参数   0x0120+m 过流阈值(mA)   0x0130 电压/温度保护
+    0x0200+n 运行参数 n (AT+PARAM 中的 Num, 大端 1/2/4 字节)
+    0x01F0   写 1 = 运行参数保存到 Flash (即 save 命令), 写 2 = 恢复默认值
+"""
+import argparse
+import os
+import re
+import select
+import sys
+import threading
+import time
+import tty
+
+ID_DIAG_REQ = 0x3C
+ID_DIAG_RESP = 0x3D
+NAD_WILDCARD = 0x7F
+
+SID_READ_BY_ID = 0xB2
+SID_READ_DID = 0x22
+DID_PARAM_CMD = 0x01F0
+PARAM_CMD_SAVE = 1
+SID_WRITE_DID = 0x2E
+SID_NEGATIVE = 0x7F
+
+
+def pid(frame_id):
+    b = [(frame_id >> i) & 1 for i in range(6)]
+    p0 = b[0] ^ b[1] ^ b[2] ^ b[4]
+    p1 = 1 - (b[1] ^ b[3] ^ b[4] ^ b[5])
+    return (frame_id & 0x3F) | (p0 << 6) | (p1 << 7)
+
+
+def checksum(data, seed=0):
+    """Classic 校验和 seed=0, Enhanced 传入 PID."""
+    s = seed
+    for d in data:
+        s += d
+        if s > 0xFF:
+            s -= 0xFF
+    return (~s) & 0xFF
+
+
+class LinError(Exception):
+    pass
+
+
+# ---------------------------------------------------------------- 帧描述表
+SRC_INC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Middleware", "Inc")
+CKSUM_CLASSIC, CKSUM_ENHANCED = 0, 1
+
+
+def load_defines(*names):
+    """读取头文件中的整数宏 (LIN_ID_xxx / LIN_NCMD_xxx 等)."""
+    defs = {}
+    for name in names:
+        with open(os.path.join(SRC_INC, name), encoding="utf-8") as f:
+            for m in re.finditer(r"^#define\s+(LIN_\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b", f.read(), re.M):
+                defs[m.group(1)] = int(m.group(2), 0)
+    return defs
+
+
+def load_frame_table(defs):
+    """展开 lin_frames.def: {id: (len, "SUB"/"PUB", cksum, addr)}, 与 app_lin.c 中的 lin_frame_table 相同."""
+    table = {}
+    with open(os.path.join(SRC_INC, "lin_frames.def"), encoding="utf-8") as f:
+        for m in re.finditer(r"^LIN_(SUB|PUB)\(([^,]+),\s*(\d+),\s*(\w+),\s*(\w+),", f.read(), re.M):
+            fid = sum(defs[t] if t in defs else int(t, 0) for t in re.split(r"\s*\+\s*", m.group(2).strip()))
+            cksum = CKSUM_ENHANCED if m.group(4) == "LIN_CKSUM_ENHANCED" else CKSUM_CLASSIC
+            table[fid] = (int(m.group(3)), m.group(1), cksum, m.group(5))
+    return table
+
+
+# ---------------------------------------------------------------- 端口
+class FdPort:
+    """基于文件描述符的端口 (pty), Break 以单个 0x00 字节表示."""
+
+    def __init__(self, fd):
+        self.fd = fd
+
+    def write(self, data):
+        os.write(self.fd, bytes(data))
+
+    def send_break(self):
+        self.write(b"\x00")
+
+    def read(self, n, timeout):
+        out = b""
+        end = time.monotonic() + timeout
+        while len(out) < n:
+            left = end - time.monotonic()
+            if left <= 0:
+                break
+            r, _, _ = select.select([self.fd], [], [], left)
+            if not r:
+                break
+            chunk = os.read(self.fd, n - len(out))
+            if not chunk:
+                break
+            out += chunk
+        return out
+
+
+class SerialPort:
+    """pyserial 串口 + LIN 收发器, 回读自身发送的字节."""
+
+    def __init__(self, name, baud):
+        import serial  # pyserial
+        self.ser = serial.Serial(name, baud, timeout=0)
+        self.baud = baud
+
+    def write(self, data):
+        self.ser.write(bytes(data))
+        self.ser.flush()
+        self.read(len(data), 0.05)  # 丢弃回读
+
+    def send_break(self):
+        self.ser.reset_input_buffer()
+        self.ser.send_break(duration=13.0 / self.baud * 1.5)
+        self.read(1, 0.01)  # Break 回读为 0x00
+
+    def read(self, n, timeout):
+        out = b""
+        end = time.monotonic() + timeout
+        while len(out) < n and time.monotonic() < end:
+            out += self.ser.read(n - len(out))
+            if len(out) < n:
+                time.sleep(0.0005)
+        return out
+
+
+# ---------------------------------------------------------------- 主机
+class LinMaster:
+    def __init__(self, port, resp_timeout=0.02, poll_interval=0.01):
+        self.port = port
+        self.resp_timeout = resp_timeout
+        self.poll_interval = poll_interval
+
+    def header(self, frame_id):
+        self.port.send_break()
+        self.port.write([0x55, pid(frame_id)])
+
+    def master_request(self, data):
+        """发送 0x3C 主机请求帧 (8 字节, Classic 校验和)."""
+        data = list(data) + [0xFF] * (8 - len(data))
+        self.header(ID_DIAG_REQ)
+        self.port.write(data + [checksum(data)])
+
+    def slave_response(self):
+        """发送 0x3D 帧头并读取应答, 无应答返回 None."""
+        self.header(ID_DIAG_RESP)
+        raw = self.port.read(9, self.resp_timeout)
+        if len(raw) == 0:
+            return None
+        if len(raw) != 9 or checksum(raw[:8]) != raw[8]:
+            raise LinError("bad slave response: %s" % raw.hex())
+        return list(raw[:8])
+
+    # ------------------------------------------------ 传输层
+    def send(self, nad, payload):
+        payload = list(payload)
+        n = len(payload)
+        if n <= 6:
+            self.master_request([nad, n] + payload)
+            return
+        if n > 0xFFF:
+            raise LinError("message too long")
+        self.master_request([nad, 0x10 | (n >> 8), n & 0xFF] + payload[:5])
+        pos, sn = 5, 1
+        while pos < n:
+            self.master_request([nad, 0x20 | sn] + payload[pos:pos + 6])
+            pos += 6
+            sn = (sn + 1) & 0x0F
+
+    def receive(self, nad, timeout=1.0):
+        end = time.monotonic() + timeout
+        buf, total, sn = [], None, 1
+        while time.monotonic() < end:
+            fr = self.slave_response()
+            if fr is None:
+                time.sleep(self.poll_interval)
+                continue
+            if fr[0] != nad:
+                continue
+            pci = fr[1]
+            kind = pci >> 4
+            if kind == 0:
+                return fr[2:2 + (pci & 0x0F)]
+            if kind == 1:
+                total = ((pci & 0x0F) << 8) | fr[2]
+                buf, sn = fr[3:8], 1
+            elif kind == 2 and total is not None:
+                if (pci & 0x0F) != sn:
+                    raise LinError("CF sequence error")
+                buf += fr[2:8]
+                sn = (sn + 1) & 0x0F
+            if total is not None and len(buf) >= total:
+                return buf[:total]
+        raise LinError("no response from NAD 0x%02X" % nad)
+
+    def request(self, nad, payload, timeout=1.0):
+        self.send(nad, payload)
+        rsp = self.receive(nad, timeout)
+        if rsp and rsp[0] == SID_NEGATIVE:
+            raise LinError("negative response: SID=0x%02X NRC=0x%02X" % (rsp[1], rsp[2]))
+        if not rsp or rsp[0] != payload[0] + 0x40:
+            raise LinError("unexpected response: %s" % rsp)
+        return rsp
+
+    # ------------------------------------------------ 服务
+    def read_did(self, nad, did):
+        return bytes(self.request(nad, [SID_READ_DID, did >> 8, did & 0xFF])[3:])
+
+    def write_did(self, nad, did, data):
+        self.request(nad, [SID_WRITE_DID, did >> 8, did & 0xFF] + list(data))
+
+    def read_ident(self, nad):
+        r = self.request(nad, [SID_READ_BY_ID, 0, 0xFF, 0x7F, 0xFF, 0xFF])
+        return {"supplier": r[1] | (r[2] << 8), "function": r[3] | (r[4] << 8), "variant": r[5]}
+
+    # ------------------------------------------------ 网络管理
+    def go_to_sleep(self):
+        """休眠指令: 0x3C, Data0 = 0x00, 其余 0xFF, 所有节点进入休眠."""
+        self.master_request([0x00] + [0xFF] * 7)
+
+    def wakeup(self):
+        """唤醒信号: 0x00 字节在 19200bps 下产生约 470us 显性电平, 之后等待 100ms 节点就绪."""
+        self.port.write([0x00])
+        time.sleep(0.1)
+
+
+# ---------------------------------------------------------------- 主机调度表
+SCHED_RESP, SCHED_CMD = 0, 1   # LinSchedEntry_t.dir (app_storage.h)
+SCHED_MAX = 8                  # LIN_SCHED_MAX
+
+
+def sched_min_ms(n):
+    """LIN_SCHED_MIN_MS: 帧最大时长 1.4 * (34 + 10 * (n + 1)) 位 @ 19200bps, 向上取整."""
+    return (14 * (44 + 10 * n) + 191) // 192
+
+
+def master_cksum_seed(frame_id):
+    """LIN_MasterCksumSeed: 诊断帧 Classic, 其余 Enhanced."""
+    return 0 if frame_id >= ID_DIAG_REQ else pid(frame_id)
+
+
+def parse_linsched(params, id_time_sync=0x25):
+    """按 AT+LINSCHED=<Idx>,<ID>,<Ms>[,<HexData>] 解析并校验 (Process_LinSched + App_LIN_MasterSetSlot).
+
+    返回 (idx, entry), entry = {"id", "len", "dir", "ms", "data"}; 参数错误或时隙过短抛出 LinError.
+    """
+    f = params.split(",")
+    idx, fid = int(f[0]), int(f[1], 0)
+    if not 0 <= idx < SCHED_MAX or len(f) < 3 or not 0 <= fid <= 0x3F:
+        raise LinError("bad LINSCHED: %s" % params)
+    ms = int(f[2])
+    if len(f) > 3:
+        data = list(bytes.fromhex(f[3]))
+        if not 1 <= len(data) <= 8:
+            raise LinError("bad LINSCHED data: %s" % params)
+        e = {"id": fid, "len": len(data), "dir": SCHED_CMD, "ms": ms, "data": data}
+    else:
+        e = {"id": fid, "len": 8, "dir": SCHED_RESP, "ms": ms, "data": []}
+    if fid == id_time_sync:
+        e.update(dir=SCHED_CMD, len=8)  # 数据在发送时填充
+    if not 0 < ms <= 0xFFFF or ms < sched_min_ms(e["len"]):
+        raise LinError("+LINSCHED:ERR MinMs=%d" % sched_min_ms(e["len"]))
+    return idx, e
+
+
+class ScheduleMaster:
+    """主机调度表, 与固件主机模式 (LIN_Master_OnSlot) 行为一致.
+
+    每个时隙: 发帧头, 指令帧随后发数据与校验和, 时间同步帧填入 [Seq, 0, T5..T0] (本机 Break 时刻, us);
+    应答帧在时隙内收集, 结果同 AT+LINRESP (rx / no_resp / errors).
+    """
+
+    def __init__(self, port, id_time_sync=0x25):
+        self.master = LinMaster(port)
+        self.port = port
+        self.id_time_sync = id_time_sync
+        self.slots = [None] * SCHED_MAX
+        self.resp = [{"rx": 0, "no_resp": 0, "errors": 0, "data": None} for _ in range(SCHED_MAX)]
+        self.sync_seq = 0
+        self.cycles = 0
+
+    def set_slot(self, params):
+        idx, e = parse_linsched(params, self.id_time_sync)
+        self.slots[idx] = e
+        return idx
+
+    def run_slot(self, idx):
+        e = self.slots[idx]
+        end = time.monotonic() + e["ms"] / 1000.0
+        t_break = int(time.monotonic() * 1e6)
+        self.master.header(e["id"])
+        if e["dir"] == SCHED_CMD:
+            data = e["data"]
+            if e["id"] == self.id_time_sync:
+                data = [self.sync_seq & 0xFF, 0] + [(t_break >> (40 - 8 * i)) & 0xFF for i in range(6)]
+                self.sync_seq += 1
+            self.port.write(data + [checksum(data, master_cksum_seed(e["id"]))])
+        else:
+            r = self.resp[idx]
+            raw = self.port.read(e["len"] + 1, max(end - time.monotonic(), 0))
+            if len(raw) < e["len"] + 1:
+                r["no_resp"] += 1
+            elif checksum(raw[:e["len"]], master_cksum_seed(e["id"])) != raw[e["len"]]:
+                r["errors"] += 1
+            else:
+                r["rx"] += 1
+                r["data"] = list(raw[:e["len"]])
+        left = end - time.monotonic()
+        if left > 0:
+            time.sleep(left)
+
+    def run(self, cycles=1):
+        for _ in range(cycles):
+            for idx, e in enumerate(self.slots):
+                if e is not None:
+                    self.run_slot(idx)
+            self.cycles += 1
+
+
+# ---------------------------------------------------------------- 模拟从机
+class SimSlave(threading.Thread):
+    """与固件 lin_diag.c 行为一致的模拟从机, 用于 pty 回环自测.
+
+    给出 frames / defs (load_frame_table / load_defines) 时, 同时按帧描述表接收节点指令、查询与时间同步,
+    并应答状态帧 (格式同 LIN_BuildStatus, 电机只记录指令, 不模拟运动).
+    """
+
+    def __init__(self, port, nad=1, frames=None, defs=None):
+        super().__init__(daemon=True)
+        self.port = port
+        self.nad = nad
+        self.frames = frames or {}
+        self.defs = defs or {}
+        self.group_mask = 0
+        self.selected = True  # 单节点时默认应答 (lin_resp_selected)
+        self.resp_motor = 0
+        self.motor = {"busy": 0, "dir": 0, "speed": 0}
+        self.syncs = []
+        self.dids = {
+            0x0100: bytes([nad]),
+            0x0101: b"\x00",
+            0x0102: b"1.0.1",
+            0x0110: bytes([0, 0, 0, 100, 0x01, 0x2C]),
+            0x0120: bytes([0x13, 0x88]),
+            0x0130: bytes([1, 0, 100, 1, 24, 3, 82]),
+        }
+        self.rx, self.rx_total, self.rx_sn = [], None, 0
+        self.tx = []
+        self.stop = False
+
+    def run(self):
+        while not self.stop:
+            b = self.port.read(1, 0.05)
+            if b != b"\x00":
+                continue
+            hdr = self.port.read(2, 0.05)
+            if len(hdr) != 2 or hdr[0] != 0x55 or pid(hdr[1] & 0x3F) != hdr[1]:
+                continue
+            fid = hdr[1] & 0x3F
+            if fid == ID_DIAG_REQ:
+                fr = self.port.read(9, 0.05)
+                if len(fr) == 9 and checksum(fr[:8]) == fr[8]:
+                    self.on_request(list(fr[:8]))
+            elif fid == ID_DIAG_RESP and self.tx:
+                fr = self.tx.pop(0)
+                self.port.write(fr + [checksum(fr)])
+            elif fid in self.frames:
+                self.on_frame_header(fid, hdr[1])
+
+    # ------------------------------------------------ 帧描述表中的其他帧
+    def accepts(self, fid, addr):
+        if addr == "LIN_ADDR_NODE":
+            return fid == self.defs["LIN_ID_NODE_BASE"] + self.nad - 1
+        if addr == "LIN_ADDR_GROUP":
+            return bool(self.group_mask & (1 << (fid - self.defs["LIN_ID_GROUP_BASE"])))
+        return addr == "LIN_ADDR_ALL"
+
+    def on_frame_header(self, fid, p):
+        n, kind, cksum, addr = self.frames[fid]
+        seed = p if cksum == CKSUM_ENHANCED else 0
+        if kind == "SUB" and self.accepts(fid, addr):
+            fr = self.port.read(n + 1, 0.05)
+            if len(fr) == n + 1 and checksum(fr[:n], seed) == fr[n]:
+                self.on_frame(fid, list(fr[:n]))
+        elif kind == "PUB" and addr == "LIN_ADDR_SEL" and self.selected:
+            data = self.build(fid)
+            self.port.write(data + [checksum(data, seed)])
+
+    def on_frame(self, fid, data):
+        d = self.defs
+        if fid == d["LIN_ID_QUERY"]:
+            self.selected = data[1] in (0, self.nad)
+            if data[0] == 1:
+                self.resp_motor = 0
+        elif fid == d["LIN_ID_TIME_SYNC"]:
+            self.syncs.append((data[0], int.from_bytes(bytes(data[2:8]), "big")))
+        elif self.frames[fid][3] in ("LIN_ADDR_NODE", "LIN_ADDR_GROUP") or fid == d["LIN_ID_BROADCAST"]:
+            cmd, m = data[0] >> 4, data[0] & 0x0F
+            if m > 1:
+                return
+            if cmd == d["LIN_NCMD_RUN"]:
+                self.motor = {"busy": 1, "dir": data[1], "speed": (data[2] << 8) | data[3]}
+            elif cmd == d["LIN_NCMD_STOP"]:
+                self.motor = {"busy": 0, "dir": self.motor["dir"], "speed": 0}
+
+    def build(self, fid):
+        if fid == self.defs["LIN_ID_RESP_STATUS"]:
+            # [Busy<<7|ID, Err, PulseH, PulseL, Duty/4, Cur(0.1A), PosH, PosL]
+            return [(self.motor["busy"] << 7) | (self.resp_motor + 1), 0, 0, 0, self.motor["speed"] // 4, 0, 0, 0]
+        return [0] * self.frames[fid][0]
+
+    def on_request(self, fr):
+        if fr[0] not in (self.nad, NAD_WILDCARD):
+            return
+        pci = fr[1]
+        kind = pci >> 4
+        self.tx = []
+        if kind == 0:
+            self.dispatch(fr[2:2 + (pci & 0x0F)], fr[0] == self.nad)
+        elif kind == 1:
+            self.rx_total = ((pci & 0x0F) << 8) | fr[2]
+            self.rx, self.rx_sn = fr[3:8], 1
+        elif kind == 2 and self.rx_total is not None:
+            if (pci & 0x0F) != self.rx_sn:
+                self.rx_total = None
+                return
+            self.rx += fr[2:8]
+            self.rx_sn = (self.rx_sn + 1) & 0x0F
+            if len(self.rx) >= self.rx_total:
+                msg, self.rx_total = self.rx[:self.rx_total], None
+                self.dispatch(msg, fr[0] == self.nad)
+
+    def dispatch(self, req, respond):
+        sid = req[0]
+        if sid == SID_READ_DID and len(req) == 3:
+            did = (req[1] << 8) | req[2]
+            rsp = [sid + 0x40, req[1], req[2]] + list(self.dids[did]) if did in self.dids else [SID_NEGATIVE, sid, 0x31]
+        elif sid == SID_WRITE_DID and len(req) >= 4:
+            did = (req[1] << 8) | req[2]
+            if did in self.dids and did != 0x0102 and len(req) - 3 == len(self.dids[did]):
+                self.dids[did] = bytes(req[3:])
+                rsp = [sid + 0x40, req[1], req[2]]
+            else:
+                rsp = [SID_NEGATIVE, sid, 0x31]
+        elif sid == SID_READ_BY_ID and len(req) == 6:
+            rsp = [sid + 0x40, 0xFF, 0x7F, 0x01, 0x00, 0x01]
+        else:
+            rsp = [SID_NEGATIVE, sid, 0x11]
+        if respond:
+            self.tx = self.segment(rsp)
+
+    def segment(self, msg):
+        n = len(msg)
+        pad = lambda f: f + [0xFF] * (8 - len(f))
+        if n <= 6:
+            return [pad([self.nad, n] + msg)]
+        out = [pad([self.nad, 0x10 | (n >> 8), n & 0xFF] + msg[:5])]
+        pos, sn = 5, 1
+        while pos < n:
+            out.append(pad([self.nad, 0x20 | sn] + msg[pos:pos + 6]))
+            pos += 6
+            sn = (sn + 1) & 0x0F
+        return out
+
+
+def selftest():
+    m_fd, s_fd = os.openpty()
+    tty.setraw(s_fd)
+    slave = SimSlave(FdPort(s_fd), nad=3)
+    slave.start()
+    master = LinMaster(FdPort(m_fd), resp_timeout=0.1, poll_interval=0.001)
+
+    checks = []
+
+    def check(name, cond):
+        checks.append(cond)
+        print("%-40s %s" % (name, "OK" if cond else "FAIL"))
+
+    check("ReadById (SF)", master.read_ident(3)["variant"] == 1)
+    check("ReadDID SW version (FF/CF response)", master.read_did(3, 0x0102) == b"1.0.1")
+    prot = bytes([1, 0, 90, 1, 20, 3, 50])
+    master.write_did(3, 0x0130, prot)  # 10 字节请求: FF + CF
+    check("WriteDID protect (FF/CF request)", slave.dids[0x0130] == prot)
+    check("ReadDID protect round trip", master.read_did(3, 0x0130) == prot)
+    try:
+        master.read_did(3, 0x7777)
+        check("Negative response", False)
+    except LinError as e:
+        check("Negative response", "NRC=0x31" in str(e))
+    master.send(2, [SID_READ_DID, 0x01, 0x00])  # 其他节点: 模拟从机应保持沉默
+    check("Other NAD ignored", master.slave_response() is None)
+
+    slave.stop = True
+    slave.join()
+    os.close(m_fd)
+    os.close(s_fd)
+    selftest_schedule(check)
+
+    ok = all(checks)
+    print("selftest %s" % ("passed" if ok else "FAILED"))
+    return 0 if ok else 1
+
+
+def selftest_schedule(check):
+    """主机角色: 按 AT+LINSCHED 编码建调度表, 与按帧描述表工作的模拟从机交换指令 / 同步 / 状态应答."""
+    defs = load_defines("app_lin.h", "lin_diag.h")
+    frames = load_frame_table(defs)
+    check("Frame table: node 3 cmd / status",
+          frames.get(defs["LIN_ID_NODE_BASE"] + 2, (0,))[0] == 8
+          and frames.get(defs["LIN_ID_RESP_STATUS"], (0, ""))[1] == "PUB")
+
+    m_fd, s_fd = os.openpty()
+    tty.setraw(s_fd)
+    slave = SimSlave(FdPort(s_fd), nad=3, frames=frames, defs=defs)
+    slave.start()
+    sched = ScheduleMaster(FdPort(m_fd), defs["LIN_ID_TIME_SYNC"])
+
+    node3 = defs["LIN_ID_NODE_BASE"] + 2
+    run = [(defs["LIN_NCMD_RUN"] << 4) | 1, 1, 0x01, 0xF4, 0, 0, 0, 0]  # 电机 1 反转, 速度 500
+    try:
+        sched.set_slot("0,0x%02X,%d" % (node3, sched_min_ms(8) - 1))
+        check("Slot shorter than MinMs rejected", False)
+    except LinError as e:
+        check("Slot shorter than MinMs rejected", "MinMs=%d" % sched_min_ms(8) in str(e))
+    sched.set_slot("0,0x%02X,20,%s" % (node3, bytes(run).hex()))
+    sched.set_slot("1,0x%02X,20,0103000000000000" % defs["LIN_ID_QUERY"])  # 选中节点 3 电机 1
+    sched.set_slot("2,0x%02X,20" % defs["LIN_ID_RESP_STATUS"])
+    sched.set_slot("3,0x%02X,20" % defs["LIN_ID_TIME_SYNC"])
+    sched.run(2)
+
+    r = sched.resp[2]
+    check("Node cmd RUN (Enhanced checksum)", slave.motor == {"busy": 1, "dir": 1, "speed": 500})
+    check("Status response collected", r["rx"] == 2 and r["no_resp"] == 0 and r["errors"] == 0)
+    check("Status response encoding", r["data"] == [0x81, 0, 0, 0, 500 // 4, 0, 0, 0])
+    check("Time sync seq / master time",
+          [q for q, _ in slave.syncs] == [0, 1] and slave.syncs[1][1] - slave.syncs[0][1] >= 80000)
+
+    # 选中其他节点后状态时隙无应答, 计入 NoResp; 停止指令随后生效
+    sched.set_slot("0,0x%02X,20,%02X00000000000000" % (node3, defs["LIN_NCMD_STOP"] << 4 | 1))
+    sched.set_slot("1,0x%02X,20,0105000000000000" % defs["LIN_ID_QUERY"])
+    sched.run(1)
+    check("Node cmd STOP", slave.motor["busy"] == 0)
+    check("Deselected node: NoResp", r["rx"] == 2 and r["no_resp"] == 1)
+
+    slave.stop = True
+    slave.join()
+    os.close(m_fd)
+    os.close(s_fd)
+
+
+def parse_int(s):
+    return int(s, 0)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port", nargs="?", help="串口设备")
+    ap.add_argument("--baud", type=int, default=19200)
+    ap.add_argument("--nad", type=parse_int, default=1, help="目标节点 NAD (= device_id)")
+    ap.add_argument("--selftest", action="store_true", help="pty 回环自测")
+    ap.add_argument("cmd", nargs="?", choices=["read", "write", "ident", "save", "sleep", "wakeup"])
+    ap.add_argument("args", nargs="*", type=parse_int)
+    a = ap.parse_args()
+
+    if a.selftest:
+        sys.exit(selftest())
+    if not a.port or not a.cmd:
+        ap.error("port and command are required")
+
+    master = LinMaster(SerialPort(a.port, a.baud))
+    try:
+        if a.cmd == "ident":
+            print(master.read_ident(a.nad))
+        elif a.cmd == "read":
+            print(master.read_did(a.nad, a.args[0]).hex(" "))
+        elif a.cmd == "write":
+            master.write_did(a.nad, a.args[0], a.args[1:])
+            print("OK")
+        elif a.cmd == "save":
+            master.write_did(a.nad, DID_PARAM_CMD, [PARAM_CMD_SAVE])
+            print("OK")
+        elif a.cmd == "sleep":
+            master.go_to_sleep()
+            print("OK")
+        elif a.cmd == "wakeup":
+            master.wakeup()
+            print("OK")
+    except LinError as e:
+        sys.exit("error: %s" % e)
+
+
+if __name__ == "__main__":
+    main()
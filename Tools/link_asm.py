@@ -0,0 +1,726 @@
+#!/usr/bin/env python3
+"""联动程序汇编 / 仿真 / 上传工具.
+
+字节码格式与固件解释器一致 (App/Inc/app_linkvm.h), 程序槽与上传协议见 App/Inc/app_linkprog.h.
+换线时由工艺人员编写 .lnk 源程序, 先在电机模型上仿真, 再经 AT 串口或 LIN 诊断写入程序槽,
+用 AT+LINK=<0x10+槽号> / LIN 指令 6 / 参数 BOOTMODE 运行, 无需重新编译固件.
+
+源程序:
+    ; 注释 (也可用 #)
+    .name SWING            程序名, 最多 8 字符 (可选)
+    start:                 标号, 跳转指令的目标
+        WAIT_IDLE 0
+        MOVE_MAN  0, CW, 1000
+        WAIT_ADC  0, >=, 4000
+        STOP      0
+        DELAY     500
+        LOOP      start
+
+    操作数: 电机号 (0.., ALL = 全部), 方向 CW/CCW, 条件 < >= <= >, 寄存器 R0/R1, 数值可写 0x..
+
+用法:
+    python3 Tools/link_asm.py asm swing.lnk -o swing.bin
+    python3 Tools/link_asm.py dis swing.bin
+    python3 Tools/link_asm.py sim swing.lnk --loops 3 --trace
+    python3 Tools/link_asm.py at swing.lnk --slot 0                    打印 AT+PROG 指令
+    python3 Tools/link_asm.py upload swing.lnk --slot 0 --at /dev/ttyUSB0
+    python3 Tools/link_asm.py upload swing.lnk --slot 0 --lin /dev/ttyUSB1 --nad 1
+    python3 Tools/link_asm.py --selftest
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from fw_crc import crc32_stm32  # noqa: E402  与固件 BSP_Crc_Calc 相同
+
+# ---------------------------------------------------------------- 指令集
+# 操作数类型: m 电机, ma 电机或 ALL, dir, u8, u16, u32, i32, cond, addr, reg
+ISA = {
+    "END":          (0x00, []),
+    "NOP":          (0x01, []),
+    "MOVE_TIME":    (0x10, ["m", "dir", "u16", "u32"]),
+    "MOVE_POS":     (0x11, ["m", "dir", "u16", "i32"]),
+    "MOVE_POS_LIM": (0x12, ["m", "dir", "u16", "i32"]),
+    "MOVE_ADC":     (0x13, ["m", "u16", "u16", "u16", "u16"]),
+    "MOVE_MAN":     (0x14, ["m", "dir", "u16"]),
+    "STOP":         (0x15, ["ma"]),
+    "WAIT_IDLE":    (0x20, ["ma"]),
+    "DELAY":        (0x21, ["u32"]),
+    "WAIT_ADC":     (0x22, ["m", "cond", "u16"]),
+    "JMP":          (0x30, ["addr"]),
+    "BR_ADC":       (0x31, ["m", "cond", "u16", "addr"]),
+    "LOOP":         (0x32, ["addr"]),
+    "SET_REG":      (0x33, ["reg", "u16"]),
+    "DJNZ":         (0x34, ["reg", "addr"]),
+    "SET_OUT":      (0x40, ["u8", "u8"]),
+}
+BY_OPCODE = {op: (name, args) for name, (op, args) in ISA.items()}
+ARG_SIZE = {"m": 1, "ma": 1, "dir": 1, "u8": 1, "cond": 1, "reg": 1, "u16": 2, "addr": 2, "u32": 4, "i32": 4}
+
+ALL_MOTORS = 0xFF
+REGS = 2
+DIRS = {"CW": 0, "CCW": 1}
+CONDS = {"<": 0, "LT": 0, ">=": 1, "GE": 1, "<=": 2, "LE": 2, ">": 3, "GT": 3}
+COND_TEXT = ["<", ">=", "<=", ">"]
+
+MAX_LEN = 1024 - 20   # LINKPROG_MAX_LEN: 一页减去槽头部
+NAME_LEN = 8
+SLOT_MODE_BASE = 0x10  # LINK_MODE_SLOT(n)
+
+VM_ERRORS = ["NONE", "OPCODE", "TRUNCATED", "ARG", "JUMP", "EMPTY"]
+PROG_RESULTS = ["OK", "ARG", "STATE", "OFFSET", "LENGTH", "CRC", "VERIFY", "FLASH"]
+
+
+class AsmError(Exception):
+    pass
+
+
+def op_len(opcode):
+    if opcode not in BY_OPCODE:
+        return 0
+    return 1 + sum(ARG_SIZE[t] for t in BY_OPCODE[opcode][1])
+
+
+# ---------------------------------------------------------------- 汇编
+def _int(tok):
+    try:
+        return int(tok, 0)
+    except ValueError:
+        raise AsmError("bad number '%s'" % tok)
+
+
+def _operand(kind, tok, labels):
+    t = tok.upper()
+    if kind == "ma" and t == "ALL":
+        return ALL_MOTORS
+    if kind == "dir" and t in DIRS:
+        return DIRS[t]
+    if kind == "cond":
+        if t not in CONDS:
+            raise AsmError("bad condition '%s'" % tok)
+        return CONDS[t]
+    if kind == "reg" and re.fullmatch(r"R\d+", t):
+        return int(t[1:])
+    if kind == "addr" and not re.fullmatch(r"[-+]?(0X[0-9A-F]+|\d+)", t):
+        if labels is None:
+            return 0  # 第一遍: 标号地址未知
+        if tok not in labels:
+            raise AsmError("unknown label '%s'" % tok)
+        return labels[tok]
+    return _int(tok)
+
+
+def _encode(kind, v):
+    if kind == "i32":
+        return struct.pack("<i", v)
+    if kind == "u32":
+        return struct.pack("<I", v)
+    if kind in ("u16", "addr"):
+        return struct.pack("<H", v)
+    return struct.pack("<B", v)
+
+
+def _range_ok(kind, v):
+    lim = {"i32": (-2 ** 31, 2 ** 31 - 1), "u32": (0, 2 ** 32 - 1), "u16": (0, 0xFFFF), "addr": (0, 0xFFFF)}
+    lo, hi = lim.get(kind, (0, 0xFF))
+    return lo <= v <= hi
+
+
+def assemble(text):
+    """返回 (字节码, 程序名). 两遍: 第一遍确定标号地址, 第二遍编码."""
+    lines = []
+    name = ""
+    for no, raw in enumerate(text.splitlines(), 1):
+        line = re.split(r"[;#]", raw, 1)[0].strip()
+        if not line:
+            continue
+        if line.lower().startswith(".name"):
+            name = line[5:].strip()
+            if len(name) > NAME_LEN or "," in name:
+                raise AsmError("line %d: name must be at most %d chars without ','" % (no, NAME_LEN))
+            continue
+        while True:
+            m = re.match(r"([A-Za-z_]\w*)\s*:(.*)", line)
+            if not m:
+                break
+            lines.append((no, m.group(1) + ":"))
+            line = m.group(2).strip()
+        if line:
+            lines.append((no, line))
+
+    def one_pass(labels):
+        out = bytearray()
+        found = {}
+        for no, line in lines:
+            if line.endswith(":"):
+                label = line[:-1]
+                if label in found:
+                    raise AsmError("line %d: duplicate label '%s'" % (no, label))
+                found[label] = len(out)
+                continue
+            parts = line.split(None, 1)
+            mnem = parts[0].upper()
+            if mnem not in ISA:
+                raise AsmError("line %d: unknown instruction '%s'" % (no, parts[0]))
+            opcode, kinds = ISA[mnem]
+            toks = [t.strip() for t in parts[1].split(",")] if len(parts) > 1 else []
+            if len(toks) != len(kinds):
+                raise AsmError("line %d: %s takes %d operands" % (no, mnem, len(kinds)))
+            out.append(opcode)
+            for kind, tok in zip(kinds, toks):
+                try:
+                    v = _operand(kind, tok, labels)
+                except AsmError as e:
+                    raise AsmError("line %d: %s" % (no, e))
+                if not _range_ok(kind, v):
+                    raise AsmError("line %d: operand '%s' out of range" % (no, tok))
+                out += _encode(kind, v)
+        return bytes(out), found
+
+    _, labels = one_pass(None)
+    code, _ = one_pass(labels)
+    return code, name
+
+
+def _decode(code, pc):
+    opcode = code[pc]
+    name, kinds = BY_OPCODE[opcode]
+    vals, p = [], pc + 1
+    for kind in kinds:
+        fmt = {"i32": "<i", "u32": "<I", "u16": "<H", "addr": "<H"}.get(kind, "<B")
+        vals.append(struct.unpack_from(fmt, code, p)[0])
+        p += ARG_SIZE[kind]
+    return name, kinds, vals
+
+
+def disassemble(code):
+    targets = set()
+    for pc in iter_pcs(code):
+        name, kinds, vals = _decode(code, pc)
+        targets.update(v for k, v in zip(kinds, vals) if k == "addr")
+    out = []
+    for pc in iter_pcs(code):
+        name, kinds, vals = _decode(code, pc)
+        text = []
+        for k, v in zip(kinds, vals):
+            if k == "ma" and v == ALL_MOTORS:
+                text.append("ALL")
+            elif k == "dir":
+                text.append("CCW" if v else "CW")
+            elif k == "cond":
+                text.append(COND_TEXT[v] if v < 4 else str(v))
+            elif k == "reg":
+                text.append("R%d" % v)
+            elif k == "addr":
+                text.append("L%04X" % v)
+            else:
+                text.append(str(v))
+        if pc in targets:
+            out.append("L%04X:" % pc)
+        out.append(("    %-12s %s" % (name, ", ".join(text))).rstrip())
+    return "\n".join(out) + "\n"
+
+
+def iter_pcs(code):
+    pc = 0
+    while pc < len(code):
+        n = op_len(code[pc])
+        if n == 0 or pc + n > len(code):
+            return
+        yield pc
+        pc += n
+
+
+def verify(code, motors=1, outputs=1):
+    """与固件 App_LinkVm_Verify 相同, 返回 (错误名, 出错偏移)."""
+    if not code:
+        return "EMPTY", 0
+    if len(code) > 1024:
+        return "TRUNCATED", 0
+    starts = set()
+    pc = 0
+    while pc < len(code):
+        n = op_len(code[pc])
+        if n == 0:
+            return "OPCODE", pc
+        if pc + n > len(code):
+            return "TRUNCATED", pc
+        starts.add(pc)
+        pc += n
+    for pc in sorted(starts):
+        name, kinds, vals = _decode(code, pc)
+        for k, v in zip(kinds, vals):
+            bad = ((k == "m" and v >= motors) or (k == "ma" and v >= motors and v != ALL_MOTORS)
+                   or (k == "dir" and v > 1) or (k == "cond" and v > 3) or (k == "reg" and v >= REGS))
+            if bad:
+                return "ARG", pc
+            if k == "addr" and v not in starts:
+                return "JUMP", pc
+        if name == "SET_OUT" and (vals[0] >= outputs or vals[1] > 1):
+            return "ARG", pc
+    return "NONE", 0
+
+
+# ---------------------------------------------------------------- 电机模型
+class PlantMotor:
+    """简化的电机 + 位置电位器模型.
+
+    速度 (占空比 0~1000) 按 pps_per_duty 换算为 FG 脉冲频率, 正转 (CW) 脉冲与 ADC 位置增加.
+    ADC 位置在机械行程两端 (0 / 4095) 卡住, 限位开关位于 lim_ccw / lim_cw 处.
+    预减速、加速过程与电流未建模, 时间只作估算.
+    """
+
+    def __init__(self, pps_per_duty=5.0, adc_per_pulse=0.1, adc0=2048.0, lim_ccw=50, lim_cw=4045):
+        self.pps_per_duty = pps_per_duty
+        self.adc_per_pulse = adc_per_pulse
+        self.pos = 0.0
+        self.adc = adc0
+        self.lim_ccw, self.lim_cw = lim_ccw, lim_cw
+        self.mode = None
+        self.stalled = 0
+
+    def busy(self):
+        return self.mode is not None
+
+    def start(self, mode, direction=0, speed=0, arg=0, limit=False, target=0, tol=0, rng=0):
+        self.mode, self.dir, self.speed, self.limit = mode, direction, speed, limit
+        self.left = float(arg)
+        self.target, self.tol, self.rng = target, tol, rng
+
+    def stop(self):
+        self.mode = None
+
+    def _limit_hit(self, direction):
+        return self.adc >= self.lim_cw if direction == 0 else self.adc <= self.lim_ccw
+
+    def tick(self, dt):
+        if self.mode is None:
+            return
+        direction, speed = self.dir, self.speed
+        if self.mode == "adc":
+            err = self.target - self.adc
+            if abs(err) <= self.tol:
+                self.stop()
+                return
+            direction = 0 if err > 0 else 1
+            if self.rng and abs(err) < self.rng:
+                speed = max(speed * abs(err) / self.rng, speed * 0.1)
+        if self.limit and self._limit_hit(direction):
+            self.stop()
+            return
+        pulses = speed * self.pps_per_duty * dt
+        if self.mode == "pos":
+            pulses = min(pulses, self.left)
+            self.left -= pulses
+        elif self.mode == "time":
+            self.left -= dt * 1000.0
+        sign = 1 if direction == 0 else -1
+        adc = self.adc + sign * pulses * self.adc_per_pulse
+        if adc < 0 or adc > 4095:
+            self.stalled += 1  # 顶到机械行程端点
+            adc = min(max(adc, 0.0), 4095.0)
+        else:
+            self.pos += sign * pulses
+        self.adc = adc
+        if (self.mode == "pos" and self.left <= 0) or (self.mode == "time" and self.left <= 0):
+            self.stop()
+
+
+class Simulator:
+    """与 app_linkvm.c 语义一致的解释器, 每 dt 秒先推进电机模型, 再执行指令直到遇到未满足的等待."""
+
+    def __init__(self, code, motors, loops=0, dt=0.001, outputs=1):
+        err, pc = verify(code, len(motors), outputs)
+        if err != "NONE":
+            raise AsmError("verify failed: %s at pc=%d" % (err, pc))
+        self.code, self.m, self.dt = code, motors, dt
+        self.loops_target, self.loops_done = loops, 0
+        self.pc, self.t, self.steps = 0, 0.0, 0
+        self.reg = [0] * REGS
+        self.outputs = [0] * outputs
+        self.wait_start = None
+        self.state = "RUN"
+        self.trace = []
+        self.waited = {}  # pc -> 最长连续等待时间
+
+    def _busy(self, m):
+        return any(x.busy() for x in self.m) if m == ALL_MOTORS else self.m[m].busy()
+
+    def _cond(self, a, cond, b):
+        return [a < b, a >= b, a <= b, a > b][cond]
+
+    def step(self):
+        """执行一条指令, 返回 False 表示停在等待上."""
+        if self.pc >= len(self.code):
+            self.state = "DONE"
+            return False
+        name, _, v = _decode(self.code, self.pc)
+        nxt = self.pc + op_len(self.code[self.pc])
+        ms = self.t * 1000.0
+        if name == "END":
+            self.state = "DONE"
+            return False
+        elif name == "MOVE_TIME":
+            self.m[v[0]].start("time", v[1], v[2], v[3])
+        elif name in ("MOVE_POS", "MOVE_POS_LIM"):
+            self.m[v[0]].start("pos", v[1], v[2], v[3], limit=(name == "MOVE_POS_LIM"))
+        elif name == "MOVE_ADC":
+            self.m[v[0]].start("adc", speed=v[1], target=v[2], tol=v[3], rng=v[4], limit=True)
+        elif name == "MOVE_MAN":
+            self.m[v[0]].start("man", v[1], v[2])
+        elif name == "STOP":
+            for i, x in enumerate(self.m):
+                if v[0] in (i, ALL_MOTORS):
+                    x.stop()
+        elif name == "WAIT_IDLE":
+            if self._busy(v[0]):
+                return False
+        elif name == "DELAY":
+            if self.wait_start is None:
+                self.wait_start = ms
+                return False
+            if ms - self.wait_start <= v[0]:
+                return False
+            self.wait_start = None
+        elif name == "WAIT_ADC":
+            if not self._cond(self.m[v[0]].adc, v[1], v[2]):
+                return False
+        elif name == "JMP":
+            nxt = v[0]
+        elif name == "BR_ADC":
+            if self._cond(self.m[v[0]].adc, v[1], v[2]):
+                nxt = v[3]
+        elif name == "LOOP":
+            self.loops_done += 1
+            if self.loops_target and self.loops_done >= self.loops_target:
+                self.pc = nxt
+                self.state = "DONE"
+                return False
+            nxt = v[0]
+        elif name == "SET_REG":
+            self.reg[v[0]] = v[1]
+        elif name == "DJNZ":
+            if self.reg[v[0]]:
+                self.reg[v[0]] -= 1
+                if self.reg[v[0]]:
+                    nxt = v[1]
+        elif name == "SET_OUT":
+            self.outputs[v[0]] = v[1]
+        self.trace.append((self.t, self.pc, name, v))
+        self.pc = nxt
+        self.steps += 1
+        return True
+
+    def run(self, max_time=600.0, wait_timeout=60.0, burst=64):
+        warnings = []
+        blocked_pc, blocked_since = None, 0.0
+        while self.state == "RUN" and self.t < max_time:
+            for x in self.m:
+                x.tick(self.dt)
+            n = 0
+            while self.state == "RUN" and self.step():
+                n += 1
+                if n >= burst:
+                    warnings.append("t=%.3fs: %d instructions without waiting (busy loop?)" % (self.t, n))
+                    self.state = "ERROR"
+                    break
+            if self.state != "RUN":
+                break
+            if self.pc != blocked_pc:
+                blocked_pc, blocked_since = self.pc, self.t
+            elif self.t - blocked_since > wait_timeout:
+                name = _decode(self.code, self.pc)[0]
+                warnings.append("t=%.3fs: stuck in %s at pc=%d for %.0fs" % (self.t, name, self.pc, wait_timeout))
+                self.state = "ERROR"
+                break
+            self.t += self.dt
+        if self.state == "RUN":
+            warnings.append("still running after %.0fs (loops=%d)" % (max_time, self.loops_done))
+        for i, x in enumerate(self.m):
+            if x.stalled:
+                warnings.append("motor %d ran into the end of travel for %d ms" % (i, x.stalled * self.dt * 1000))
+        return warnings
+
+
+# ---------------------------------------------------------------- 上传
+def prog_crc(code):
+    return crc32_stm32(code)
+
+
+def at_lines(code, slot, name="", chunk=64):
+    """AT+PROG 上传指令序列 (每块最多 128 字节)."""
+    if not 0 < len(code) <= MAX_LEN:
+        raise AsmError("program length %d out of range 1..%d" % (len(code), MAX_LEN))
+    chunk = min(chunk, 128)
+    head = "AT+PROG=BEGIN,%d,%d" % (slot, len(code)) + ("," + name if name else "")
+    lines = [head]
+    for off in range(0, len(code), chunk):
+        lines.append("AT+PROG=DATA,%d,%s" % (off, code[off:off + chunk].hex().upper()))
+    lines.append("AT+PROG=END,%08X" % prog_crc(code))
+    return lines
+
+
+def upload_at(port, baud, lines, timeout=2.0):
+    import serial  # pyserial
+    with serial.Serial(port, baud, timeout=0.05) as ser:
+        for line in lines:
+            ser.write((line + "\r\n").encode())
+            end = time.monotonic() + timeout
+            buf = b""
+            while time.monotonic() < end:
+                buf += ser.read(256)
+                text = buf.decode(errors="replace")
+                if "+PROG:ERR" in text:
+                    raise AsmError("%s -> %s" % (line[:40], text.strip()))
+                if re.search(r"\+PROG:(BEGIN|DATA|END)", text):
+                    break
+            else:
+                raise AsmError("no response to %s" % line[:40])
+            print(text.strip().splitlines()[-1])
+
+
+def upload_lin(port, baud, nad, slot, name, code, chunk=120):
+    from lin_master import LinMaster, SerialPort, LinError
+    master = LinMaster(SerialPort(port, baud))
+    try:
+        master.write_did(nad, 0x0300, [1, slot, len(code) >> 8, len(code) & 0xFF] + list(name.encode()))
+        for off in range(0, len(code), chunk):
+            master.write_did(nad, 0x0301, [off >> 8, off & 0xFF] + list(code[off:off + chunk]))
+        master.write_did(nad, 0x0300, [2] + list(struct.pack(">I", prog_crc(code))))
+        end = time.monotonic() + 5.0
+        while time.monotonic() < end:
+            st = master.read_did(nad, 0x0300)
+            if st[0] == 0:  # 写入完成
+                if st[6] != 0:
+                    raise AsmError("node reports %s" % PROG_RESULTS[st[6]])
+                return
+            time.sleep(0.05)
+        raise AsmError("slot write timeout")
+    except LinError as e:
+        raise AsmError("LIN: %s" % e)
+
+
+# ---------------------------------------------------------------- 自测
+class FakeNode:
+    """按 app_linkprog.c 规则处理 AT+PROG 的模拟节点 (不含 Flash)."""
+
+    def __init__(self):
+        self.slots = {}
+        self.buf, self.slot, self.len = None, None, 0
+
+    def at(self, line):
+        op, _, rest = line[len("AT+PROG="):].partition(",")
+        if op == "BEGIN":
+            f = rest.split(",", 2)
+            self.slot, self.len, self.buf = int(f[0]), int(f[1]), bytearray()
+            self.name = f[2] if len(f) > 2 else ""
+            return "+PROG:BEGIN"
+        if op == "DATA":
+            off, data = rest.split(",")
+            if self.buf is None or int(off) != len(self.buf):
+                return "+PROG:ERR=OFFSET"
+            self.buf += bytes.fromhex(data)
+            return "+PROG:DATA %d" % len(self.buf)
+        if op == "END":
+            if len(self.buf) != self.len:
+                return "+PROG:ERR=LENGTH"
+            if prog_crc(bytes(self.buf)) != int(rest, 16):
+                return "+PROG:ERR=CRC"
+            if verify(bytes(self.buf))[0] != "NONE":
+                return "+PROG:ERR=VERIFY"
+            self.slots[self.slot] = (self.name, bytes(self.buf))
+            return "+PROG:END"
+        return "+PROG:ERR=ARG"
+
+
+MODE6_SRC = """
+; 与内置模式 6 相同: ADC 模拟限位往复
+.name SWING6
+start:
+    WAIT_IDLE 0
+    MOVE_MAN  0, CW, 1000
+    WAIT_ADC  0, >=, 4000
+    STOP      0
+    DELAY     500
+    WAIT_IDLE 0
+    MOVE_MAN  0, CCW, 1000
+    WAIT_ADC  0, <=, 100
+    STOP      0
+    DELAY     500
+    LOOP      start
+"""
+
+COUNT_SRC = """
+.name STEP3
+    SET_REG   R0, 3
+again:
+    MOVE_POS  0, CW, 600, 1000       # 三段 1000 脉冲
+    WAIT_IDLE ALL
+    SET_OUT   0, 1
+    DELAY     100
+    SET_OUT   0, 0
+    DJNZ      R0, again
+    MOVE_POS_LIM 0, CCW, 800, 100000 # 回到反向限位
+    WAIT_IDLE 0
+    END
+"""
+
+
+def selftest():
+    checks = []
+
+    def check(name, cond):
+        checks.append(bool(cond))
+        print("%-44s %s" % (name, "OK" if cond else "FAIL"))
+
+    code, _ = assemble("MOVE_TIME 0, CW, 800, 2000")
+    check("encoding MOVE_TIME (little endian)", code == bytes.fromhex("10000020 03D00700 00".replace(" ", "")))
+    code, _ = assemble("x: WAIT_ADC 0, >=, 4000\n LOOP x")
+    check("encoding WAIT_ADC + LOOP label", code == bytes([0x22, 0, 1, 0xA0, 0x0F, 0x32, 0, 0]))
+
+    code6, name6 = assemble(MODE6_SRC)
+    check("assemble mode 6 (%d bytes)" % len(code6), name6 == "SWING6" and verify(code6)[0] == "NONE")
+    check("disassemble round trip", assemble(disassemble(code6))[0] == code6)
+
+    check("verify: jump into operand", verify(bytes([0x30, 1, 0]))[0] == "JUMP")
+    check("verify: motor out of range", verify(assemble("STOP 1")[0])[0] == "ARG")
+    check("verify: ALL accepted", verify(assemble("STOP ALL")[0])[0] == "NONE")
+    check("verify: truncated", verify(code6[:-1])[0] == "TRUNCATED")
+    try:
+        assemble("JMP nowhere")
+        check("unknown label rejected", False)
+    except AsmError:
+        check("unknown label rejected", True)
+
+    m = PlantMotor()
+    sim = Simulator(code6, [m], loops=2)
+    warn = sim.run()
+    check("simulate mode 6: 2 loops, no warnings", sim.state == "DONE" and sim.loops_done == 2 and not warn)
+    check("simulate mode 6: ends near ADC 100", 90 <= m.adc <= 110)
+
+    code3, _ = assemble(COUNT_SRC)
+    m = PlantMotor()
+    sim = Simulator(code3, [m])
+    warn = sim.run()
+    moves = [e for e in sim.trace if e[2] == "MOVE_POS"]
+    check("simulate DJNZ: 3 segments then END", sim.state == "DONE" and len(moves) == 3)
+    check("simulate MOVE_POS_LIM stops at limit", not warn and m.adc <= m.lim_ccw + 1)
+
+    stuck, _ = assemble("WAIT_ADC 0, >, 5000\nEND")
+    sim = Simulator(stuck, [PlantMotor()])
+    warn = sim.run(max_time=5, wait_timeout=2)
+    check("simulate: unreachable wait reported", sim.state == "ERROR" and "stuck" in warn[0])
+
+    node = FakeNode()
+    replies = [node.at(l) for l in at_lines(code6, 1, name6, chunk=16)]
+    check("AT upload chunks accepted", all(r.startswith("+PROG:") and "ERR" not in r for r in replies))
+    check("AT upload reassembled", node.slots.get(1) == (name6, code6))
+    lines = at_lines(code6, 0)
+    lines[-1] = "AT+PROG=END,%08X" % (prog_crc(code6) ^ 1)
+    node = FakeNode()
+    check("AT upload: bad CRC rejected", [node.at(l) for l in lines][-1] == "+PROG:ERR=CRC")
+    print("selftest %s" % ("passed" if all(checks) else "FAILED"))
+    return 0 if all(checks) else 1
+
+
+# ---------------------------------------------------------------- 命令行
+def load(path):
+    if path.endswith(".bin"):
+        with open(path, "rb") as f:
+            return f.read(), ""
+    with open(path, encoding="utf-8") as f:
+        return assemble(f.read())
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--selftest", action="store_true")
+    sub = ap.add_subparsers(dest="cmd")
+
+    p = sub.add_parser("asm", help="汇编为 .bin")
+    p.add_argument("src")
+    p.add_argument("-o", "--out")
+
+    p = sub.add_parser("dis", help="反汇编 .bin")
+    p.add_argument("bin")
+
+    p = sub.add_parser("sim", help="在电机模型上仿真")
+    p.add_argument("src")
+    p.add_argument("--loops", type=int, default=1, help="目标轮数 (0 = 无限, 仿真到 --time)")
+    p.add_argument("--time", type=float, default=600.0, help="最长仿真时间 (s)")
+    p.add_argument("--motors", type=int, default=1)
+    p.add_argument("--pps", type=float, default=5.0, help="每单位速度的脉冲频率 (pulse/s)")
+    p.add_argument("--adc-per-pulse", type=float, default=0.1)
+    p.add_argument("--adc0", type=float, default=2048.0, help="初始 ADC 位置")
+    p.add_argument("--wait-timeout", type=float, default=60.0, help="同一条等待指令超过该时间视为卡死 (s)")
+    p.add_argument("--trace", action="store_true")
+
+    for cmd in ("at", "upload"):
+        p = sub.add_parser(cmd, help="打印 AT 上传指令" if cmd == "at" else "上传到节点")
+        p.add_argument("src")
+        p.add_argument("--slot", type=int, required=True)
+        p.add_argument("--name", help="程序名 (默认取源程序 .name)")
+        p.add_argument("--chunk", type=int, default=64)
+        if cmd == "upload":
+            p.add_argument("--at", metavar="PORT", help="AT 串口")
+            p.add_argument("--lin", metavar="PORT", help="LIN 串口 (经 lin_master.py)")
+            p.add_argument("--baud", type=int)
+            p.add_argument("--nad", type=lambda s: int(s, 0), default=1)
+    a = ap.parse_args()
+
+    if a.selftest:
+        return selftest()
+    try:
+        if a.cmd == "asm":
+            code, name = load(a.src)
+            out = a.out or os.path.splitext(a.src)[0] + ".bin"
+            with open(out, "wb") as f:
+                f.write(code)
+            print("%s: %d bytes, crc=%08X%s" % (out, len(code), prog_crc(code), (", name=" + name) if name else ""))
+        elif a.cmd == "dis":
+            code, _ = load(a.bin)
+            sys.stdout.write(disassemble(code))
+        elif a.cmd == "sim":
+            code, _ = load(a.src)
+            motors = [PlantMotor(a.pps, a.adc_per_pulse, a.adc0) for _ in range(a.motors)]
+            sim = Simulator(code, motors, loops=a.loops)
+            warn = sim.run(max_time=a.time, wait_timeout=a.wait_timeout)
+            if a.trace:
+                for t, pc, name, v in sim.trace:
+                    print("%9.3fs  %04X  %-12s %s" % (t, pc, name, ", ".join(str(x) for x in v)))
+            print("state=%s loops=%d time=%.3fs steps=%d" % (sim.state, sim.loops_done, sim.t, sim.steps))
+            for i, x in enumerate(motors):
+                print("motor %d: pos=%d adc=%d" % (i, round(x.pos), round(x.adc)))
+            for w in warn:
+                print("warning: " + w)
+            return 1 if sim.state == "ERROR" else 0
+        elif a.cmd in ("at", "upload"):
+            code, name = load(a.src)
+            name = a.name if a.name is not None else name
+            err, pc = verify(code)
+            if err != "NONE":
+                raise AsmError("verify failed: %s at pc=%d" % (err, pc))
+            if a.cmd == "at":
+                print("\n".join(at_lines(code, a.slot, name, a.chunk)))
+            elif a.at:
+                upload_at(a.at, a.baud or 115200, at_lines(code, a.slot, name, a.chunk))
+                print("run: AT+PROG=RUN,%d  (mode 0x%02X)" % (a.slot, SLOT_MODE_BASE + a.slot))
+            elif a.lin:
+                upload_lin(a.lin, a.baud or 19200, a.nad, a.slot, name, code)
+                print("OK, run: LIN command 6 with Mode=0x%02X" % (SLOT_MODE_BASE + a.slot))
+            else:
+                ap.error("--at or --lin required")
+        else:
+            ap.print_help()
+    except (AsmError, OSError) as e:
+        print("link_asm: %s" % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""延迟日志 (LOG_DEFERRED=1) 主机端解码工具.
+
+从固件 ELF 的 .log_fmt 段读取格式串, 将串口上的二进制日志记录还原为文本.
+非日志字节 (AT 应答等) 原样透传.
+
+用法:
+    python3 Tools/log_decode.py build/Debug/MotorControl_LIN_Hanghai.elf capture.bin
+    python3 Tools/log_decode.py app.elf /dev/ttyUSB0 --baud 115200   (需要 pyserial)
+"""
+import argparse
+import re
+import struct
+import sys
+
+SYNC = b"\xA5\x4C"
+
+
+class Elf32:
+    """最小 ELF32 小端解析: 只读取节头与节内容."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("not an ELF32 file")
+        (self.shoff,) = struct.unpack_from("<I", self.data, 0x20)
+        self.shentsize, self.shnum, self.shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        self.sections = []
+        for i in range(self.shnum):
+            name, typ, flags, addr, off, size = struct.unpack_from(
+                "<IIIIII", self.data, self.shoff + i * self.shentsize)
+            self.sections.append([name, typ, flags, addr, off, size])
+        stroff = self.sections[self.shstrndx][4]
+        for s in self.sections:
+            end = self.data.index(b"\0", stroff + s[0])
+            s[0] = self.data[stroff + s[0]:end].decode()
+
+    def section(self, name):
+        for s in self.sections:
+            if s[0] == name:
+                return s
+        return None
+
+    def read_cstr(self, addr):
+        """在已加载 (SHF_ALLOC) 且有内容的节中按地址读取 C 字符串."""
+        for name, typ, flags, base, off, size in self.sections:
+            if flags & 0x2 and typ != 8 and base <= addr < base + size:
+                start = off + addr - base
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode(errors="replace")
+        return None
+
+
+# printf 转换说明 -> (标志/宽度, 转换字符)
+SPEC = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|t)?([diouxXcsp%])")
+
+
+def render(fmt, args, elf):
+    out = []
+    pos = 0
+    it = iter(args)
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            out.append("%")
+            continue
+        v = next(it, 0)
+        if conv in "di":
+            v = v - (1 << 32) if v & 0x80000000 else v
+            out.append(("%" + flags + "d") % v)
+        elif conv in "uoxX":
+            out.append(("%" + flags + ("d" if conv == "u" else conv)) % v)
+        elif conv == "c":
+            out.append(chr(v & 0xFF))
+        elif conv == "s":
+            s = elf.read_cstr(v)
+            out.append(s if s is not None else "<str@0x%08X>" % v)
+        else:  # p
+            out.append("0x%08X" % v)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def decode_stream(stream, elf, fmt_data, write):
+    buf = b""
+    # 时间戳为 32 位微秒计数, 按单调递增展开回绕
+    ts_high = 0
+    ts_last = None
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            i = buf.find(SYNC)
+            if i < 0:
+                # 保留可能被截断的同步头首字节
+                keep = 1 if buf.endswith(SYNC[:1]) else 0
+                write(buf[:len(buf) - keep].decode(errors="replace"))
+                buf = buf[len(buf) - keep:]
+                break
+            if i > 0:
+                write(buf[:i].decode(errors="replace"))
+                buf = buf[i:]
+            if len(buf) < 3 or len(buf) < 3 + buf[2] + 1:
+                break
+            n = buf[2]
+            body = buf[3:3 + n]
+            if (n < 6 or (n - 6) % 4 != 0 or
+                    (sum(buf[2:3 + n]) & 0xFF) != buf[3 + n]):
+                # 非日志记录, 跳过同步头首字节继续
+                write(buf[:1].decode(errors="replace"))
+                buf = buf[1:]
+                continue
+            fmt_id, ts = struct.unpack_from("<HI", body, 0)
+            args = struct.unpack_from("<%dI" % ((n - 6) // 4), body, 6)
+            end = fmt_data.find(b"\0", fmt_id)
+            fmt = fmt_data[fmt_id:end].decode(errors="replace") if 0 <= fmt_id < len(fmt_data) else None
+            if fmt is None:
+                text = "<unknown log id 0x%04X> %s\r\n" % (fmt_id, " ".join("0x%X" % a for a in args))
+            else:
+                text = render(fmt, args, elf)
+            if ts_last is not None and ts < ts_last and ts_last - ts > 0x80000000:
+                ts_high += 1 << 32
+            ts_last = ts
+            write("%14.6f %s" % ((ts_high + ts) / 1e6, text))
+            buf = buf[4 + n:]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("elf", help="固件 ELF 文件")
+    ap.add_argument("input", help="二进制抓包文件或串口设备, '-' 表示标准输入")
+    ap.add_argument("--baud", type=int, default=115200, help="串口波特率")
+    a = ap.parse_args()
+
+    elf = Elf32(a.elf)
+    sec = elf.section(".log_fmt")
+    if sec is None:
+        sys.exit("ELF 中没有 .log_fmt 段 (固件未以 LOG_DEFERRED=1 编译?)")
+    fmt_data = elf.data[sec[4]:sec[4] + sec[5]]
+
+    if a.input == "-":
+        stream = sys.stdin.buffer
+    elif a.input.startswith("/dev/") or a.input.upper().startswith("COM"):
+        import serial  # pyserial
+
+        class SerialStream:
+            def __init__(self, port):
+                self.port = port
+
+            def read(self, n):
+                # 阻塞至少 1 字节, 再读走已到达的数据
+                return self.port.read(max(1, min(n, self.port.in_waiting)))
+
+        stream = SerialStream(serial.Serial(a.input, a.baud, timeout=None))
+    else:
+        stream = open(a.input, "rb")
+
+    def write(s):
+        sys.stdout.write(s)
+        sys.stdout.flush()
+
+    try:
+        decode_stream(stream, elf, fmt_data, write)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()